@@ -0,0 +1,258 @@
+#ifndef ASYNCLIBRARY_H
+#define ASYNCLIBRARY_H
+
+// Coroutine facade over Library. Needs C++20; the rest of the project
+// builds as C++14, and CMake compiles this part only when the compiler
+// supports C++20 (target LibraryAsync).
+#if !defined(__cpp_impl_coroutine)
+#error "AsyncLibrary.h requires C++20 coroutines"
+#endif
+
+#include <coroutine>
+#include <deque>
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <optional>
+#include <utility>
+#include "Library.h"
+
+class EventLoop;
+
+/**
+ * Task class - lazily started coroutine producing a T
+ * Demonstrates: C++20 coroutines, Symmetric transfer
+ *
+ * A Task runs when it is first awaited and resumes its awaiter when it
+ * finishes; exceptions propagate to the awaiter.
+ */
+template <typename T>
+class Task {
+public:
+    struct promise_type {
+        std::optional<T> value;
+        std::exception_ptr error;
+        std::coroutine_handle<> continuation;
+
+        Task get_return_object() {
+            return Task(std::coroutine_handle<promise_type>::from_promise(*this));
+        }
+        std::suspend_always initial_suspend() noexcept { return {}; }
+
+        struct FinalAwaiter {
+            bool await_ready() noexcept { return false; }
+            std::coroutine_handle<> await_suspend(std::coroutine_handle<promise_type> self) noexcept {
+                auto next = self.promise().continuation;
+                return next ? next : std::noop_coroutine();
+            }
+            void await_resume() noexcept {}
+        };
+        FinalAwaiter final_suspend() noexcept { return {}; }
+
+        void return_value(T result) { value.emplace(std::move(result)); }
+        void unhandled_exception() { error = std::current_exception(); }
+    };
+
+    Task(Task&& other) noexcept : handle(std::exchange(other.handle, nullptr)) {}
+    Task(const Task&) = delete;
+    Task& operator=(const Task&) = delete;
+    ~Task() {
+        if (handle) {
+            handle.destroy();
+        }
+    }
+
+    bool await_ready() const noexcept { return false; }
+    std::coroutine_handle<> await_suspend(std::coroutine_handle<> awaiter) noexcept {
+        handle.promise().continuation = awaiter;
+        return handle;
+    }
+    T await_resume() {
+        if (handle.promise().error) {
+            std::rethrow_exception(handle.promise().error);
+        }
+        return std::move(*handle.promise().value);
+    }
+
+private:
+    explicit Task(std::coroutine_handle<promise_type> h) : handle(h) {}
+    std::coroutine_handle<promise_type> handle;
+};
+
+template <>
+class Task<void> {
+public:
+    struct promise_type {
+        std::exception_ptr error;
+        std::coroutine_handle<> continuation;
+
+        Task get_return_object() {
+            return Task(std::coroutine_handle<promise_type>::from_promise(*this));
+        }
+        std::suspend_always initial_suspend() noexcept { return {}; }
+
+        struct FinalAwaiter {
+            bool await_ready() noexcept { return false; }
+            std::coroutine_handle<> await_suspend(std::coroutine_handle<promise_type> self) noexcept {
+                auto next = self.promise().continuation;
+                return next ? next : std::noop_coroutine();
+            }
+            void await_resume() noexcept {}
+        };
+        FinalAwaiter final_suspend() noexcept { return {}; }
+
+        void return_void() {}
+        void unhandled_exception() { error = std::current_exception(); }
+    };
+
+    Task(Task&& other) noexcept : handle(std::exchange(other.handle, nullptr)) {}
+    Task(const Task&) = delete;
+    Task& operator=(const Task&) = delete;
+    ~Task() {
+        if (handle) {
+            handle.destroy();
+        }
+    }
+
+    bool await_ready() const noexcept { return false; }
+    std::coroutine_handle<> await_suspend(std::coroutine_handle<> awaiter) noexcept {
+        handle.promise().continuation = awaiter;
+        return handle;
+    }
+    void await_resume() {
+        if (handle.promise().error) {
+            std::rethrow_exception(handle.promise().error);
+        }
+    }
+
+private:
+    explicit Task(std::coroutine_handle<promise_type> h) : handle(h) {}
+    std::coroutine_handle<promise_type> handle;
+};
+
+/**
+ * EventLoop class - runs coroutines on a small, fixed set of threads
+ * Demonstrates: Run queue, Cooperative scheduling
+ *
+ * Coroutines suspended on I/O hold no thread; whoever completes the I/O
+ * posts them back to the run queue.
+ */
+class EventLoop {
+private:
+    std::deque<std::coroutine_handle<>> runQueue;
+    std::mutex queueMutex;
+    std::condition_variable queueReady;
+    std::vector<std::thread> threads;
+    bool stopping;
+
+    // Spawned tasks that have not finished yet
+    size_t outstanding;
+    std::condition_variable idle;
+
+    void threadLoop();
+    void finished();
+
+    struct Detached;
+    static Detached runDetached(EventLoop* loop, Task<void> task,
+                                std::function<void(std::exception_ptr)> onError);
+
+public:
+    // Constructor: starts 'threadCount' loop threads (at least one)
+    explicit EventLoop(unsigned threadCount);
+
+    // Non-copyable (owns threads)
+    EventLoop(const EventLoop&) = delete;
+    EventLoop& operator=(const EventLoop&) = delete;
+
+    // Queue a suspended coroutine to be resumed on a loop thread
+    void post(std::coroutine_handle<> handle);
+
+    // Start a task on the loop without awaiting it. Its exception, if
+    // any, goes to 'onError'; otherwise it is dropped.
+    void spawn(Task<void> task,
+               std::function<void(std::exception_ptr)> onError = std::function<void(std::exception_ptr)>());
+
+    // Block the calling (non-loop) thread until every spawned task is done
+    void waitIdle();
+
+    // Awaitable that continues the coroutine on a loop thread
+    auto schedule() {
+        struct Awaiter {
+            EventLoop* loop;
+            bool await_ready() const noexcept { return false; }
+            void await_suspend(std::coroutine_handle<> handle) { loop->post(handle); }
+            void await_resume() const noexcept {}
+        };
+        return Awaiter{this};
+    }
+
+    // Awaitable that runs a blocking call on its own thread, leaving the
+    // loop threads free, and continues on the loop once it returns
+    auto offload(std::function<void()> call) {
+        struct Awaiter {
+            EventLoop* loop;
+            std::function<void()> call;
+            std::exception_ptr error;
+            bool await_ready() const noexcept { return false; }
+            void await_suspend(std::coroutine_handle<> handle) {
+                std::thread([this, handle] {
+                    try {
+                        call();
+                    } catch (...) {
+                        error = std::current_exception();
+                    }
+                    loop->post(handle);
+                }).detach();
+            }
+            void await_resume() {
+                if (error) {
+                    std::rethrow_exception(error);
+                }
+            }
+        };
+        return Awaiter{this, std::move(call), nullptr};
+    }
+
+    // Let queued coroutines finish, then stop the loop threads
+    void shutdown();
+
+    // Destructor
+    ~EventLoop();
+};
+
+/**
+ * AsyncLibrary class - coroutine front end for borrowing and returning
+ * Demonstrates: Facade Pattern, Group commit
+ *
+ *     Transaction loan = co_await async.borrow("S001", "B001");
+ *
+ * The state change happens at once under the library's lock; the
+ * coroutine then suspends until its journal event has been flushed, so a
+ * completed call is durable. Flushes are shared by every call in flight,
+ * which lets a few loop threads keep thousands of checkouts moving.
+ *
+ * If the flush fails the awaiter gets NotDurableException: the change
+ * stands in memory but may be lost in a crash, and the library refuses
+ * further changes until it is recovered from its snapshot and journal.
+ */
+class AsyncLibrary {
+private:
+    Library& library;
+    EventLoop& loop;
+
+public:
+    AsyncLibrary(Library& lib, EventLoop& eventLoop) : library(lib), loop(eventLoop) {}
+
+    Task<Transaction> borrow(std::string userId, std::string itemId);
+    Task<Library::ReturnSummary> giveBack(std::string userId, std::string itemId);
+
+    // Snapshot and journal reset, written off the loop threads
+    Task<void> checkpoint(std::string snapshotFile);
+};
+
+#endif // ASYNCLIBRARY_H
@@ -0,0 +1,80 @@
+#ifndef AUTOCOMPLETEINDEX_H
+#define AUTOCOMPLETEINDEX_H
+
+#include <string>
+#include <vector>
+#include <cstdint>
+#include <shared_mutex>
+
+/**
+ * One completion and its popularity
+ */
+struct Completion {
+    std::string text;
+    unsigned long long weight;
+};
+
+/**
+ * AutocompleteIndex class - prefix completion over titles or names
+ * Demonstrates: Radix trie, Precomputed top-k
+ *
+ * Entries are keyed by their normalized text (lower-cased, whitespace
+ * collapsed) in a radix trie whose edges carry whole runs of characters.
+ * Edge labels live in one shared character pool and nodes in one array,
+ * linked by index as first child / next sibling, so a node costs a fixed
+ * few dozen bytes.
+ *
+ * Every node keeps the TOP_K heaviest entries below it, heaviest first
+ * (ties by text). A lookup walks the prefix and returns that list, so it
+ * costs O(prefix length) whatever the catalog size. Weights only grow,
+ * so raising one entry only needs to re-rank it in the lists on its own
+ * path.
+ */
+class AutocompleteIndex {
+public:
+    static const size_t TOP_K = 8;
+
+private:
+    static const uint32_t NONE = 0xFFFFFFFFu;
+
+    struct Node {
+        uint32_t labelOffset = 0;
+        uint32_t labelLength = 0;
+        uint32_t firstChild = NONE;
+        uint32_t nextSibling = NONE;
+        uint32_t entry = NONE;  // Entry whose key ends here
+        uint32_t topCount = 0;
+        uint32_t top[TOP_K];    // Entry numbers, heaviest first
+    };
+
+    struct Entry {
+        std::string text; // As first added
+        unsigned long long weight;
+    };
+
+    std::vector<Node> nodes; // nodes[0] is the root
+    std::string labels;
+    std::vector<Entry> entries;
+
+    mutable std::shared_timed_mutex indexMutex;
+
+    static std::string normalize(const std::string& text);
+    bool ranksBefore(uint32_t a, uint32_t b) const;
+    uint32_t findChild(uint32_t node, char first) const;
+    uint32_t addNode(uint32_t parent, const std::string& key, size_t from);
+    void splitNode(uint32_t node, uint32_t at);
+    void promote(uint32_t node, uint32_t entry);
+
+public:
+    AutocompleteIndex();
+
+    // Add 'weight' to the entry for 'text', creating it if needed
+    void add(const std::string& text, unsigned long long weight);
+    void clear();
+    size_t size() const;
+
+    // Up to 'limit' (at most TOP_K) heaviest entries starting with 'prefix'
+    std::vector<Completion> suggest(const std::string& prefix, size_t limit) const;
+};
+
+#endif // AUTOCOMPLETEINDEX_H
@@ -0,0 +1,70 @@
+#ifndef BATCHSESSION_H
+#define BATCHSESSION_H
+
+#include <string>
+#include <vector>
+#include <memory>
+#include <istream>
+#include <ostream>
+#include <exception>
+#include "Library.h"
+
+/**
+ * BatchSession class - line-oriented commands against the Library
+ * Demonstrates: Command interpreter, Structured output
+ *
+ * Each input line is one command. Words are separated by spaces; a
+ * search query is the rest of its line:
+ *
+ *   login USER PASSWORD       logout
+ *   borrow ITEM               return ITEM
+ *   search title|keywords|type QUERY         related ITEM N
+ *   report overdue | report due-soon HOURS | report activity [USER]
+ *   report memory | report popular day|week|month K [type TYPE] [genre GENRE]
+ *
+ * A command answers with zero or more data records followed by one
+ * status record, fields separated by '|' and escaped as in snapshots:
+ *
+ *   OK|command|...
+ *   ERROR|command|CODE|message
+ *
+ * where CODE names the kind of failure (NOT_FOUND, ALREADY_BORROWED,
+ * LIMIT_EXCEEDED, ...). Blank lines and lines starting with '#' are
+ * skipped without output. Output is buffered and written whenever no
+ * further input is waiting, so a driver reading replies never stalls.
+ */
+class BatchSession {
+private:
+    Library& library;
+    std::ostream& out;
+    std::string buffer;           // Records not yet written to 'out'
+    std::shared_ptr<Person> user; // Logged-in user, null if none
+    unsigned long long commandCount;
+    unsigned long long errorCount;
+
+    std::shared_ptr<Person> requireUser(const std::string& command) const;
+    void itemRecords(const std::vector<std::shared_ptr<LibraryItem>>& items);
+    void loanRecords(const std::vector<Transaction>& loans);
+    std::vector<PopularItem> popularItems(const std::vector<std::string>& words);
+    void runCommand(const std::string& command, const std::vector<std::string>& words,
+                    const std::string& rest);
+
+public:
+    BatchSession(Library& lib, std::ostream& output);
+
+    // Run one command line; returns false if it failed
+    bool execute(const std::string& line);
+
+    // Run every line of 'in', then write what is buffered
+    void run(std::istream& in);
+    void flush();
+
+    unsigned long long getCommandCount() const { return commandCount; }
+    unsigned long long getErrorCount() const { return errorCount; }
+    const std::shared_ptr<Person>& getUser() const { return user; }
+
+    // Stable name for the kind of failure 'e' reports
+    static const char* errorCode(const std::exception& e);
+};
+
+#endif // BATCHSESSION_H
@@ -23,7 +23,6 @@ public:
     // Override virtual functions
     void displayInfo() const override;
     std::string getItemType() const override;
-    double getLateFeePerDay() const override;
     
     // Book-specific getters
     std::string getIsbn() const { return isbn; }
@@ -32,7 +31,7 @@ public:
     int getTotalPages() const { return totalPages; }
     
     // Serialization
-    std::string serialize() const override;
+    void writeTo(RecordWriter& out) const override;
     
     // Destructor
     ~Book();
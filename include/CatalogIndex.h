@@ -0,0 +1,74 @@
+#ifndef CATALOGINDEX_H
+#define CATALOGINDEX_H
+
+#include <string>
+#include <vector>
+#include <memory>
+#include <unordered_map>
+#include <cstdint>
+#include <shared_mutex>
+#include "LibraryItem.h"
+
+/**
+ * Conjunctive item query; empty fields are not constrained
+ */
+struct ItemQuery {
+    std::string isbn;
+    std::string author;
+    std::string genre;
+    std::string field;    // Journal research field
+    std::string category; // Magazine category
+    std::string type;     // "Book", "Magazine" or "Journal"
+};
+
+/**
+ * CatalogIndex class - secondary indexes over item attributes
+ * Demonstrates: Hash indexes, Posting-list intersection
+ *
+ * Every indexed item gets an ordinal in insertion order, and each key
+ * maps to the ascending list of ordinals carrying it, so lists stay
+ * sorted by appending. ISBNs are keyed without hyphens or spaces; the
+ * other keys are lower-cased with whitespace collapsed, so "Thomas H.
+ * Cormen" and "thomas  h. cormen" are the same author.
+ *
+ * A query intersects the lists of its predicates, smallest first,
+ * probing each larger list by binary search, and stops as soon as the
+ * running result is empty.
+ */
+class CatalogIndex {
+private:
+    typedef std::vector<uint32_t> Postings;
+    typedef std::unordered_map<std::string, Postings> KeyIndex;
+
+    std::vector<std::string> itemIds; // Ordinal -> item ID
+    KeyIndex byIsbn;
+    KeyIndex byAuthor;
+    KeyIndex byGenre;
+    KeyIndex byField;
+    KeyIndex byCategory;
+    KeyIndex byType;
+
+    mutable std::shared_timed_mutex indexMutex;
+
+    static std::string normalizeIsbn(const std::string& isbn);
+    static void insert(KeyIndex& index, const std::string& key, uint32_t ordinal);
+    static const Postings* lookup(const KeyIndex& index, const std::string& key);
+    std::vector<std::string> toItemIds(const Postings& ordinals) const;
+
+public:
+    // Lower case with runs of spaces collapsed, as attribute keys are compared
+    static std::string normalizeText(const std::string& text);
+
+    // Index one item under each attribute its kind has
+    void add(const std::shared_ptr<LibraryItem>& item);
+    void clear();
+
+    // Item IDs with this ISBN (normally one)
+    std::vector<std::string> findByIsbn(const std::string& isbn) const;
+
+    // Item IDs matching every non-empty field of the query, in ID order.
+    // A query with no fields set matches nothing.
+    std::vector<std::string> find(const ItemQuery& query) const;
+};
+
+#endif // CATALOGINDEX_H
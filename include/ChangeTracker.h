@@ -0,0 +1,38 @@
+#ifndef CHANGETRACKER_H
+#define CHANGETRACKER_H
+
+#include <string>
+#include <vector>
+#include <set>
+#include <mutex>
+
+/**
+ * ChangeTracker class - records changed since the last save
+ * Demonstrates: Dirty tracking
+ *
+ * Mutations mark the users, items and transaction log slots they touch;
+ * a delta save writes exactly those records and then clears the marks.
+ * Marking locks an internal mutex because journal replay mutates
+ * different items from several threads.
+ */
+class ChangeTracker {
+private:
+    std::set<std::string> users;
+    std::set<std::string> items;
+    std::set<size_t> transactions;
+    mutable std::mutex mutex;
+
+public:
+    void markUser(const std::string& userId);
+    void markItem(const std::string& itemId);
+    void markTransaction(size_t index);
+    void clear();
+
+    // Marked records, in key order
+    std::vector<std::string> getUsers() const;
+    std::vector<std::string> getItems() const;
+    std::vector<size_t> getTransactions() const;
+    size_t size() const;
+};
+
+#endif // CHANGETRACKER_H
@@ -0,0 +1,79 @@
+#ifndef COBORROWINDEX_H
+#define COBORROWINDEX_H
+
+#include <string>
+#include <vector>
+#include <unordered_map>
+#include <utility>
+#include <cstdint>
+#include <shared_mutex>
+#include "TaskPool.h"
+
+// An item often borrowed by the same patrons as another
+struct Recommendation {
+    std::string itemId;
+    unsigned coBorrows; // Times a patron borrowed both within their recent history
+};
+
+/**
+ * CoBorrowIndex class - "patrons who borrowed X also borrowed Y"
+ * Demonstrates: Sparse co-occurrence matrix, Sliding windows, Pruning
+ *
+ * Every patron has a window of the last HISTORY distinct items they
+ * borrowed. A borrow pairs the new item with each item in the window,
+ * adding one to both cells of a sparse item-item matrix. Borrowing an
+ * item already in the window only makes it the newest again.
+ *
+ * Items are numbered on first sight. Each row is a short flat array of
+ * (item, count) cells. A row that grows past 2 * KEEP cells is pruned
+ * to its KEEP strongest, so memory stays linear in the number of items
+ * and a query ranks at most 2 * KEEP cells. It never touches history.
+ *
+ * rebuild() recomputes everything from the full borrow history. The
+ * patrons' windows are replayed in parallel to find which borrows paired
+ * their item; then each row is counted on its own from where its item
+ * was borrowed, so workers share no counters and nothing is merged. Rows
+ * come out exact before pruning, the same as feeding the borrows to
+ * recordBorrow() one by one where no pruning happens.
+ */
+class CoBorrowIndex {
+public:
+    static const size_t HISTORY = 20; // Recent distinct items per patron
+    static const size_t KEEP = 64;    // Cells per row after pruning
+
+private:
+    struct Cell {
+        uint32_t item;
+        uint32_t count;
+    };
+    typedef std::vector<Cell> Row;
+
+    std::unordered_map<std::string, uint32_t> ordinals; // itemId -> row
+    std::vector<std::string> itemIds;                   // row -> itemId
+    std::vector<Row> rows;
+    std::unordered_map<std::string, std::vector<uint32_t>> histories; // userId -> oldest first
+    mutable std::shared_timed_mutex mutex;
+
+    uint32_t ordinalOf(const std::string& itemId);
+    void addPair(uint32_t a, uint32_t b, uint32_t count);
+    static void prune(Row& row);
+    static bool stronger(const Cell& a, const Cell& b);
+
+public:
+    // Count one borrow, in the order borrows happen
+    void recordBorrow(const std::string& userId, const std::string& itemId);
+
+    // Replace everything with the pairs from 'borrows', (userId, itemId)
+    // in the order they happened
+    void rebuild(const std::vector<std::pair<std::string, std::string>>& borrows,
+                 TaskPool& pool);
+
+    // Up to 'n' items most often paired with 'itemId', strongest first
+    std::vector<Recommendation> related(const std::string& itemId, size_t n) const;
+
+    size_t getItemCount() const;
+    size_t getCellCount() const;
+    void clear();
+};
+
+#endif // COBORROWINDEX_H
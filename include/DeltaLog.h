@@ -0,0 +1,59 @@
+#ifndef DELTALOG_H
+#define DELTALOG_H
+
+#include <string>
+#include <vector>
+#include <cstdint>
+
+/**
+ * DeltaLog class - checksummed chain of delta snapshots after a base
+ * Demonstrates: Hash chaining, Crash-safe appends
+ *
+ * Each block carries the records that changed between two journal
+ * sequences, preceded by a header line:
+ *
+ *   DELTA|fromSequence|toSequence|bodyBytes|previousChecksum|checksum
+ *
+ * The checksum is a CRC-32 of the body seeded with the previous block's
+ * checksum (0 for the first), so a block only verifies in its place in
+ * the chain. Reading stops at the first block that is torn, corrupt or
+ * out of chain, and the file is cut back to the blocks before it so
+ * later appends continue a valid chain.
+ */
+class DeltaLog {
+public:
+    struct Block {
+        unsigned long long fromSequence;
+        unsigned long long toSequence;
+        std::string body;
+    };
+
+private:
+    std::string path;
+    uint32_t lastChecksum;
+    size_t blockCount;
+    size_t byteCount;
+
+public:
+    // Constructor
+    DeltaLog();
+
+    // Read the valid blocks of 'filename' (none if it is missing) and
+    // append to it from then on
+    std::vector<Block> open(const std::string& filename);
+
+    // Add one block and sync it to disk
+    void append(unsigned long long fromSequence, unsigned long long toSequence,
+                const std::string& body);
+
+    // Empty the chain, after its blocks were compacted into a new base
+    void reset(const std::string& filename);
+
+    const std::string& getPath() const { return path; }
+    size_t getBlockCount() const { return blockCount; }
+    size_t getByteCount() const { return byteCount; }
+
+    static uint32_t crc32(const char* data, size_t size, uint32_t seed);
+};
+
+#endif // DELTALOG_H
@@ -0,0 +1,91 @@
+#ifndef EVENTJOURNAL_H
+#define EVENTJOURNAL_H
+
+#include <string>
+#include <vector>
+#include <cstdio>
+#include <functional>
+#include <exception>
+#include <thread>
+#include <mutex>
+#include <atomic>
+#include <condition_variable>
+#include "LibraryEvent.h"
+#include "TaskPool.h"
+
+/**
+ * EventJournal class - append-only file of LibraryEvents
+ * Demonstrates: RAII, File I/O, Parallel parsing
+ *
+ * One event per line. Each append is flushed to the operating system,
+ * so a crash of the process loses at most the event being written; a
+ * torn final line is ignored on replay.
+ *
+ * Deferred appends are group-committed instead: a background writer
+ * writes everything queued since its last write in one go, syncs it to
+ * disk with fdatasync() and then notifies each caller, so a notified
+ * event survives a power loss and many writers share one sync.
+ *
+ * A failed write marks the journal failed until it is opened again; the
+ * events in it may or may not be on disk.
+ */
+class EventJournal {
+public:
+    // Runs once a deferred event is on disk; carries the error if it is not
+    typedef std::function<void(std::exception_ptr)> DurableCallback;
+
+private:
+    std::string path;
+    FILE* file;
+
+    // Group commit: lines and callbacks waiting for the writer thread
+    std::string pendingLines;
+    std::vector<DurableCallback> pendingCallbacks;
+    std::mutex pendingMutex;
+    std::condition_variable pendingReady;
+    std::thread writer;
+    bool stopWriter;
+
+    std::mutex ioMutex; // Held while writing to 'file'
+    std::atomic<bool> failed;
+
+    // Write queued lines; caller holds ioMutex. Returns their callbacks.
+    std::vector<DurableCallback> writePending(std::exception_ptr& error);
+    static void notify(std::vector<DurableCallback>& callbacks, std::exception_ptr error);
+    void writerLoop();
+    void stopWriterThread();
+
+public:
+    // Constructor
+    EventJournal();
+
+    // Non-copyable (owns a FILE*)
+    EventJournal(const EventJournal&) = delete;
+    EventJournal& operator=(const EventJournal&) = delete;
+
+    // Open for appending, creating the file if needed
+    void open(const std::string& filename);
+    void close();
+    bool isOpen() const { return file != nullptr; }
+    const std::string& getPath() const { return path; }
+    bool hasFailed() const { return failed.load(std::memory_order_acquire); }
+
+    // Write and flush one event before returning
+    void append(const LibraryEvent& event);
+
+    // Queue an event for the next group commit; 'onDurable' runs on the
+    // writer thread once it is synced. Events keep their append order.
+    void appendDeferred(const LibraryEvent& event, DurableCallback onDurable);
+
+    // Discard all journaled events (after a snapshot has captured them)
+    void truncate();
+
+    // Read and parse a whole journal, splitting the work across the pool.
+    // Events come back in file order; a missing file yields no events.
+    static std::vector<LibraryEvent> readAll(const std::string& filename, TaskPool& pool);
+
+    // Destructor
+    ~EventJournal();
+};
+
+#endif // EVENTJOURNAL_H
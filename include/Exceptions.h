@@ -70,4 +70,11 @@ public:
         : LibraryException("Borrow limit exceeded: " + reason) {}
 };
 
+// Exception for a change that was made but whose journal write failed
+class NotDurableException : public LibraryException {
+public:
+    explicit NotDurableException(const std::string& reason)
+        : LibraryException("Applied but not durable: " + reason) {}
+};
+
 #endif // EXCEPTIONS_H
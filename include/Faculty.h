@@ -22,8 +22,6 @@ public:
     // Override virtual functions
     void displayInfo() const override;
     std::string getRole() const override;
-    int getMaxBorrowLimit() const override;
-    int getBorrowDuration() const override;
     
     // Faculty-specific getters
     std::string getEmployeeId() const { return employeeId; }
@@ -31,7 +29,7 @@ public:
     std::string getDesignation() const { return designation; }
     
     // Serialization
-    std::string serialize() const override;
+    void writeTo(RecordWriter& out) const override;
     
     // Destructor
     ~Faculty();
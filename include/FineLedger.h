@@ -0,0 +1,66 @@
+#ifndef FINELEDGER_H
+#define FINELEDGER_H
+
+#include <string>
+#include <vector>
+#include <ctime>
+#include <mutex>
+#include <unordered_map>
+
+/**
+ * Kinds of ledger entries.
+ * Accruals and assessments raise a balance; payments and waivers lower it.
+ */
+enum class LedgerEntryType {
+    Accrual,    // Daily fine on a loan that is still out and overdue
+    Assessment, // Remainder of the fine charged when an overdue item is returned
+    Payment,
+    Waiver
+};
+
+struct LedgerEntry {
+    std::string userId;
+    std::string reference; // Transaction ID, or a note for payments and waivers
+    LedgerEntryType type;
+    double amount;         // Always positive; the type gives the direction
+    time_t timestamp;
+};
+
+/**
+ * FineLedger class - append-only fine history with running balances
+ * Demonstrates: Materialized aggregates, Encapsulation
+ *
+ * Posting locks an internal mutex so returns replayed on different
+ * threads can charge fines concurrently.
+ */
+class FineLedger {
+private:
+    std::vector<LedgerEntry> entries;
+    std::unordered_map<std::string, double> balances;                 // userId -> outstanding
+    std::unordered_map<std::string, std::vector<size_t>> userEntries; // userId -> entry indexes
+    mutable std::mutex mutex;
+
+    void append(const LedgerEntry& entry);
+
+public:
+    // Record an entry and update the user's running balance
+    void post(const std::string& userId, const std::string& reference,
+              LedgerEntryType type, double amount, time_t when);
+
+    // Re-add an entry read from a snapshot, keeping its timestamp
+    void restore(const LedgerEntry& entry);
+
+    // O(1) balance lookup
+    double getBalance(const std::string& userId) const;
+
+    std::vector<LedgerEntry> getUserEntries(const std::string& userId) const;
+    std::vector<LedgerEntry> getEntries() const;
+    std::vector<LedgerEntry> getEntriesSince(size_t first) const; // Entries after the first N
+    size_t getEntryCount() const;
+    void clear();
+
+    static std::string typeToString(LedgerEntryType type);
+    static LedgerEntryType typeFromString(const std::string& name);
+};
+
+#endif // FINELEDGER_H
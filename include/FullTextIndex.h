@@ -0,0 +1,99 @@
+#ifndef FULLTEXTINDEX_H
+#define FULLTEXTINDEX_H
+
+#include <string>
+#include <vector>
+#include <memory>
+#include <unordered_map>
+#include <cstdint>
+#include <shared_mutex>
+#include "LibraryItem.h"
+
+/**
+ * One ranked full-text match: the item and its BM25 score
+ */
+struct TextMatch {
+    std::string itemId;
+    double score;
+};
+
+/**
+ * FullTextIndex class - ranked keyword search over item records
+ * Demonstrates: Inverted index, Variable-byte compression, Top-k retrieval
+ *
+ * Each item is indexed as one document made of its title, publisher and
+ * the fields of its kind (author and genre, editor and research field,
+ * month and category). Text is split into runs of letters and digits and
+ * lower-cased; bytes outside ASCII are kept as word characters so UTF-8
+ * words survive intact.
+ *
+ * A term's posting list holds (document, term frequency) pairs in
+ * document order, stored as varint-encoded document gaps and frequencies.
+ * Every SKIP_INTERVAL postings a skip entry records where a block starts,
+ * so a cursor can jump forward without decoding the postings it passes.
+ *
+ * Queries are scored with BM25 (k1 = 1.2, b = 0.75) and any query term
+ * may match. Top-k retrieval uses MaxScore: each term carries an upper
+ * bound on its contribution, and once k results are held, terms whose
+ * bounds together cannot reach the k-th score only refine documents
+ * found through the other terms, and stop as soon as a document cannot
+ * qualify.
+ *
+ * Documents are only ever added, so lists grow by appending. The index
+ * is saved to a binary file beside each snapshot, stamped with the
+ * snapshot's journal sequence and document count.
+ */
+class FullTextIndex {
+private:
+    static const uint32_t SKIP_INTERVAL = 64;
+
+    struct SkipEntry {
+        uint32_t baseDoc; // Last document before the block
+        uint32_t offset;  // Byte offset of the block
+        uint32_t index;   // Number of postings before the block
+    };
+
+    struct PostingList {
+        std::vector<uint8_t> bytes; // varint(doc gap), varint(tf) per posting
+        std::vector<SkipEntry> skips;
+        uint32_t count = 0;
+        uint32_t lastDoc = 0;
+        uint32_t maxTf = 0;
+    };
+
+    class Cursor;
+
+    std::vector<std::string> itemIds;  // Document number -> item ID
+    std::vector<uint32_t> docLengths;  // Tokens per document
+    uint64_t totalLength = 0;
+    uint32_t minLength = 0;
+    std::unordered_map<std::string, PostingList> postings;
+
+    mutable std::shared_timed_mutex indexMutex;
+
+    static void appendVarint(std::vector<uint8_t>& bytes, uint32_t value);
+    static std::vector<std::string> documentText(const LibraryItem& item);
+    double averageLength() const;
+    double idf(const PostingList& list) const;
+    double termScore(double idf, uint32_t tf, uint32_t length) const;
+
+public:
+    // Lower-cased words of 'text', in order
+    static std::vector<std::string> tokenize(const std::string& text);
+
+    void add(const LibraryItem& item);
+    void clear();
+    size_t size() const;
+
+    // Up to 'limit' items (0 = all) matching any query word, best first
+    // (ties by item ID)
+    std::vector<TextMatch> search(const std::string& query, size_t limit) const;
+
+    // Binary index file stamped with 'sequence'. load() returns false and
+    // leaves the index empty when the file is missing, unreadable or was
+    // written for another sequence or document count.
+    void save(const std::string& filename, unsigned long long sequence) const;
+    bool load(const std::string& filename, unsigned long long sequence, size_t documents);
+};
+
+#endif // FULLTEXTINDEX_H
@@ -0,0 +1,78 @@
+#ifndef HOLDMANAGER_H
+#define HOLDMANAGER_H
+
+#include <string>
+#include <vector>
+#include <map>
+#include <set>
+#include <queue>
+#include <ctime>
+#include <mutex>
+#include <unordered_map>
+#include "HoldQueue.h"
+
+/**
+ * A copy set aside for a patron, waiting to be picked up
+ */
+struct ReadyHold {
+    std::string itemId;
+    std::string userId;
+    std::string barcode;
+    time_t expiresAt;
+};
+
+/**
+ * HoldManager class - hold queues and pickup shelf for all items
+ * Demonstrates: Composition, Min-heap with lazy deletion
+ *
+ * All methods lock an internal mutex so journal replay can apply
+ * events for different items on different threads.
+ */
+class HoldManager {
+private:
+    typedef std::pair<std::string, std::string> HoldKey; // (itemId, userId)
+    typedef std::pair<time_t, HoldKey> ExpiryEntry;
+
+    std::unordered_map<std::string, ItemHoldQueue> queues;            // itemId -> waiting list
+    std::map<HoldKey, ReadyHold> ready;                               // Pickup shelf
+    std::unordered_map<std::string, std::set<std::string>> userHolds; // userId -> itemIds
+    std::priority_queue<ExpiryEntry, std::vector<ExpiryEntry>,
+                        std::greater<ExpiryEntry>> expiries;          // Soonest first
+    mutable std::mutex mutex;
+
+public:
+    // Days a ready hold waits on the pickup shelf
+    static const int PICKUP_DAYS = 3;
+
+    // Waiting list
+    void placeHold(const std::string& itemId, const std::string& userId, HoldPriority priority);
+    bool cancelWaiting(const std::string& itemId, const std::string& userId);
+    std::string popNextWaiting(const std::string& itemId); // "" when nobody waits
+    bool hasWaiting(const std::string& itemId) const;
+    int getQueuePosition(const std::string& itemId, const std::string& userId) const;
+    int getQueueLength(const std::string& itemId) const;
+
+    // Pickup shelf
+    void markReady(const std::string& itemId, const std::string& userId,
+                   const std::string& barcode, time_t now);
+    void restoreReady(const ReadyHold& hold);
+    bool findReady(const std::string& itemId, const std::string& userId, ReadyHold& hold) const;
+    ReadyHold takeReady(const std::string& itemId, const std::string& userId);
+
+    // Remove the soonest ready hold whose pickup window closed by 'now'
+    // (across all items, or for one item); false if there is none
+    bool takeEarliestExpired(time_t now, ReadyHold& hold);
+    bool takeEarliestExpired(const std::string& itemId, time_t now, ReadyHold& hold);
+
+    // All items a user is waiting for or may pick up
+    std::vector<std::string> getUserHolds(const std::string& userId) const;
+
+    // Snapshot support
+    std::vector<std::pair<std::string, std::string>> getWaitingEntries() const; // (itemId, userId)
+    std::vector<ReadyHold> getReadyHolds() const;
+    std::vector<ReadyHold> getReadyHolds(const std::string& itemId) const;
+    size_t getHoldCount() const; // Waiting plus ready
+    void clear();
+};
+
+#endif // HOLDMANAGER_H
@@ -0,0 +1,65 @@
+#ifndef HOLDQUEUE_H
+#define HOLDQUEUE_H
+
+#include <string>
+#include <vector>
+#include <unordered_map>
+
+/**
+ * Hold priority classes; lower values are served first
+ */
+enum class HoldPriority {
+    Faculty = 0,
+    Librarian = 1,
+    Student = 2
+};
+
+// Map a Person::getRole() string onto its hold priority class
+HoldPriority holdPriorityForRole(const std::string& role);
+
+/**
+ * ItemHoldQueue class - waiting list of patrons for one item
+ * Demonstrates: Priority classes with FIFO fairness, Fenwick trees
+ *
+ * Each priority class is an append-only array of user IDs with a head
+ * cursor. A Fenwick tree over the array marks live entries so a patron's
+ * position is a prefix sum (O(log n)), while popping the next patron only
+ * advances the head cursor (amortized O(1)).
+ */
+class ItemHoldQueue {
+private:
+    static const int PRIORITY_LEVELS = 3;
+
+    struct Level {
+        std::vector<std::string> users; // In arrival order
+        std::vector<int> tree;          // 1-based Fenwick tree of live flags
+        size_t head;                    // First entry not yet popped
+        int live;                       // Entries still waiting
+
+        Level() : head(0), live(0) {}
+        void append(const std::string& userId);
+        void remove(size_t index);
+        int prefix(size_t count) const; // Live entries among the first 'count'
+        void reset();
+    };
+
+    Level levels[PRIORITY_LEVELS];
+    std::unordered_map<std::string, std::pair<int, size_t>> positions; // userId -> (level, index)
+
+public:
+    // Queue operations
+    void enqueue(const std::string& userId, HoldPriority priority);
+    bool cancel(const std::string& userId);
+    std::string popNext(); // Returns "" when empty
+
+    // Queries
+    bool contains(const std::string& userId) const;
+    int positionOf(const std::string& userId) const; // 1-based, 0 if not queued
+    int size() const { return static_cast<int>(positions.size()); }
+    bool empty() const { return positions.empty(); }
+
+    // Waiting users in service order
+    std::vector<std::string> entries() const;
+};
+
+#endif // HOLDQUEUE_H
@@ -0,0 +1,70 @@
+#ifndef HOLDINGS_H
+#define HOLDINGS_H
+
+#include <string>
+#include <vector>
+#include <atomic>
+#include <unordered_map>
+
+/**
+ * State of a single physical copy
+ */
+enum class CopyState {
+    Available,
+    OnLoan,
+    OnHoldShelf // Set aside for a patron whose hold came up
+};
+
+/**
+ * Lightweight record for one physical copy of a title.
+ * Bibliographic data (title, author, ISBN, ...) is stored once in the
+ * owning LibraryItem, so a copy only carries its barcode and state.
+ */
+struct ItemCopy {
+    std::string barcode;
+    CopyState state;
+    std::string borrower; // userId while on loan or on the hold shelf, empty otherwise
+};
+
+/**
+ * Holdings class - all physical copies of one title
+ * Demonstrates: Composition, Free-list allocation, Atomic counters
+ */
+class Holdings {
+private:
+    std::vector<ItemCopy> copies;
+    std::vector<int> freeCopies;                       // Stack of available copy indexes
+    std::unordered_map<std::string, int> barcodeIndex; // Barcode -> copy index
+    std::atomic<int> availableCopies;                  // Lock-free availability reads
+
+public:
+    // Constructor
+    Holdings();
+
+    // Copy management
+    int addCopy(const std::string& barcode);
+
+    // Check out any free copy in O(1); returns the copy index or -1 if none is free
+    int checkoutAny(const std::string& userId);
+
+    // Check a copy back in and return it to the free list
+    void checkin(int copyIndex);
+
+    // Hold shelf: set aside any free copy for a patron, then lend or release it
+    int reserveAny(const std::string& userId);
+    void lendReserved(int copyIndex, const std::string& userId);
+    void releaseReserved(int copyIndex);
+
+    // Put a free copy straight into a given state (used when restoring a snapshot)
+    void restoreCopy(int copyIndex, CopyState state, const std::string& userId);
+
+    // Lookup
+    int findCopy(const std::string& barcode) const;
+    const ItemCopy& getCopy(int copyIndex) const { return copies[copyIndex]; }
+
+    // Counters
+    int getTotalCopies() const { return static_cast<int>(copies.size()); }
+    int getAvailableCopies() const { return availableCopies.load(std::memory_order_acquire); }
+};
+
+#endif // HOLDINGS_H
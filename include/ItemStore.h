@@ -0,0 +1,140 @@
+#ifndef ITEMSTORE_H
+#define ITEMSTORE_H
+
+#include <string>
+#include <vector>
+#include <map>
+#include <memory>
+#include <atomic>
+#include <functional>
+#include <shared_mutex>
+#include "LibraryItem.h"
+#include "MappedFile.h"
+
+/**
+ * ItemStore class - catalog items by ID, optionally decoded on demand
+ * Demonstrates: Lazy loading, CLOCK eviction, Reader-writer locking
+ *
+ * Items added as objects stay resident. Items added lazily carry only
+ * their hot fields (kind and free copies) plus the location of their
+ * record in a mapped snapshot; the full object is decoded by the loader
+ * on first access. At most 'capacity' decoded items that were never
+ * changed are kept, evicting by the CLOCK algorithm: each access sets a
+ * reference bit, and the sweep spares an item once per bit. An item
+ * changes only through a resident object, so pin() keeps it resident
+ * from then on, and an unchanged item decodes to the same state again.
+ * An item some caller still holds is never evicted.
+ *
+ * The copies a lazy item had out at load time are kept in its entry and
+ * put back after decoding, so decoding reads nothing outside the store
+ * and is safe from any thread. Visits walk a list of entries taken under
+ * the lock, so items added meanwhile do not disturb them.
+ */
+class ItemStore {
+public:
+    // Decodes one snapshot record into an item with every copy on the shelf
+    typedef std::function<std::shared_ptr<LibraryItem>(const char* record, size_t length)> Loader;
+
+private:
+    struct RestoredCopy {
+        std::string barcode;
+        CopyState state;
+        std::string userId;
+    };
+
+    struct Entry {
+        std::shared_ptr<LibraryItem> item; // Resident object, or null until first access
+        const char* record;                // Line in the mapped snapshot (lazy entries)
+        size_t length;
+        std::string type;                  // "Book", "Magazine" or "Journal"
+        int availableCopies;               // Free copies while not resident
+        std::vector<RestoredCopy> restored; // Copies out at load time (lazy entries)
+        bool pinned;                       // Changed since load: never evicted
+        std::atomic<bool> referenced;      // CLOCK reference bit
+
+        Entry() : record(nullptr), length(0), availableCopies(0), pinned(false),
+                  referenced(false) {}
+    };
+    typedef std::map<std::string, Entry> EntryMap;
+
+    EntryMap entries;
+    std::vector<EntryMap::iterator> clock; // Decoded entries that may be evicted
+    size_t hand;
+    size_t capacity;                       // 0: never evict
+    Loader loader;
+    std::unique_ptr<MappedFile> mapping;   // Snapshot the lazy records point into
+    std::atomic<unsigned long long> loads;
+    std::atomic<unsigned long long> evictions;
+    mutable std::shared_timed_mutex mutex;
+
+    std::shared_ptr<LibraryItem> resident(EntryMap::iterator it);
+    std::shared_ptr<LibraryItem> decode(EntryMap::const_iterator it) const;
+    std::shared_ptr<LibraryItem> build(const Entry& entry) const; // Caller holds the lock
+    std::vector<EntryMap::iterator> listEntries();
+    std::vector<EntryMap::const_iterator> listEntries() const;
+    void evict();
+
+public:
+    ItemStore();
+
+    void setLoader(Loader decoder) { loader = std::move(decoder); }
+    void setCapacity(size_t maxDecoded) { capacity = maxDecoded; }
+    size_t getCapacity() const { return capacity; }
+
+    // Keep the snapshot that lazy records point into mapped
+    void adoptMapping(std::unique_ptr<MappedFile> file);
+
+    // Add a resident item (pinned), or the record of one to decode later
+    void add(const std::shared_ptr<LibraryItem>& item);
+    void addLazy(const std::string& itemId, const char* record, size_t length,
+                 const std::string& type, int totalCopies);
+
+    // The item, decoding it on first access; null if there is none
+    std::shared_ptr<LibraryItem> find(const std::string& itemId);
+    bool contains(const std::string& itemId) const;
+
+    // Keep an item resident because its state is about to change
+    void pin(const std::string& itemId);
+
+    // Snapshot restore: put a copy on loan or on the hold shelf. A lazy
+    // item only counts it; its loader restores the copy when decoding.
+    void restoreCopy(const std::string& itemId, const std::string& barcode,
+                     CopyState state, const std::string& userId);
+
+    // Every item in ID order, decoded and cached
+    template <typename Visitor>
+    void forEach(Visitor visit) {
+        for (auto it : listEntries()) {
+            visit(resident(it));
+        }
+    }
+
+    // Every item in ID order; items not resident are decoded for the
+    // visit only, so a full pass does not flush the cache
+    template <typename Visitor>
+    void scan(Visitor visit) const {
+        for (auto it : listEntries()) {
+            visit(decode(it));
+        }
+    }
+
+    // Hot fields of every item in ID order, without decoding any
+    template <typename Visitor>
+    void forEachSummary(Visitor visit) const {
+        std::shared_lock<std::shared_timed_mutex> lock(mutex);
+        for (const auto& pair : entries) {
+            const Entry& entry = pair.second;
+            visit(pair.first, entry.type,
+                  entry.item ? entry.item->getAvailableCopies() : entry.availableCopies);
+        }
+    }
+
+    size_t size() const;
+    bool empty() const { return size() == 0; }
+    size_t getResidentCount() const;
+    unsigned long long getLoadCount() const { return loads.load(); }
+    unsigned long long getEvictionCount() const { return evictions.load(); }
+    void clear();
+};
+
+#endif // ITEMSTORE_H
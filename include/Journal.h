@@ -22,7 +22,6 @@ public:
     // Override virtual functions
     void displayInfo() const override;
     std::string getItemType() const override;
-    double getLateFeePerDay() const override;
     
     // Journal-specific getters
     int getVolumeNumber() const { return volumeNumber; }
@@ -31,7 +30,7 @@ public:
     bool getIsPeerReviewed() const { return isPeerReviewed; }
     
     // Serialization
-    std::string serialize() const override;
+    void writeTo(RecordWriter& out) const override;
     
     // Destructor
     ~Journal();
@@ -21,8 +21,6 @@ public:
     // Override virtual functions
     void displayInfo() const override;
     std::string getRole() const override;
-    int getMaxBorrowLimit() const override;
-    int getBorrowDuration() const override;
     
     // Librarian-specific getters
     std::string getEmployeeId() const { return employeeId; }
@@ -32,7 +30,7 @@ public:
     bool hasAdminAccess() const { return true; }
     
     // Serialization
-    std::string serialize() const override;
+    void writeTo(RecordWriter& out) const override;
     
     // Destructor
     ~Librarian();
@@ -4,6 +4,10 @@
 #include <vector>
 #include <map>
 #include <memory>
+#include <unordered_map>
+#include <mutex>
+#include <functional>
+#include <atomic>
 #include "Person.h"
 #include "Student.h"
 #include "Faculty.h"
@@ -13,6 +17,28 @@
 #include "Magazine.h"
 #include "Journal.h"
 #include "Transaction.h"
+#include "TransactionStore.h"
+#include "HoldManager.h"
+#include "FineLedger.h"
+#include "LibraryStats.h"
+#include "LibraryEvent.h"
+#include "EventJournal.h"
+#include "SharedCatalog.h"
+#include "TaskPool.h"
+#include "TitleIndex.h"
+#include "CatalogIndex.h"
+#include "FullTextIndex.h"
+#include "AutocompleteIndex.h"
+#include "QueryCache.h"
+#include "OrderedIndex.h"
+#include "ChangeTracker.h"
+#include "DeltaLog.h"
+#include "ItemStore.h"
+#include "LoanPolicy.h"
+#include "WorkloadTrace.h"
+#include "MemoryAccounting.h"
+#include "PopularityTracker.h"
+#include "CoBorrowIndex.h"
 
 /**
  * Library class - Main system management
@@ -25,14 +51,163 @@ private:
     
     // STL Containers
     std::map<std::string, std::shared_ptr<Person>> users;
-    std::map<std::string, std::shared_ptr<LibraryItem>> items;
-    std::vector<Transaction> transactions;
+    mutable ItemStore items; // Lookups may decode an item in a lazy catalog
+    TransactionStore transactions; // Slots allocated before taking stateMutex
+    HoldManager holds;
+    FineLedger fineLedger;
+    LibraryStats stats;
+    
+    // Secondary indexes over item fields. A lazy catalog builds them on the
+    // first query that needs them, so they may be filled from const calls.
+    mutable TitleIndex titleIndex;
+    mutable CatalogIndex catalogIndex;
+    mutable FullTextIndex fullTextIndex;
+    
+    // Prefix completions weighted by how often the item was borrowed
+    mutable AutocompleteIndex titleCompletions;
+    mutable AutocompleteIndex authorCompletions;
+    
+    // Most borrowed items over the last day, week and month; built with
+    // the other indexes in a lazy catalog
+    mutable PopularityTracker popularity;
+    
+    // Items borrowed by the same patrons, updated on every checkout and
+    // rebuilt from the transactions after a load or recovery
+    mutable CoBorrowIndex coBorrows;
+    
+    // Title, type and availability results, invalidated by generation
+    mutable QueryCache queryCache;
+    
+    // Ordered indexes for range queries; transactions are keyed by log index
+    mutable OrderedIndex<int, std::string> yearIndex; // publicationYear -> itemId
+    OrderedIndex<time_t, size_t> dueIndex;    // dueDate of open loans
+    OrderedIndex<time_t, size_t> borrowIndex; // borrowDate of every loan
+    
+    // Serializes mutations with each other and with snapshot publication.
+    // Reports pin a TransactionSnapshot and scan it without holding this.
+    mutable std::mutex stateMutex;
+    
+    // Open loans: itemId -> (userId -> index into transactions)
+    std::unordered_map<std::string, std::unordered_map<std::string, size_t>> openLoans;
+    
+    // Event sourcing
+    EventJournal journal;
+    unsigned long long lastSequence; // Sequence of the last event applied
+    
+    // Delta snapshots: records changed since the last save, appended to a
+    // chain after the base snapshot until it is compacted into a new base
+    ChangeTracker changes;
+    DeltaLog deltaLog;
+    unsigned long long savedSequence; // Sequence covered by the base plus its deltas
+    size_t ledgerSaved;               // Ledger entries already saved
+    size_t baseBytes;                 // Size of the base snapshot (0: compact next)
+    
+    // Lazy catalog: items decode from the mapped snapshot on first access,
+    // and the secondary indexes wait for the first query that needs them
+    bool lazyCatalog;
+    mutable std::atomic<bool> indexesDeferred;
+    mutable std::string deferredFullTextFile;      // Index saved with the base
+    mutable unsigned long long deferredSequence;   // Base sequence it is stamped with
+    mutable size_t deferredItemCount;              // Base items it covers
+    mutable std::vector<std::string> unindexedItems; // Items added since the base
+    
+    // Loan terms by role and item kind, recompiled when the policy file changes
+    LoanPolicy loanPolicy;
+    std::string policyFile;   // Empty: built-in defaults only
+    std::string policyBranch;
+    std::string policyStamp;  // Modification time and size of the file compiled
+    time_t policyChecked;     // Last time the file was looked at
+    
+    // Workload capture: borrows, returns and searches as they arrive
+    std::unique_ptr<TraceRecorder> traceRecorder;
+    
+    // Cross-process read-only catalog, when this process is its owner
+    std::unique_ptr<SharedCatalog> sharedCatalog;
+    
+    // Workers for parallel reports and batch jobs (fine accrual, replay)
+    std::unique_ptr<TaskPool> taskPool;
+    
+    struct AccrualSummary {
+        double totalAccrued;
+        int loanCount;
+        int userCount;
+    };
     
     // Private constructor for singleton
     Library();
     
     // Helper functions
-    int getNextTransactionId() const;
+    static size_t transactionIndex(const std::string& transactionId);
+    void promoteHolds(const std::shared_ptr<LibraryItem>& item, time_t now);
+    void expireHolds(const std::shared_ptr<LibraryItem>& item, time_t now);
+    void sweepExpiredHolds();
+    void refreshLoanPolicy(time_t now);
+    const LoanRule& loanTerms(const Person& user, const LibraryItem& item) const;
+    void addCompletions(const LibraryItem& item, unsigned long long borrows) const;
+    void recordPopularity(const LibraryItem& item, time_t when) const;
+    void rebuildPopularity() const;
+    void rebuildCoBorrows() const;
+    void onCopiesChanged(const LibraryItem& item, int copiesBefore);
+    std::shared_ptr<LibraryItem> loadItem(const char* record, size_t length) const;
+    void ensureIndexes() const;
+    void buildDeferredIndexes() const;
+    std::vector<Transaction> transactionsAt(const std::vector<size_t>& indexes, bool openOnly) const;
+    // Format the accepted rows in ID order, ranges of the history in parallel
+    std::string formatTransactions(const TransactionSnapshot& snapshot,
+                                   const std::function<bool(const Transaction&)>& keep) const;
+    
+    // State transitions shared by live calls and journal replay. They never
+    // print and take 'now' from the caller, so replaying an event reproduces
+    // exactly the state the live call produced.
+    void applyAddUser(const std::shared_ptr<Person>& user);
+    void applyAddItem(const std::shared_ptr<LibraryItem>& item);
+    void applyAddCopies(const std::string& itemId, int count, time_t now);
+    const Transaction& applyBorrow(const std::string& userId, const std::string& itemId,
+                                   const std::string& transactionId, time_t due,
+                                   double lateFeePerDay, double fineCap, time_t now);
+    double applyReturn(const std::string& userId, const std::string& itemId, time_t now);
+    void applyPlaceHold(const std::string& userId, const std::string& itemId, time_t now);
+    void applyCancelHold(const std::string& userId, const std::string& itemId, time_t now);
+    AccrualSummary applyFineAccrual(time_t now);
+    void applyLedgerCredit(const std::string& userId, double amount, LedgerEntryType type,
+                           const std::string& reference, time_t now);
+    void applyEvent(const LibraryEvent& event);
+    
+    // Journal and recovery. Once a journal write has failed, state and
+    // journal have parted, so every change is refused until recover().
+    void requireWritableJournal() const;
+    void recordEvent(LibraryEvent event,
+                     EventJournal::DurableCallback onDurable = EventJournal::DurableCallback());
+    // Replay throws on the first event that does not apply again
+    size_t replayEvents(const std::vector<LibraryEvent>& events, size_t first);
+    size_t replayCirculation(const std::vector<LibraryEvent>& events, size_t begin, size_t end);
+    struct SnapshotImage;
+    size_t writeSnapshot(const std::string& filename) const;
+    void writeRecords(std::string& buffer, bool changedOnly,
+                      const std::function<void()>& flush) const;
+    void readSnapshot(const std::string& filename);
+    // 'source' names the file (and delta block) in errors
+    void parseRecords(const char* data, size_t size, const std::string& source,
+                      SnapshotImage& image);
+    void materialize(SnapshotImage& image);
+    void resetState();
+    void rebuildStatistics();
+    std::unordered_map<std::string, ItemKind> itemKinds() const; // Item ID -> kind
+    static std::shared_ptr<Person> createUser(const std::vector<std::string>& fields);
+    static std::shared_ptr<LibraryItem> createItem(const std::vector<std::string>& fields);
+    
+    // Shared catalog maintenance (no-ops unless a catalog is published).
+    // A record that does not fit moves the catalog to a larger region;
+    // if even that fails the catalog stops being shared, but the change
+    // itself stands.
+    void shareUser(const std::shared_ptr<Person>& user);
+    void shareItem(const std::shared_ptr<LibraryItem>& item);
+    void writeSharedUser(const std::shared_ptr<Person>& user);
+    void writeSharedItem(const std::shared_ptr<LibraryItem>& item);
+    void fillSharedCatalog();
+    void growSharedCatalog();
+    void syncSharedUser(const std::string& userId);
+    void syncSharedItem(const std::string& itemId);
     
 public:
     // Singleton instance getter
@@ -75,34 +250,167 @@ public:
                     const std::string& publisher, int year, int volume,
                     const std::string& field, const std::string& editor, bool peerReviewed);
     
+    void addCopies(const std::string& itemId, int count);
+    
     void displayAllItems() const;
     void displayAvailableItems() const;
+    // Titles with a free copy, in item ID order
+    std::vector<std::shared_ptr<LibraryItem>> getAvailableItemList() const;
     std::shared_ptr<LibraryItem> getItem(const std::string& itemId);
+    std::shared_ptr<LibraryItem> getItemByIsbn(const std::string& isbn);
     
     // Search functionality
     std::vector<std::shared_ptr<LibraryItem>> searchByTitle(const std::string& title) const;
     std::vector<std::shared_ptr<LibraryItem>> searchByType(const std::string& type) const;
     
+    // Items matching every field set in the query (ISBN, author, genre,
+    // field, category, type), answered from the secondary indexes
+    std::vector<std::shared_ptr<LibraryItem>> findItems(const ItemQuery& query) const;
+    
+    // Ranked keyword search over titles, publishers, authors, editors and
+    // subjects: up to 'limit' items (0 = all) with their BM25 scores, best first
+    std::vector<std::pair<std::shared_ptr<LibraryItem>, double>>
+    searchKeywords(const std::string& query, size_t limit) const;
+    
+    // Up to 'k' items most borrowed in the window ending today, optionally
+    // only of one type and/or book genre (empty for any), most borrowed first
+    std::vector<PopularItem> getPopularItems(PopularityWindow window, const std::string& type,
+                                             const std::string& genre, size_t k) const;
+    
+    // Up to 'n' items most often borrowed by the patrons who borrowed 'itemId'
+    std::vector<Recommendation> getRelatedItems(const std::string& itemId, size_t n) const;
+    void displayRelatedItems(const std::string& itemId, size_t n) const;
+    void displayPopularItems(PopularityWindow window, const std::string& type,
+                             const std::string& genre, size_t k) const;
+    
+    // Up to 'limit' titles or authors starting with 'prefix', most borrowed first
+    std::vector<Completion> suggestTitles(const std::string& prefix, size_t limit) const;
+    std::vector<Completion> suggestAuthors(const std::string& prefix, size_t limit) const;
+    
+    // Range queries over ordered indexes, O(log n + k); bounds are inclusive
+    std::vector<std::shared_ptr<LibraryItem>> getItemsPublishedBetween(int fromYear, int toYear) const;
+    std::vector<Transaction> getLoansDueBetween(time_t from, time_t to) const; // Open loans only
+    std::vector<Transaction> getLoansBorrowedBetween(time_t from, time_t to) const;
+    
+    // Typo-tolerant title search: up to 'limit' items (0 = all) whose title
+    // contains a passage within 'maxDistance' edits of the query, paired
+    // with that distance, closest first
+    std::vector<std::pair<std::shared_ptr<LibraryItem>, int>>
+    searchByTitleFuzzy(const std::string& title, int maxDistance, size_t limit = 0) const;
+    
     // Transaction Management
     void borrowItem(const std::string& userId, const std::string& itemId);
     void returnItem(const std::string& userId, const std::string& itemId);
     
+    struct ReturnSummary {
+        double fine;
+        bool setAsideForHold; // The copy went to the next patron waiting
+    };
+    
+    // Borrow and return without console output. With 'onDurable' the journal
+    // write is group-committed and the callback runs once it is flushed;
+    // without it the write completes before the call returns. A failed
+    // journal write leaves the change applied: the synchronous path throws
+    // NotDurableException and the callback is handed a FileIOException.
+    Transaction checkoutItem(const std::string& userId, const std::string& itemId,
+                             EventJournal::DurableCallback onDurable = EventJournal::DurableCallback());
+    ReturnSummary checkinItem(const std::string& userId, const std::string& itemId,
+                              EventJournal::DurableCallback onDurable = EventJournal::DurableCallback());
+    
+    // Holds / Reservations
+    void placeHold(const std::string& userId, const std::string& itemId);
+    void cancelHold(const std::string& userId, const std::string& itemId);
+    int getHoldPosition(const std::string& userId, const std::string& itemId) const;
+    void displayUserHolds(const std::string& userId) const;
+    void processExpiredHolds();
+    
     void displayUserTransactions(const std::string& userId) const;
     void displayAllTransactions() const;
     
+    // Consistent, immutable view of the transaction history. Cheap to take;
+    // holding it never blocks borrows or returns.
+    std::shared_ptr<const TransactionSnapshot> getTransactionSnapshot() const;
+    
+    // Fines
+    void runFineAccrual();
+    void payFine(const std::string& userId, double amount);
+    void waiveFine(const std::string& userId, double amount, const std::string& reason);
+    double getOutstandingBalance(const std::string& userId) const;
+    void displayUserLedger(const std::string& userId) const;
+    
     // Reports
     void generateOverdueReport() const;
+    void generateDueSoonReport(int hours) const;
     void generateUserActivityReport(const std::string& userId) const;
     
-    // File I/O
+    // File I/O (snapshots)
     void saveToFile(const std::string& filename) const;
     void loadFromFile(const std::string& filename);
     
+    // Durability: restore the latest snapshot plus the journal tail, then keep
+    // journaling every mutation. Returns false if there was nothing to restore.
+    bool recover(const std::string& snapshotFile, const std::string& journalFile);
+    
+    // Write a fresh snapshot or delta, sync it to disk, then start an empty
+    // journal; if anything fails the journal is kept
+    void checkpoint(const std::string& snapshotFile);
+    
+    // Load later snapshots lazily: items decode on first access and at most
+    // 'cacheCapacity' unchanged ones stay decoded (0 = load everything eagerly)
+    void configureLazyCatalog(size_t cacheCapacity);
+    
+    // Take loan terms from 'filename' with the overrides for 'branch' (empty
+    // for none), or the built-in defaults while the file does not exist.
+    // Edits to the file apply from the next checkout on; a file that no
+    // longer compiles leaves the current terms in place.
+    void configureLoanPolicy(const std::string& filename, const std::string& branch);
+    void displayLoanTerms(const std::string& userId);
+    
+    // Capture every borrow, return and search from now on into a workload
+    // trace for LoadDriver to replay, after saving the current state beside
+    // it (TraceRecorder::snapshotFileFor). Start and stop while no calls are
+    // in flight; stopping writes out what is still buffered.
+    void startTraceRecording(const std::string& filename);
+    void stopTraceRecording();
+    
+    // Copy the catalog into a POSIX shared memory region that other
+    // processes can map read-only, and keep it current from now on
+    void publishSharedCatalog(const std::string& regionName, int itemCapacity, int userCapacity);
+    void unpublishSharedCatalog();
+    
+    // Size the worker pool used by scans and batch jobs: 'threadCount'
+    // threads take part in each parallel loop (0 = one per hardware thread)
+    void configureTaskPool(unsigned threadCount);
+    unsigned getTaskPoolSize() const;
+    
+    // Stop the pool's workers; later scans run on the calling thread
+    void shutdownTaskPool();
+    
     // Get statistics
     int getTotalUsers() const { return users.size(); }
     int getTotalItems() const { return items.size(); }
     int getAvailableItems() const;
-    int getTotalTransactions() const { return transactions.size(); }
+    int getAvailableCopies() const;
+    int getTotalTransactions() const { return transactions.getCommittedCount(); }
+    UserStats getUserStats(const std::string& userId) const;
+    ItemStats getItemStats(const std::string& itemId) const;
+    void displayStatistics() const;
+    
+    // Consistency check of the cached counters against a full recount;
+    // returns a description of every mismatch found
+    std::vector<std::string> verifyStatistics() const;
+    
+    // Live heap memory by structure, as charged by MemoryAccounting, with
+    // the number of records each structure holds (0 where none applies).
+    // Empty when the build has no memory accounting.
+    struct MemoryFootprint {
+        std::string structure;
+        long long bytes;
+        long long allocations;
+        unsigned long long objects;
+    };
+    std::vector<MemoryFootprint> getMemoryFootprint() const;
+    void displayMemoryFootprint() const;
     
     // Destructor
     ~Library();
@@ -0,0 +1,93 @@
+#ifndef LIBRARYEVENT_H
+#define LIBRARYEVENT_H
+
+#include <string>
+#include <vector>
+#include <ctime>
+#include "RecordWriter.h"
+
+/**
+ * Every kind of Library state change.
+ *
+ * Payload fields per type:
+ *   UserRegistered  the user's serialize() record (STUDENT|..., FACULTY|..., LIBRARIAN|...)
+ *   ItemAdded       the item's serialize() record (BOOK|..., MAGAZINE|..., JOURNAL|...)
+ *   CopiesAdded     itemId, count
+ *   ItemBorrowed    userId, itemId, transactionId, dueDate, lateFeePerDay, fineCap
+ *                   (older journals stop at dueDate)
+ *   ItemReturned    userId, itemId (older journals add a lateFeePerDay, now unused)
+ *   HoldPlaced      userId, itemId
+ *   HoldCancelled   userId, itemId
+ *   FinesAccrued    (none, the accrual runs at the event timestamp)
+ *   FinePaid        userId, amount
+ *   FineWaived      userId, amount, reason
+ */
+enum class EventType {
+    UserRegistered,
+    ItemAdded,
+    CopiesAdded,
+    ItemBorrowed,
+    ItemReturned,
+    HoldPlaced,
+    HoldCancelled,
+    FinesAccrued,
+    FinePaid,
+    FineWaived
+};
+
+/**
+ * LibraryEvent class - one journaled mutation of Library state
+ * Demonstrates: Event sourcing, Factory methods
+ */
+class LibraryEvent {
+private:
+    EventType type;
+    unsigned long long sequence; // Position in the journal, assigned on append
+    time_t timestamp;            // Replay applies the event "as of" this time
+    std::vector<std::string> fields;
+
+public:
+    // Constructor
+    LibraryEvent(EventType t, time_t ts, const std::vector<std::string>& f);
+
+    // Factories
+    static LibraryEvent userRegistered(const std::string& userRecord, time_t now);
+    static LibraryEvent itemAdded(const std::string& itemRecord, time_t now);
+    static LibraryEvent copiesAdded(const std::string& itemId, int count, time_t now);
+    static LibraryEvent itemBorrowed(const std::string& userId, const std::string& itemId,
+                                     const std::string& transactionId, time_t dueDate,
+                                     double lateFeePerDay, double fineCap, time_t now);
+    static LibraryEvent itemReturned(const std::string& userId, const std::string& itemId,
+                                     time_t now);
+    static LibraryEvent holdPlaced(const std::string& userId, const std::string& itemId, time_t now);
+    static LibraryEvent holdCancelled(const std::string& userId, const std::string& itemId, time_t now);
+    static LibraryEvent finesAccrued(time_t now);
+    static LibraryEvent finePaid(const std::string& userId, double amount, time_t now);
+    static LibraryEvent fineWaived(const std::string& userId, double amount,
+                                   const std::string& reason, time_t now);
+
+    // Getters
+    EventType getType() const { return type; }
+    unsigned long long getSequence() const { return sequence; }
+    time_t getTimestamp() const { return timestamp; }
+    const std::vector<std::string>& getFields() const { return fields; }
+    const std::string& field(size_t index) const;
+
+    void setSequence(unsigned long long seq) { sequence = seq; }
+
+    // Circulation events touch a single item and can be replayed in
+    // parallel with events for other items
+    bool isCirculation() const;
+    const std::string& getItemKey() const;
+
+    // Serialization: sequence|timestamp|TYPE|field|field...
+    void writeTo(RecordWriter& out) const;
+    std::string serialize() const;
+    static LibraryEvent parse(const std::string& line);
+
+    static std::string typeToString(EventType type);
+    // Fields of a RecordWriter record, unescaped
+    static std::vector<std::string> splitRecord(const std::string& record);
+};
+
+#endif // LIBRARYEVENT_H
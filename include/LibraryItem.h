@@ -3,6 +3,12 @@
 
 #include <string>
 #include <iostream>
+#include "Holdings.h"
+#include "RecordWriter.h"
+
+// Item kinds, in the order loan policy tables are indexed by
+enum class ItemKind { Book, Magazine, Journal };
+const int ITEM_KIND_COUNT = 3;
 
 /**
  * Abstract base class for all library items
@@ -14,12 +20,16 @@ protected:
     std::string title;
     std::string publisher;
     int publicationYear;
-    bool isAvailable;
-    std::string currentBorrower; // userId of current borrower
+    ItemKind itemKind;
+    Holdings holdings; // Physical copies sharing this bibliographic record
+    
+    // Shared status lines for displayInfo() overrides
+    void displayAvailability() const;
     
 public:
     // Constructor
-    LibraryItem(const std::string& id, const std::string& t, const std::string& pub, int year);
+    LibraryItem(const std::string& id, const std::string& t, const std::string& pub, int year,
+                ItemKind kind);
     
     // Virtual destructor
     virtual ~LibraryItem();
@@ -27,25 +37,36 @@ public:
     // Pure virtual functions
     virtual void displayInfo() const = 0;
     virtual std::string getItemType() const = 0;
-    virtual double getLateFeePerDay() const = 0;
     
     // Concrete methods
-    void borrowItem(const std::string& userId);
-    void returnItem();
+    std::string borrowItem(const std::string& userId); // Returns the barcode of the copy lent
+    void returnItem(const std::string& barcode);
+    void addCopies(int count);
+    
+    // Hold shelf (returns "" when no copy is free)
+    std::string reserveCopy(const std::string& userId);
+    void lendReservedCopy(const std::string& barcode, const std::string& userId);
+    void releaseReservedCopy(const std::string& barcode);
+    
+    // Snapshot restore: mark a copy as lent or held for a user
+    void restoreCopy(const std::string& barcode, CopyState state, const std::string& userId);
     
     // Getters
     std::string getItemId() const { return itemId; }
     std::string getTitle() const { return title; }
     std::string getPublisher() const { return publisher; }
     int getPublicationYear() const { return publicationYear; }
-    bool getAvailability() const { return isAvailable; }
-    std::string getCurrentBorrower() const { return currentBorrower; }
-    
-    // Setters
-    void setAvailability(bool avail) { isAvailable = avail; }
+    ItemKind getItemKind() const { return itemKind; }
+    bool getAvailability() const { return holdings.getAvailableCopies() > 0; }
+    std::string getCurrentBorrower() const;
+    int getTotalCopies() const { return holdings.getTotalCopies(); }
+    int getAvailableCopies() const { return holdings.getAvailableCopies(); }
+    const Holdings& getHoldings() const { return holdings; }
     
-    // Serialization
-    virtual std::string serialize() const;
+    // Serialization: writeTo() appends this item's fields to the current
+    // record; serialize() returns them as one record
+    virtual void writeTo(RecordWriter& out) const;
+    std::string serialize() const;
 };
 
 #endif // LIBRARYITEM_H
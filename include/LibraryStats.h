@@ -0,0 +1,74 @@
+#ifndef LIBRARYSTATS_H
+#define LIBRARYSTATS_H
+
+#include <string>
+#include <atomic>
+#include <ctime>
+#include <mutex>
+#include <unordered_map>
+#include "LibraryItem.h"
+
+/**
+ * Per-user counters
+ */
+struct UserStats {
+    int totalBorrowed;
+    int currentlyBorrowed;
+    int borrowedByKind[ITEM_KIND_COUNT]; // currentlyBorrowed split by ItemKind
+    double totalFines; // Fines assessed on returned items
+
+    UserStats() : totalBorrowed(0), currentlyBorrowed(0), borrowedByKind(), totalFines(0.0) {}
+
+    int borrowedOf(ItemKind kind) const { return borrowedByKind[static_cast<int>(kind)]; }
+};
+
+/**
+ * Per-item counters
+ */
+struct ItemStats {
+    int borrowCount;
+    time_t lastBorrowed; // 0 if never borrowed
+
+    ItemStats() : borrowCount(0), lastBorrowed(0) {}
+};
+
+/**
+ * LibraryStats class - counters maintained incrementally on every mutation
+ * Demonstrates: Materialized aggregates, Atomic counters
+ *
+ * Library-wide totals are atomics so dashboards can poll them without
+ * touching the item or transaction stores. The per-user and per-item
+ * maps are guarded by a mutex for parallel journal replay.
+ */
+class LibraryStats {
+private:
+    std::unordered_map<std::string, UserStats> userStats;
+    std::unordered_map<std::string, ItemStats> itemStats;
+    mutable std::mutex mutex;
+
+    std::atomic<int> availableItems;  // Titles with at least one free copy
+    std::atomic<int> availableCopies; // Free copies across all titles
+    std::atomic<int> activeLoans;
+
+public:
+    // Constructor
+    LibraryStats();
+
+    // Mutation hooks
+    void onUserRegistered(const std::string& userId);
+    void onItemAdded(const std::string& itemId);
+    void onBorrow(const std::string& userId, const std::string& itemId, ItemKind kind,
+                  time_t when);
+    void onReturn(const std::string& userId, ItemKind kind, double fine);
+    void onAvailabilityChange(int copiesBefore, int copiesAfter);
+    void clear();
+
+    // Queries
+    UserStats getUserStats(const std::string& userId) const;
+    ItemStats getItemStats(const std::string& itemId) const;
+    int getAvailableItems() const { return availableItems.load(std::memory_order_relaxed); }
+    int getAvailableCopies() const { return availableCopies.load(std::memory_order_relaxed); }
+    int getActiveLoans() const { return activeLoans.load(std::memory_order_relaxed); }
+};
+
+#endif // LIBRARYSTATS_H
@@ -0,0 +1,66 @@
+#ifndef LOADDRIVER_H
+#define LOADDRIVER_H
+
+#include <string>
+#include <vector>
+#include <map>
+#include <ostream>
+#include "Library.h"
+#include "WorkloadTrace.h"
+
+// Latency distribution of one kind of operation, in microseconds
+struct LatencySummary {
+    std::string name;
+    unsigned long long count;
+    unsigned long long failed;
+    double p50;
+    double p90;
+    double p99;
+    double p999;
+    double max;
+};
+
+// Outcome of replaying a trace
+struct LoadReport {
+    unsigned long long operations;
+    unsigned long long failed;
+    unsigned threads;
+    double speedup;                                   // 0: as fast as possible
+    double seconds;                                   // Wall time of the replay
+    double maxLagMillis;                              // Furthest behind the schedule
+    std::vector<LatencySummary> latencies;            // Per operation, then "ALL"
+    std::map<std::string, unsigned long long> errors; // Failures by error code
+
+    double throughput() const { return seconds > 0 ? operations / seconds : 0; }
+    void print(std::ostream& out) const;
+};
+
+/**
+ * LoadDriver class - replays a workload trace against the Library
+ * Demonstrates: Open-loop load generation, Latency percentiles
+ *
+ * Operations are spread over 'concurrency' threads. All operations of
+ * one user go to the same thread, in trace order, so each user's borrows
+ * and returns happen in the order they were recorded; searches are dealt
+ * out in turn. With a speed-up of S an operation is issued S times
+ * sooner after the start than it was recorded; 0 issues each one as
+ * soon as its thread is free.
+ *
+ * When paced, latency is measured from the time an operation was due,
+ * not from when a busy thread got round to it, so a slow call also
+ * counts against the calls queued behind it. Failures are counted by
+ * the codes batch mode reports (ALREADY_BORROWED, LIMIT_EXCEEDED, ...).
+ */
+class LoadDriver {
+private:
+    Library& library;
+
+    void execute(const TraceEntry& entry);
+
+public:
+    explicit LoadDriver(Library& lib);
+
+    LoadReport replay(const std::vector<TraceEntry>& trace, double speedup, unsigned concurrency);
+};
+
+#endif // LOADDRIVER_H
@@ -0,0 +1,73 @@
+#ifndef LOANPOLICY_H
+#define LOANPOLICY_H
+
+#include <string>
+#include <vector>
+#include "Person.h"
+#include "LibraryItem.h"
+
+// Terms of one loan; a fine cap of 0 leaves fines uncapped
+struct LoanRule {
+    int maxLoans;         // Loans of this kind the patron may already hold when borrowing
+    int loanDays;
+    double lateFeePerDay;
+    double fineCap;       // Most one loan is fined in total
+};
+
+/**
+ * LoanPolicy class - loan terms by patron role and item kind
+ * Demonstrates: Table-driven rules, Configuration files
+ *
+ * Rules are compiled into a dense role x kind table, so a checkout finds
+ * its terms with one index computation. A checkout must stay within two
+ * limits: maxLoans, counted over the patron's loans of that kind, and the
+ * role's total, counted over loans of every kind. By default each kind
+ * may use the whole total. A policy file refines the built-in defaults,
+ * one rule per line:
+ *
+ *   RULE|role|kind|maxLoans|loanDays|lateFeePerDay|fineCap
+ *   LIMIT|role|maxTotalLoans
+ *   BRANCH|branch|role|kind|maxLoans|loanDays|lateFeePerDay|fineCap
+ *   BRANCH_LIMIT|branch|role|maxTotalLoans
+ *
+ * '*' matches every role or kind, and an empty field keeps the value set
+ * before it. Branch lines apply only to the named branch, after all
+ * others. Blank lines and lines starting with '#' are ignored.
+ */
+class LoanPolicy {
+public:
+    static const int ROLES = 3;
+    static const int KINDS = 3;
+
+private:
+    LoanRule rules[ROLES * KINDS];
+    int maxTotalLoans[ROLES]; // Open loans of any kind a role may hold
+    std::string source; // File the rules were read from, empty for the defaults
+    std::string branch;
+
+    void apply(const std::vector<std::string>& fields, size_t first, int lineNumber);
+    void applyLimit(const std::vector<std::string>& fields, size_t first, int lineNumber);
+    bool matchRoles(const std::string& roleField, bool roles[ROLES]) const;
+
+public:
+    // Built-in defaults
+    LoanPolicy();
+
+    // Defaults refined by 'filename' for 'branch' (empty: no branch);
+    // throws FileIOException or InvalidOperationException naming the line
+    static LoanPolicy compile(const std::string& filename, const std::string& branch);
+
+    const LoanRule& getRule(PatronRole role, ItemKind kind) const {
+        return rules[static_cast<int>(role) * KINDS + static_cast<int>(kind)];
+    }
+
+    int getMaxTotalLoans(PatronRole role) const { return maxTotalLoans[static_cast<int>(role)]; }
+
+    const std::string& getSource() const { return source; }
+    const std::string& getBranch() const { return branch; }
+
+    static const char* roleName(PatronRole role);
+    static const char* kindName(ItemKind kind);
+};
+
+#endif // LOANPOLICY_H
@@ -21,7 +21,6 @@ public:
     // Override virtual functions
     void displayInfo() const override;
     std::string getItemType() const override;
-    double getLateFeePerDay() const override;
     
     // Magazine-specific getters
     int getIssueNumber() const { return issueNumber; }
@@ -29,7 +28,7 @@ public:
     std::string getCategory() const { return category; }
     
     // Serialization
-    std::string serialize() const override;
+    void writeTo(RecordWriter& out) const override;
     
     // Destructor
     ~Magazine();
@@ -0,0 +1,32 @@
+#ifndef MAPPEDFILE_H
+#define MAPPEDFILE_H
+
+#include <string>
+#include <cstddef>
+
+/**
+ * MappedFile class - read-only memory mapping of a whole file
+ * Demonstrates: RAII, Memory-mapped I/O
+ *
+ * Pages are read in by the kernel on first touch, so opening a large
+ * file costs nothing until its bytes are used. The mapping stays valid
+ * after the file is renamed over or unlinked.
+ */
+class MappedFile {
+private:
+    const char* data;
+    size_t size;
+
+public:
+    // Map 'filename'; throws FileIOException if it cannot be opened
+    explicit MappedFile(const std::string& filename);
+    ~MappedFile();
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    const char* getData() const { return data; }
+    size_t getSize() const { return size; }
+};
+
+#endif // MAPPEDFILE_H
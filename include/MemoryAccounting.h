@@ -0,0 +1,74 @@
+#ifndef MEMORYACCOUNTING_H
+#define MEMORYACCOUNTING_H
+
+#include <vector>
+
+// Subsystem charged for the heap memory allocated while it is current
+enum class MemoryTag : unsigned char {
+    Untagged,     // Anything allocated outside a MemoryScope
+    Users,        // Person objects, their strings and the users map
+    Items,        // LibraryItem objects, copies and the item store
+    Transactions, // Transaction log, open loans and loan indexes
+    Holds,
+    Fines,        // Fine ledger
+    Indexes,      // Title, catalog, full-text, autocomplete and year indexes
+    Caches,       // Query cache results
+    Journal,      // Events on their way to the journal
+    Snapshot      // Buffers used while saving or loading snapshots
+};
+
+// Heap memory still held under one tag
+struct MemoryUsage {
+    MemoryTag tag;
+    long long liveBytes;                  // Bytes requested and not yet freed
+    long long liveAllocations;
+    unsigned long long totalAllocations;  // Every allocation made, freed or not
+};
+
+/**
+ * MemoryScope class - charges this thread's allocations to a tag
+ * Demonstrates: RAII, Thread-local state
+ *
+ * While a scope is alive, every operator new on its thread is charged
+ * to its tag; the innermost scope wins, and the previous tag returns
+ * when the scope ends. Memory is credited back to the tag it was
+ * charged to when freed, on whatever thread frees it, so a string
+ * created while loading an item stays an Items cost after it is moved
+ * elsewhere.
+ */
+class MemoryScope {
+private:
+    MemoryTag previous;
+
+public:
+    explicit MemoryScope(MemoryTag tag);
+    ~MemoryScope();
+
+    MemoryScope(const MemoryScope&) = delete;
+    MemoryScope& operator=(const MemoryScope&) = delete;
+};
+
+/**
+ * MemoryAccounting class - live heap usage by tag
+ * Demonstrates: Replacing global operator new, Relaxed atomic counters
+ *
+ * Built with LIBRARY_MEMORY_ACCOUNTING, global operator new and delete
+ * are replaced by versions that put a 16-byte header (requested size and
+ * tag) in front of each block and keep per-tag counters, one cache line
+ * per tag. The header keeps blocks aligned as operator new promises. Without the flag no
+ * operator is replaced, scopes do nothing and usage() is empty.
+ * Memory from malloc or mmap (stdio buffers, mapped snapshots) is not
+ * seen.
+ */
+class MemoryAccounting {
+public:
+    static const int TAG_COUNT = static_cast<int>(MemoryTag::Snapshot) + 1;
+
+    static bool isEnabled();
+    static const char* tagName(MemoryTag tag);
+
+    // Current usage of every tag, in tag order; empty when disabled
+    static std::vector<MemoryUsage> usage();
+};
+
+#endif // MEMORYACCOUNTING_H
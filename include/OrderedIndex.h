@@ -0,0 +1,147 @@
+#ifndef ORDEREDINDEX_H
+#define ORDEREDINDEX_H
+
+#include <vector>
+#include <set>
+#include <utility>
+#include <algorithm>
+#include <iterator>
+#include <mutex>
+#include <shared_mutex>
+
+/**
+ * OrderedIndex class - ordered (key, value) index for range queries
+ * Demonstrates: Templates, Sorted arrays with a delta buffer
+ *
+ * Entries live in one sorted array, which is scanned with binary search
+ * and sequential reads. Inserts go to a small ordered delta buffer, and
+ * erases of array entries are recorded as tombstones; once the buffer
+ * and tombstones reach a quarter of the array they are merged into it
+ * in one pass. Merging geometrically keeps inserts amortized O(log n),
+ * and a range query costs O(log n + k) for k entries returned.
+ *
+ * Several (key, value) pairs may share a key; a pair is stored once.
+ * Value() must order before every other value. All operations are safe
+ * to call from several threads.
+ */
+template <typename Key, typename Value>
+class OrderedIndex {
+public:
+    typedef std::pair<Key, Value> Entry;
+
+private:
+    static const size_t MIN_MERGE = 1024;
+
+    std::vector<Entry> sorted;
+    std::set<Entry> delta;      // Inserted since the last merge
+    std::set<Entry> tombstones; // Erased from 'sorted' since the last merge
+    mutable std::shared_timed_mutex indexMutex;
+
+    bool inSorted(const Entry& entry) const {
+        return std::binary_search(sorted.begin(), sorted.end(), entry);
+    }
+
+    void mergeIfFull() {
+        if (delta.size() + tombstones.size() < std::max(MIN_MERGE, sorted.size() / 4)) {
+            return;
+        }
+
+        std::vector<Entry> merged;
+        merged.reserve(sorted.size() + delta.size() - tombstones.size());
+        auto extra = delta.begin();
+        auto gone = tombstones.begin();
+        for (const Entry& entry : sorted) {
+            while (extra != delta.end() && *extra < entry) {
+                merged.push_back(*extra++);
+            }
+            while (gone != tombstones.end() && *gone < entry) {
+                ++gone;
+            }
+            if (gone != tombstones.end() && *gone == entry) {
+                continue;
+            }
+            merged.push_back(entry);
+        }
+        merged.insert(merged.end(), extra, delta.end());
+
+        sorted.swap(merged);
+        delta.clear();
+        tombstones.clear();
+    }
+
+public:
+    void insert(const Key& key, const Value& value) {
+        std::unique_lock<std::shared_timed_mutex> lock(indexMutex);
+        Entry entry(key, value);
+        if (tombstones.erase(entry) > 0 || inSorted(entry)) {
+            return; // Revived, or already present
+        }
+        delta.insert(entry);
+        mergeIfFull();
+    }
+
+    void erase(const Key& key, const Value& value) {
+        std::unique_lock<std::shared_timed_mutex> lock(indexMutex);
+        Entry entry(key, value);
+        if (delta.erase(entry) > 0) {
+            return;
+        }
+        if (inSorted(entry)) {
+            tombstones.insert(entry);
+            mergeIfFull();
+        }
+    }
+
+    void clear() {
+        std::unique_lock<std::shared_timed_mutex> lock(indexMutex);
+        sorted.clear();
+        delta.clear();
+        tombstones.clear();
+    }
+
+    size_t size() const {
+        std::shared_lock<std::shared_timed_mutex> lock(indexMutex);
+        return sorted.size() + delta.size() - tombstones.size();
+    }
+
+    // Values of every entry with from <= key <= to, in (key, value) order
+    std::vector<Value> range(const Key& from, const Key& to) const {
+        std::shared_lock<std::shared_timed_mutex> lock(indexMutex);
+        std::vector<Value> values;
+        if (to < from) {
+            return values;
+        }
+
+        auto below = [](const Entry& entry, const Key& key) { return entry.first < key; };
+        auto it = std::lower_bound(sorted.begin(), sorted.end(), from, below);
+        auto extra = delta.lower_bound(Entry(from, Value()));
+        auto gone = tombstones.lower_bound(Entry(from, Value()));
+
+        // Merge the array and the delta buffer, dropping tombstoned entries
+        while (true) {
+            bool haveSorted = it != sorted.end() && !(to < it->first);
+            bool haveExtra = extra != delta.end() && !(to < extra->first);
+            if (!haveSorted && !haveExtra) {
+                break;
+            }
+            if (haveExtra && (!haveSorted || *extra < *it)) {
+                values.push_back(extra->second);
+                ++extra;
+                continue;
+            }
+            while (gone != tombstones.end() && *gone < *it) {
+                ++gone;
+            }
+            if (gone == tombstones.end() || !(*gone == *it)) {
+                values.push_back(it->second);
+            }
+            ++it;
+        }
+        return values;
+    }
+};
+
+template <typename Key, typename Value>
+const size_t OrderedIndex<Key, Value>::MIN_MERGE;
+
+#endif // ORDEREDINDEX_H
@@ -3,6 +3,10 @@
 
 #include <string>
 #include <iostream>
+#include "RecordWriter.h"
+
+// Patron roles, in the order loan policy tables are indexed by
+enum class PatronRole { Student, Faculty, Librarian };
 
 /**
  * Abstract base class for all persons in the library system
@@ -15,11 +19,12 @@ protected:
     std::string email;
     std::string password;
     int age;
+    PatronRole patronRole;
 
 public:
     // Constructor
     Person(const std::string& id, const std::string& n, const std::string& e, 
-           const std::string& pwd, int a);
+           const std::string& pwd, int a, PatronRole role);
     
     // Virtual destructor (important for polymorphism)
     virtual ~Person();
@@ -27,8 +32,6 @@ public:
     // Pure virtual functions (Abstract methods)
     virtual void displayInfo() const = 0;
     virtual std::string getRole() const = 0;
-    virtual int getMaxBorrowLimit() const = 0;
-    virtual int getBorrowDuration() const = 0;
     
     // Concrete methods
     bool authenticate(const std::string& pwd) const;
@@ -38,13 +41,16 @@ public:
     std::string getName() const { return name; }
     std::string getEmail() const { return email; }
     int getAge() const { return age; }
+    PatronRole getPatronRole() const { return patronRole; }
     
     // Setters
     void setEmail(const std::string& e) { email = e; }
     void setPassword(const std::string& pwd) { password = pwd; }
     
-    // Serialization for file I/O
-    virtual std::string serialize() const;
+    // Serialization for file I/O: writeTo() appends this user's fields to
+    // the current record; serialize() returns them as one record
+    virtual void writeTo(RecordWriter& out) const;
+    std::string serialize() const;
 };
 
 #endif // PERSON_H
@@ -0,0 +1,101 @@
+#ifndef POPULARITYTRACKER_H
+#define POPULARITYTRACKER_H
+
+#include <string>
+#include <vector>
+#include <unordered_map>
+#include <mutex>
+#include <ctime>
+
+// Periods a popularity query can cover, ending today
+enum class PopularityWindow { Day, Week, Month };
+
+// An item among the most borrowed, with its estimated borrows in the window
+struct PopularItem {
+    std::string itemId;
+    unsigned long long borrows;
+    unsigned long long error;   // 'borrows' is at most this much too high
+};
+
+/**
+ * PopularityTracker class - most borrowed items by day, week and month
+ * Demonstrates: Space-Saving heavy hitters, Time-bucketed windows
+ *
+ * Borrows are counted in one bucket per UTC day, keeping the last
+ * MONTH_DAYS days in a ring. A bucket holds a Space-Saving summary of
+ * at most 'capacity' counters for all items, one per item type and
+ * one per book genre. A new item seen by a full summary takes over
+ * the smallest counter, inheriting its count as error. So memory is
+ * fixed by the capacity and the number of types and genres, however
+ * long the history grows. Any item borrowed more than 1/capacity of
+ * a bucket's borrows is always counted.
+ *
+ * A query merges the summaries of the days in its window and ranks
+ * the merged counts. Borrows on days where an item fell out of the
+ * summary are missed. With a capacity well above the K asked for,
+ * the leaders are exact in practice.
+ */
+class PopularityTracker {
+public:
+    static const int MONTH_DAYS = 30;
+
+private:
+    // Space-Saving summary: a min-heap of counters by count
+    class Summary {
+    private:
+        struct Counter {
+            std::string itemId;
+            unsigned long long count;
+            unsigned long long error;
+        };
+        std::vector<Counter> heap;
+        std::unordered_map<std::string, size_t> positions; // itemId -> heap index
+
+        void siftDown(size_t index);
+
+    public:
+        void offer(const std::string& itemId, size_t capacity);
+
+        template <typename Visitor>
+        void forEach(Visitor visit) const {
+            for (const Counter& counter : heap) {
+                visit(counter.itemId, counter.count, counter.error);
+            }
+        }
+        size_t size() const { return heap.size(); }
+    };
+
+    struct DayBucket {
+        long long day;                                     // Days since the epoch, -1 if unused
+        std::unordered_map<std::string, Summary> segments; // "" for all items, else type or genre
+
+        DayBucket() : day(-1) {}
+    };
+
+    DayBucket buckets[MONTH_DAYS];
+    size_t capacity;
+    mutable std::mutex mutex;
+
+    static std::string typeSegment(const std::string& type);
+    static std::string genreSegment(const std::string& genre);
+
+public:
+    explicit PopularityTracker(size_t countersPerSummary);
+
+    // Count a borrow made at 'when' (genre empty for items that are not books)
+    void record(const std::string& itemId, const std::string& type, const std::string& genre,
+                time_t when);
+
+    // Up to 'k' items most borrowed during the window ending on the day of
+    // 'now', optionally limited to a type, a book genre or both
+    std::vector<PopularItem> top(PopularityWindow window, const std::string& type,
+                                 const std::string& genre, size_t k, time_t now) const;
+
+    size_t getCounterCount() const;
+    void clear();
+
+    static int windowDays(PopularityWindow window);
+    static const char* windowName(PopularityWindow window);
+};
+
+#endif // POPULARITYTRACKER_H
@@ -0,0 +1,80 @@
+#ifndef QUERYCACHE_H
+#define QUERYCACHE_H
+
+#include <string>
+#include <vector>
+#include <list>
+#include <memory>
+#include <atomic>
+#include <mutex>
+#include <cstdint>
+#include <unordered_map>
+#include "LibraryItem.h"
+
+/**
+ * QueryCache class - memoized item lists with generation-based invalidation
+ * Demonstrates: Generation counters, LRU eviction
+ *
+ * The catalog is split into partitions, one per item kind for catalog
+ * membership and one per kind for availability. Each partition has a
+ * generation counter that mutations bump. A cached result records the
+ * partitions it was computed from and their generations, read before
+ * the computation started, and is served only while all of them are
+ * unchanged; a mutation racing with the computation therefore leaves
+ * the result stale rather than wrong.
+ *
+ * At most CAPACITY results are kept, evicting the least recently used.
+ */
+class QueryCache {
+public:
+    typedef std::vector<std::shared_ptr<LibraryItem>> Result;
+    typedef uint32_t Partitions; // One bit per partition
+
+    static const size_t KINDS = 3; // Book, Magazine, Journal
+    static const size_t CAPACITY = 1024;
+
+    // Generations a result was computed against
+    struct Stamp {
+        Partitions partitions;
+        uint64_t generations[2 * KINDS];
+    };
+
+private:
+    struct Entry {
+        Stamp stamp;
+        Result result;
+        std::list<std::string>::iterator recency;
+    };
+
+    std::atomic<uint64_t> generations[2 * KINDS];
+    std::unordered_map<std::string, Entry> entries;
+    std::list<std::string> recency; // Most recently used first
+    std::mutex mutex;
+
+    std::atomic<unsigned long long> hits;
+    std::atomic<unsigned long long> lookups;
+
+    bool isCurrent(const Stamp& stamp) const;
+
+public:
+    QueryCache();
+
+    // Partition of an item kind ("Book", "magazine", ...); unknown kinds
+    // map to every kind
+    static Partitions catalogOf(const std::string& itemType);
+    static Partitions availabilityOf(const std::string& itemType);
+    static const Partitions ALL_CATALOG = (1u << KINDS) - 1;
+    static const Partitions ALL_AVAILABILITY = ALL_CATALOG << KINDS;
+
+    void invalidate(Partitions partitions);
+    void clear();
+
+    bool lookup(const std::string& key, Result& result);
+    Stamp stamp(Partitions partitions) const;
+    void store(const std::string& key, const Stamp& stamp, const Result& result);
+
+    unsigned long long getHits() const { return hits.load(std::memory_order_relaxed); }
+    unsigned long long getLookups() const { return lookups.load(std::memory_order_relaxed); }
+};
+
+#endif // QUERYCACHE_H
@@ -0,0 +1,50 @@
+#ifndef RECORDWRITER_H
+#define RECORDWRITER_H
+
+#include <string>
+
+/**
+ * RecordWriter class - builds '|'-separated records in a caller's buffer
+ * Demonstrates: Append-only serialization, Hand-rolled number formatting
+ *
+ * Each field is appended straight onto the buffer, preceded by '|'
+ * unless it starts a record. A backslash, '|', newline or carriage
+ * return inside text is written as "\\", "\|", "\n" or "\r", and
+ * LibraryEvent::splitRecord undoes the escaping, so any text survives a
+ * snapshot or journal round trip.
+ *
+ * Integers are formatted digit by digit. A double that is a whole number
+ * of cents, as fines are, is written with at most two decimals; anything
+ * else gets 17 significant digits. Either form reads back through std::stod
+ * as the same value. Nothing is allocated apart from the buffer's own
+ * growth, so reusing one buffer for many records allocates nothing once
+ * it has grown.
+ */
+class RecordWriter {
+private:
+    std::string& buffer;
+    bool atRecordStart;
+
+    void separate();
+    void appendUnsigned(unsigned long long value);
+    void appendSigned(long long value);
+
+public:
+    explicit RecordWriter(std::string& buffer);
+
+    RecordWriter& field(const std::string& text);
+    RecordWriter& field(const char* text);
+    RecordWriter& field(bool value); // "1" or "0"
+    RecordWriter& field(int value);
+    RecordWriter& field(long value);
+    RecordWriter& field(long long value);
+    RecordWriter& field(unsigned value);
+    RecordWriter& field(unsigned long value);
+    RecordWriter& field(unsigned long long value);
+    RecordWriter& field(double value);
+
+    // Terminate the record with '\n'; the next field starts a new record
+    void endRecord();
+};
+
+#endif // RECORDWRITER_H
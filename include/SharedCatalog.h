@@ -0,0 +1,182 @@
+#ifndef SHAREDCATALOG_H
+#define SHAREDCATALOG_H
+
+#include <string>
+#include <vector>
+#include <memory>
+#include <atomic>
+#include <cstdint>
+#include <cstddef>
+
+/**
+ * Read-only view of one catalog item, copied out of shared memory
+ */
+struct CatalogItem {
+    std::string itemId;
+    std::string title;
+    std::string publisher;
+    std::string itemType;
+    int publicationYear;
+    int totalCopies;
+    int availableCopies;
+    double lateFeePerDay;
+};
+
+/**
+ * Read-only view of one user, copied out of shared memory.
+ * Credentials are never placed in the shared region.
+ */
+struct CatalogUser {
+    std::string userId;
+    std::string name;
+    std::string email;
+    std::string role;
+    int maxBorrowLimit;
+    int borrowDuration;
+    int currentlyBorrowed;
+};
+
+/**
+ * SharedCatalog class - item and user store in a POSIX shared memory region
+ * Demonstrates: Shared memory IPC, Offset-based layout, Lock-free publication
+ *
+ * The region holds no pointers: records and the string pool are addressed by
+ * byte offsets from the start of the mapping, so every process may map it at
+ * a different address. One owner process writes; any number of readers map
+ * the region PROT_READ and share its physical pages.
+ *
+ * Strings are written once and never modified. A new record is filled in
+ * completely before its count is published with a release store, and the
+ * mutable counters are atomics, so readers never take a lock.
+ *
+ * A region is created empty and filled before the owner marks it ready;
+ * attach() waits for that, so a reader never sees a half-filled catalog.
+ * A region never grows in place. When it is full the owner publishes a
+ * larger one under the same name and retires the old one; readers notice
+ * with isRetired() and attach again. An owner that goes away without a
+ * replacement, or fails to build one, retires its region too, so readers
+ * always learn that their view has stopped changing.
+ */
+class SharedCatalog {
+public:
+    // Layout shared between processes; only fixed-size, address-free types
+    struct StringRef {
+        uint64_t offset; // From the start of the region
+        uint32_t length;
+    };
+
+    struct ItemRecord {
+        StringRef itemId;
+        StringRef title;
+        StringRef publisher;
+        StringRef itemType;
+        int32_t publicationYear;
+        std::atomic<int32_t> totalCopies;
+        std::atomic<int32_t> availableCopies;
+        double lateFeePerDay;
+    };
+
+    struct UserRecord {
+        StringRef userId;
+        StringRef name;
+        StringRef email;
+        StringRef role;
+        int32_t maxBorrowLimit;
+        int32_t borrowDuration;
+        std::atomic<int32_t> currentlyBorrowed;
+    };
+
+    struct Header {
+        uint32_t magic;
+        uint32_t version;
+        uint32_t itemCapacity;
+        uint32_t userCapacity;
+        uint32_t itemSlots;  // Hash index sizes, powers of two
+        uint32_t userSlots;
+        uint64_t itemsOffset;
+        uint64_t usersOffset;
+        uint64_t itemIndexOffset;
+        uint64_t userIndexOffset;
+        uint64_t poolOffset;
+        uint64_t poolCapacity;
+        std::atomic<uint32_t> itemCount;
+        std::atomic<uint32_t> userCount;
+        std::atomic<uint64_t> poolUsed;
+        std::atomic<uint32_t> retired; // Set once the region stops receiving updates
+        std::atomic<uint32_t> ready;   // Set once the owner has filled the region
+    };
+
+private:
+    std::string name;
+    bool owner;
+    void* base;
+    size_t mappedSize;
+
+    SharedCatalog(const std::string& regionName, bool isOwner, void* mapping, size_t size);
+
+    Header* header() const { return static_cast<Header*>(base); }
+    ItemRecord* itemAt(uint32_t index) const;
+    UserRecord* userAt(uint32_t index) const;
+    std::atomic<uint32_t>* itemIndex() const;
+    std::atomic<uint32_t>* userIndex() const;
+
+    StringRef storeString(const std::string& value);
+    std::string loadString(const StringRef& ref) const;
+    void requireOwner() const;
+
+    // Hash index probes; slots hold record index + 1, 0 means empty
+    int findItemIndex(const std::string& itemId) const;
+    int findUserIndex(const std::string& userId) const;
+    CatalogItem copyItem(const ItemRecord& record) const;
+    CatalogUser copyUser(const UserRecord& record) const;
+
+public:
+    // Create (replacing any stale region of the same name) as the writer
+    static std::unique_ptr<SharedCatalog> create(const std::string& regionName,
+                                                 int itemCapacity, int userCapacity);
+
+    // Map an existing region read-only, waiting briefly for one that is
+    // still being filled or replaced
+    static std::unique_ptr<SharedCatalog> attach(const std::string& regionName);
+
+    // Non-copyable (owns a mapping)
+    SharedCatalog(const SharedCatalog&) = delete;
+    SharedCatalog& operator=(const SharedCatalog&) = delete;
+
+    // Writer operations
+    void addItem(const std::string& itemId, const std::string& title,
+                 const std::string& publisher, const std::string& itemType, int year,
+                 int totalCopies, int availableCopies, double lateFeePerDay);
+    void addUser(const std::string& userId, const std::string& userName,
+                 const std::string& email, const std::string& role,
+                 int maxBorrowLimit, int borrowDuration, int currentlyBorrowed);
+    void updateItemCopies(const std::string& itemId, int totalCopies, int availableCopies);
+    void updateUserLoans(const std::string& userId, int currentlyBorrowed);
+
+    // Let readers attach once the initial records are written
+    void markReady();
+
+    // Tell readers a replacement now holds the name; this object stops
+    // owning the name, so destroying it leaves the replacement in place
+    void retire();
+
+    // Reader operations (also valid for the owner)
+    int getItemCount() const;
+    int getUserCount() const;
+    int getItemCapacity() const { return static_cast<int>(header()->itemCapacity); }
+    int getUserCapacity() const { return static_cast<int>(header()->userCapacity); }
+    bool isRetired() const { return header()->retired.load(std::memory_order_acquire) != 0; }
+    std::vector<CatalogItem> getItems() const;
+    bool findItem(const std::string& itemId, CatalogItem& item) const;
+    bool findUser(const std::string& userId, CatalogUser& user) const;
+    std::vector<CatalogItem> searchByTitle(const std::string& title) const;
+
+    const std::string& getName() const { return name; }
+    bool isOwner() const { return owner; }
+    size_t getMappedSize() const { return mappedSize; }
+
+    // Destructor; the owner also retires the region and removes its name
+    ~SharedCatalog();
+};
+
+#endif // SHAREDCATALOG_H
@@ -22,8 +22,6 @@ public:
     // Override virtual functions
     void displayInfo() const override;
     std::string getRole() const override;
-    int getMaxBorrowLimit() const override;
-    int getBorrowDuration() const override;
     
     // Student-specific getters
     std::string getStudentId() const { return studentId; }
@@ -31,7 +29,7 @@ public:
     int getYear() const { return year; }
     
     // Serialization
-    std::string serialize() const override;
+    void writeTo(RecordWriter& out) const override;
     
     // Destructor
     ~Student();
@@ -0,0 +1,104 @@
+#ifndef TASKPOOL_H
+#define TASKPOOL_H
+
+#include <vector>
+#include <deque>
+#include <memory>
+#include <functional>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <algorithm>
+#include <utility>
+
+/**
+ * TaskPool class - work-stealing thread pool for parallel scans and batch jobs
+ * Demonstrates: Work stealing, Fork-join parallelism, RAII
+ *
+ * Each worker owns a deque: it pops its own newest task and, when idle,
+ * steals the oldest task from another worker. A thread that starts a
+ * parallel loop runs chunks of it too while it waits, so loops may be
+ * started from inside pool tasks without deadlocking.
+ *
+ * With zero workers (or after shutdown) everything runs inline on the
+ * calling thread.
+ */
+class TaskPool {
+private:
+    struct Worker {
+        std::deque<std::function<void()>> tasks;
+        std::mutex lock;
+    };
+
+    std::vector<std::unique_ptr<Worker>> workers;
+    std::vector<std::thread> threads;     // Never resized after construction
+    std::atomic<unsigned> activeWorkers;  // Worker threads still running loops
+    std::mutex sleepMutex;
+    std::condition_variable wake;
+    std::atomic<size_t> pending;   // Tasks queued but not yet started
+    std::atomic<bool> stopping;
+    std::atomic<unsigned> nextQueue;
+
+    static thread_local int currentWorker; // Index of the worker this thread is, or -1
+
+    void submit(std::function<void()> task);
+    bool runOne(int self);
+    void workerLoop(int index);
+
+    // Run chunkBody(0) .. chunkBody(chunkCount - 1), spread across the pool
+    void runChunks(size_t chunkCount, const std::function<void(size_t)>& chunkBody);
+
+public:
+    // Constructor: starts 'workerCount' threads besides the callers
+    explicit TaskPool(unsigned workerCount);
+
+    // Non-copyable (owns threads)
+    TaskPool(const TaskPool&) = delete;
+    TaskPool& operator=(const TaskPool&) = delete;
+
+    // Threads that execute a parallel loop: the workers plus the caller
+    unsigned getParallelism() const { return activeWorkers.load(std::memory_order_acquire) + 1; }
+
+    // Call body(lo, hi) over disjoint subranges covering [begin, end);
+    // subranges hold at least 'grain' indexes
+    void parallelFor(size_t begin, size_t end, size_t grain,
+                     const std::function<void(size_t, size_t)>& body);
+
+    // Map each subrange to a partial result and combine the partials in
+    // index order, so the result does not depend on scheduling
+    template <typename T, typename Map, typename Combine>
+    T parallelReduce(size_t begin, size_t end, size_t grain, T identity, Map map, Combine combine) {
+        if (end <= begin) {
+            return identity;
+        }
+        size_t chunkCount = chunkCountFor(end - begin, grain);
+        size_t chunkSize = (end - begin + chunkCount - 1) / chunkCount;
+        std::vector<T> partials(chunkCount, identity);
+
+        runChunks(chunkCount, [&](size_t chunk) {
+            size_t lo = begin + chunk * chunkSize;
+            size_t hi = std::min(end, lo + chunkSize);
+            if (lo < hi) {
+                partials[chunk] = map(lo, hi);
+            }
+        });
+
+        T result = identity;
+        for (auto& partial : partials) {
+            result = combine(std::move(result), std::move(partial));
+        }
+        return result;
+    }
+
+    // Finish queued work and stop the workers; later loops run inline
+    void shutdown();
+
+    // Destructor
+    ~TaskPool();
+
+private:
+    size_t chunkCountFor(size_t length, size_t grain) const;
+};
+
+#endif // TASKPOOL_H
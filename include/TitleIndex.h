@@ -0,0 +1,63 @@
+#ifndef TITLEINDEX_H
+#define TITLEINDEX_H
+
+#include <string>
+#include <vector>
+#include <unordered_map>
+#include <cstdint>
+#include <shared_mutex>
+#include "TaskPool.h"
+
+/**
+ * One approximate title match: the item and its edit distance
+ */
+struct TitleMatch {
+    std::string itemId;
+    int distance;
+};
+
+/**
+ * TitleIndex class - typo-tolerant title search
+ * Demonstrates: Bit-parallel dynamic programming, Inverted index filtering
+ *
+ * A title matches when some substring of it is within k edits
+ * (insertions, deletions, substitutions) of the query, ignoring case.
+ * Distances are computed with Myers' bit-parallel algorithm, which
+ * advances a whole column of the edit-distance table per text character
+ * using a few word operations per 64 query characters.
+ *
+ * To avoid running the matcher on every title, the index keeps the
+ * trigrams of each title. k edits destroy at most 3k of the query's
+ * distinct trigrams, so a match shares at least (distinct - 3k) of them
+ * with the title. Hits are counted from the query's posting lists and
+ * only titles reaching that count are verified. Queries too short for
+ * the bound verify every title. Both steps are split by title range
+ * across the task pool.
+ */
+class TitleIndex {
+private:
+    static const size_t GRAM = 3;
+
+    std::vector<std::string> itemIds;
+    std::vector<std::string> titles; // Lower-cased, same order as itemIds
+    std::unordered_map<uint32_t, std::vector<uint32_t>> postings; // Trigram -> title numbers
+
+    // Titles are only appended, but searches may run during an append
+    mutable std::shared_timed_mutex indexMutex;
+
+    static std::string normalize(const std::string& text);
+    static uint32_t gramKey(const std::string& text, size_t pos);
+
+public:
+    // Index one title
+    void add(const std::string& itemId, const std::string& title);
+    void clear();
+    size_t size() const;
+
+    // Up to 'limit' titles (0 = all) within 'maxDistance' edits of the
+    // query, closest first (ties by title, then item ID)
+    std::vector<TitleMatch> search(const std::string& query, int maxDistance,
+                                   size_t limit, TaskPool& pool) const;
+};
+
+#endif // TITLEINDEX_H
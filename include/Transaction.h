@@ -2,7 +2,10 @@
 #define TRANSACTION_H
 
 #include <string>
+#include <ostream>
 #include <ctime>
+#include <vector>
+#include "RecordWriter.h"
 
 /**
  * Transaction class for managing borrow/return operations
@@ -13,22 +16,42 @@ private:
     std::string transactionId;
     std::string userId;
     std::string itemId;
+    std::string copyBarcode; // Physical copy lent out
     time_t borrowDate;
     time_t dueDate;
     time_t returnDate;
     bool isReturned;
     double fineAmount;
+    double accruedFine; // Fine already charged to the ledger while still out
+    double lateFeePerDay; // Terms of the loan, fixed at checkout; -1 until known
+    double fineCap;       // 0 for no cap
+    
+    // Fine for the days from the due date to 'until', within the cap
+    double fineUntil(time_t until) const;
     
     // Helper function to calculate days difference
     int daysBetween(time_t start, time_t end) const;
     
 public:
-    // Constructor
+    // Constructors
+    Transaction();
     Transaction(const std::string& tid, const std::string& uid, const std::string& iid,
-                int borrowDurationDays);
+                const std::string& barcode, time_t borrowed, time_t due,
+                double feePerDay, double cap);
+    
+    // Rebuild a transaction from its serialize() fields
+    static Transaction deserialize(const std::vector<std::string>& fields);
     
     // Process return and calculate fine
-    double processReturn(double lateFeePerDay);
+    double processReturn(time_t when = time(nullptr));
+    
+    // Bring the running fine of an open overdue loan up to 'now';
+    // returns the newly accrued amount
+    double accrueFine(time_t now);
+    
+    // Records written before loans kept their terms get them on load
+    bool hasLoanTerms() const { return lateFeePerDay >= 0; }
+    void setLoanTerms(double feePerDay, double cap);
     
     // Check if overdue
     bool isOverdue() const;
@@ -36,18 +59,24 @@ public:
     
     // Display transaction info
     void displayInfo() const;
+    void displayInfo(std::ostream& out) const;
     
     // Getters
     std::string getTransactionId() const { return transactionId; }
     std::string getUserId() const { return userId; }
     std::string getItemId() const { return itemId; }
+    std::string getCopyBarcode() const { return copyBarcode; }
     time_t getBorrowDate() const { return borrowDate; }
     time_t getDueDate() const { return dueDate; }
     time_t getReturnDate() const { return returnDate; }
     bool getIsReturned() const { return isReturned; }
     double getFineAmount() const { return fineAmount; }
+    double getAccruedFine() const { return accruedFine; }
+    double getLateFeePerDay() const { return lateFeePerDay; }
+    double getFineCap() const { return fineCap; }
     
     // Serialization
+    void writeTo(RecordWriter& out) const;
     std::string serialize() const;
     
     // Static helper to get current time as string
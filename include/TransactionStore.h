@@ -0,0 +1,162 @@
+#ifndef TRANSACTIONSTORE_H
+#define TRANSACTIONSTORE_H
+
+#include <vector>
+#include <memory>
+#include <atomic>
+#include <mutex>
+#include "Transaction.h"
+
+/**
+ * TransactionSnapshot class - immutable, versioned view of the transaction history
+ * Demonstrates: Multi-version reads, Structural sharing
+ *
+ * A snapshot shares its chunks with the store and with other snapshots
+ * until a writer changes one; readers iterate it without any lock while
+ * writers carry on.
+ */
+class TransactionSnapshot {
+private:
+    friend class TransactionStore;
+
+    typedef std::vector<Transaction> Chunk;
+
+    unsigned long long version;
+    size_t count;
+    size_t chunkSize;
+    std::vector<std::shared_ptr<const Chunk>> chunks;
+
+public:
+    TransactionSnapshot() : version(0), count(0), chunkSize(1) {}
+
+    unsigned long long getVersion() const { return version; }
+    size_t size() const { return count; }
+    bool empty() const { return count == 0; }
+    const Transaction& at(size_t index) const { return (*chunks[index / chunkSize])[index % chunkSize]; }
+
+    // Visit every recorded transaction in ID order, skipping empty slots
+    template <typename Visitor>
+    void forEach(Visitor visit) const {
+        for (size_t i = 0; i < count; i++) {
+            const Transaction& trans = at(i);
+            if (!trans.getTransactionId().empty()) {
+                visit(trans);
+            }
+        }
+    }
+};
+
+/**
+ * TransactionStore class - segmented append-only transaction log
+ * Demonstrates: Lock-free allocation, Copy-on-write snapshots
+ *
+ * Slots live in fixed-size chunks reached through a two-level directory:
+ * a preallocated top level of blocks, each block holding BLOCK_CHUNKS
+ * chunk pointers and allocated when first needed. Appending never
+ * reallocates or moves an existing entry, and the directory costs 512KB
+ * up front however far the log grows. A slot index comes from an atomic
+ * counter; the block and chunk holding it are installed with a
+ * compare-and-swap, and the slot is committed with a
+ * release store once its record is written. Appends from any number of
+ * threads therefore proceed without a lock, and readers skip slots that
+ * are allocated but not yet committed. Library allocates outside its
+ * state lock but commits a borrow's row under it, because the loan maps
+ * point at the row at once; live checkouts therefore still serialize on
+ * that lock, and only replay partitions append in parallel.
+ *
+ * Committed rows may still be updated in place (returns, fine accrual).
+ * publish() hands each chunk's live rows to the new TransactionSnapshot
+ * without copying them and marks the chunk shared; the first write to a
+ * shared chunk copies it (copy-on-write), so the store holds one copy of
+ * the history plus the chunks written since the last snapshot. Updates
+ * and publish() must be serialized by the caller.
+ */
+class TransactionStore {
+public:
+    static const size_t CHUNK_SIZE = 256;
+    static const size_t BLOCK_CHUNKS = 4096; // 1M transactions per directory block
+    static const size_t MAX_BLOCKS = 65536;  // About 68 billion transactions in all
+
+private:
+    typedef std::vector<Transaction> Rows;
+
+    struct Chunk {
+        std::mutex rowsMutex;            // Held to write 'rows' or to share it
+        std::shared_ptr<Rows> rows;      // CHUNK_SIZE live rows
+        std::atomic<Rows*> live;         // rows.get(), for lock-free reads
+        std::shared_ptr<Rows> replaced;  // Rows a copy swapped out; freed by publish()
+        bool shared;                     // A snapshot holds 'rows'
+        std::atomic<bool> committed[CHUNK_SIZE];
+
+        Chunk();
+    };
+
+    struct Block {
+        std::atomic<Chunk*> chunks[BLOCK_CHUNKS];
+
+        Block();
+    };
+
+    std::unique_ptr<std::atomic<Block*>[]> directory;
+    std::atomic<size_t> nextIndex;      // One past the highest slot handed out
+    std::atomic<size_t> committedCount;
+    std::atomic<unsigned long long> version; // Bumped by every write
+
+    // Latest published snapshot; read and replaced with atomic_load/atomic_store
+    mutable std::shared_ptr<const TransactionSnapshot> current;
+
+    Chunk* chunkFor(size_t index);
+    Chunk* findChunk(size_t index) const;
+    Chunk* chunkAt(size_t chunkIndex) const; // Null if never installed
+    static Rows& writableRows(Chunk& chunk);  // Caller holds chunk.rowsMutex
+
+public:
+    // Constructor
+    TransactionStore();
+
+    // Non-copyable (owns its chunks)
+    TransactionStore(const TransactionStore&) = delete;
+    TransactionStore& operator=(const TransactionStore&) = delete;
+
+    // Reserve a fresh slot; lock-free and safe from any thread
+    size_t allocate();
+
+    // Write and commit a slot. Also used for slots whose index is known
+    // in advance (journal replay, snapshot load), which moves the
+    // allocator past them.
+    void commit(size_t index, const Transaction& trans);
+
+    bool isCommitted(size_t index) const;
+    Transaction& at(size_t index);              // Update a committed row; unshares its chunk
+    const Transaction& get(size_t index) const; // Writer-side read of a committed row
+
+    size_t size() const { return nextIndex.load(std::memory_order_acquire); }
+    size_t getCommittedCount() const { return committedCount.load(std::memory_order_acquire); }
+    bool empty() const { return getCommittedCount() == 0; }
+
+    // Visit every committed transaction in slot order
+    template <typename Visitor>
+    void forEach(Visitor visit) const {
+        size_t total = size();
+        for (size_t i = 0; i < total; i++) {
+            if (isCommitted(i)) {
+                visit(get(i));
+            }
+        }
+    }
+
+    // Drop every chunk; not safe against concurrent access
+    void clear();
+
+    // Publish the current state as a snapshot and return it. Copies no
+    // rows; cost is one pointer per chunk.
+    std::shared_ptr<const TransactionSnapshot> publish() const;
+
+    // The most recently published snapshot, without publishing
+    std::shared_ptr<const TransactionSnapshot> latest() const;
+
+    // Destructor
+    ~TransactionStore();
+};
+
+#endif // TRANSACTIONSTORE_H
@@ -0,0 +1,75 @@
+#ifndef WORKLOADTRACE_H
+#define WORKLOADTRACE_H
+
+#include <string>
+#include <vector>
+#include <mutex>
+#include <chrono>
+#include <cstdio>
+
+// Library operations a workload trace captures
+enum class TraceOp { Borrow, Return, SearchTitle, SearchKeywords, SearchType };
+
+// One captured call: when it arrived, who made it and its argument
+// (item ID or query). 'limit' is the result limit of a keyword search.
+struct TraceEntry {
+    unsigned long long offsetMicros; // Since the recording started
+    TraceOp op;
+    std::string userId;              // Empty for searches
+    std::string argument;
+    unsigned long long limit;
+};
+
+/**
+ * TraceRecorder class - captures Library calls into a workload trace
+ * Demonstrates: Append-only logging, Buffered writes
+ *
+ * Every call is written as one record, in arrival order:
+ *
+ *   offsetMicros|OP|userId|argument|limit
+ *
+ * with OP one of BORROW, RETURN, SEARCH_TITLE, SEARCH_KEYWORDS and
+ * SEARCH_TYPE. Calls are recorded whether or not they succeed, so a
+ * replay meets the same errors. Records are buffered and written in
+ * 64KB blocks; flush() or destruction writes the rest.
+ *
+ * The library state the trace starts from is saved beside it, under
+ * snapshotFileFor(), so a replay begins where the recording did.
+ */
+class TraceRecorder {
+private:
+    std::string filename;
+    FILE* file;
+    std::string buffer;
+    std::chrono::steady_clock::time_point start;
+    unsigned long long recorded;
+    std::mutex mutex;
+
+    void writeBuffer();
+
+public:
+    // Starts a new trace in 'filename'; throws FileIOException
+    explicit TraceRecorder(const std::string& filename);
+    ~TraceRecorder();
+
+    TraceRecorder(const TraceRecorder&) = delete;
+    TraceRecorder& operator=(const TraceRecorder&) = delete;
+
+    void record(TraceOp op, const std::string& userId, const std::string& argument,
+                unsigned long long limit = 0);
+    void flush();
+
+    const std::string& getFilename() const { return filename; }
+    unsigned long long getRecordedCount();
+
+    static const char* opName(TraceOp op);
+
+    // Snapshot of the library taken when the trace in 'traceFile' started
+    static std::string snapshotFileFor(const std::string& traceFile);
+
+    // Every entry of a trace file; throws FileIOException, or
+    // InvalidOperationException naming a malformed line
+    static std::vector<TraceEntry> readTrace(const std::string& filename);
+};
+
+#endif // WORKLOADTRACE_H
@@ -22,7 +22,8 @@ const CONFIG = {
         JOURNAL: 'Journal'
     },
 
-    // Borrowing Limits (days)
+    // Borrowing Limits (days). These and the limits and fine rates below
+    // mirror the server's built-in loan policy (src/LoanPolicy.cpp).
     BORROW_DURATION: {
         Student: 14,
         Faculty: 30,
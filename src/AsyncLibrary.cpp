@@ -0,0 +1,185 @@
+// Compiled only as C++20; empty in C++14 builds that glob src/*.cpp
+#if defined(__cpp_impl_coroutine)
+
+#include "../include/AsyncLibrary.h"
+#include "../include/Exceptions.h"
+
+// ==================== Event Loop ====================
+
+// Fire-and-forget coroutine that owns a spawned task until it finishes
+struct EventLoop::Detached {
+    struct promise_type {
+        Detached get_return_object() {
+            return Detached{std::coroutine_handle<promise_type>::from_promise(*this)};
+        }
+        std::suspend_always initial_suspend() noexcept { return {}; }
+        std::suspend_never final_suspend() noexcept { return {}; }
+        void return_void() {}
+        void unhandled_exception() { std::terminate(); }
+    };
+    std::coroutine_handle<promise_type> handle;
+};
+
+EventLoop::EventLoop(unsigned threadCount) : stopping(false), outstanding(0) {
+    if (threadCount == 0) {
+        threadCount = 1;
+    }
+    for (unsigned i = 0; i < threadCount; i++) {
+        threads.push_back(std::thread(&EventLoop::threadLoop, this));
+    }
+}
+
+EventLoop::~EventLoop() {
+    shutdown();
+}
+
+void EventLoop::post(std::coroutine_handle<> handle) {
+    {
+        std::lock_guard<std::mutex> guard(queueMutex);
+        runQueue.push_back(handle);
+    }
+    queueReady.notify_one();
+}
+
+void EventLoop::threadLoop() {
+    while (true) {
+        std::coroutine_handle<> next;
+        {
+            std::unique_lock<std::mutex> guard(queueMutex);
+            queueReady.wait(guard, [this] { return stopping || !runQueue.empty(); });
+            if (runQueue.empty()) {
+                return;
+            }
+            next = runQueue.front();
+            runQueue.pop_front();
+        }
+        next.resume();
+    }
+}
+
+EventLoop::Detached EventLoop::runDetached(EventLoop* loop, Task<void> task,
+                                           std::function<void(std::exception_ptr)> onError) {
+    try {
+        co_await task;
+    } catch (...) {
+        if (onError) {
+            onError(std::current_exception());
+        }
+    }
+    loop->finished();
+}
+
+void EventLoop::spawn(Task<void> task, std::function<void(std::exception_ptr)> onError) {
+    {
+        std::lock_guard<std::mutex> guard(queueMutex);
+        outstanding++;
+    }
+    post(runDetached(this, std::move(task), std::move(onError)).handle);
+}
+
+void EventLoop::finished() {
+    std::lock_guard<std::mutex> guard(queueMutex);
+    if (--outstanding == 0) {
+        idle.notify_all();
+    }
+}
+
+void EventLoop::waitIdle() {
+    std::unique_lock<std::mutex> guard(queueMutex);
+    idle.wait(guard, [this] { return outstanding == 0; });
+}
+
+void EventLoop::shutdown() {
+    {
+        std::lock_guard<std::mutex> guard(queueMutex);
+        if (stopping) {
+            return;
+        }
+        stopping = true;
+    }
+    queueReady.notify_all();
+    for (auto& thread : threads) {
+        thread.join();
+    }
+    threads.clear();
+}
+
+// ==================== Durable Writes ====================
+
+namespace {
+
+// Awaitable for a group-committed journal write. The journal may report
+// completion before the coroutine has suspended, so the two sides race
+// on 'state' and whichever comes second resumes the coroutine.
+class DurableWrite {
+private:
+    enum { Pending, Waiting, Done };
+
+    struct Shared {
+        std::atomic<int> state{Pending};
+        std::exception_ptr error;
+        std::coroutine_handle<> waiter;
+    };
+
+    EventLoop& loop;
+    std::shared_ptr<Shared> shared;
+
+public:
+    explicit DurableWrite(EventLoop& eventLoop)
+        : loop(eventLoop), shared(std::make_shared<Shared>()) {}
+
+    EventJournal::DurableCallback callback() {
+        std::shared_ptr<Shared> target = shared;
+        EventLoop* owner = &loop;
+        return [target, owner](std::exception_ptr error) {
+            target->error = error;
+            if (target->state.exchange(Done, std::memory_order_acq_rel) == Waiting) {
+                owner->post(target->waiter);
+            }
+        };
+    }
+
+    bool await_ready() const noexcept {
+        return shared->state.load(std::memory_order_acquire) == Done;
+    }
+    bool await_suspend(std::coroutine_handle<> handle) {
+        shared->waiter = handle;
+        int expected = Pending;
+        return shared->state.compare_exchange_strong(expected, Waiting, std::memory_order_acq_rel);
+    }
+    // The change was applied before the write, so a failure is not a refusal
+    void await_resume() const {
+        if (shared->error) {
+            try {
+                std::rethrow_exception(shared->error);
+            } catch (const std::exception& e) {
+                throw NotDurableException(e.what());
+            }
+        }
+    }
+};
+
+} // namespace
+
+// ==================== Library Facade ====================
+
+Task<Transaction> AsyncLibrary::borrow(std::string userId, std::string itemId) {
+    DurableWrite durable(loop);
+    Transaction trans = library.checkoutItem(userId, itemId, durable.callback());
+    co_await durable;
+    co_return trans;
+}
+
+Task<Library::ReturnSummary> AsyncLibrary::giveBack(std::string userId, std::string itemId) {
+    DurableWrite durable(loop);
+    Library::ReturnSummary summary = library.checkinItem(userId, itemId, durable.callback());
+    co_await durable;
+    co_return summary;
+}
+
+Task<void> AsyncLibrary::checkpoint(std::string snapshotFile) {
+    Library* target = &library;
+    co_await loop.offload([target, snapshotFile] { target->checkpoint(snapshotFile); });
+}
+
+#endif // __cpp_impl_coroutine
@@ -0,0 +1,184 @@
+#include "../include/AutocompleteIndex.h"
+#include <algorithm>
+#include <mutex>
+#include <cctype>
+
+const size_t AutocompleteIndex::TOP_K;
+const uint32_t AutocompleteIndex::NONE;
+
+AutocompleteIndex::AutocompleteIndex() : nodes(1) {}
+
+std::string AutocompleteIndex::normalize(const std::string& text) {
+    std::string key;
+    bool pendingSpace = false;
+    for (char c : text) {
+        if (std::isspace(static_cast<unsigned char>(c))) {
+            pendingSpace = !key.empty();
+            continue;
+        }
+        if (pendingSpace) {
+            key += ' ';
+            pendingSpace = false;
+        }
+        key += static_cast<char>(std::tolower(static_cast<unsigned char>(c)));
+    }
+    return key;
+}
+
+bool AutocompleteIndex::ranksBefore(uint32_t a, uint32_t b) const {
+    if (entries[a].weight != entries[b].weight) {
+        return entries[a].weight > entries[b].weight;
+    }
+    return entries[a].text < entries[b].text;
+}
+
+uint32_t AutocompleteIndex::findChild(uint32_t node, char first) const {
+    for (uint32_t child = nodes[node].firstChild; child != NONE; child = nodes[child].nextSibling) {
+        if (labels[nodes[child].labelOffset] == first) {
+            return child;
+        }
+    }
+    return NONE;
+}
+
+uint32_t AutocompleteIndex::addNode(uint32_t parent, const std::string& key, size_t from) {
+    Node leaf;
+    leaf.labelOffset = static_cast<uint32_t>(labels.size());
+    leaf.labelLength = static_cast<uint32_t>(key.size() - from);
+    leaf.nextSibling = nodes[parent].firstChild;
+    labels.append(key, from, std::string::npos);
+
+    uint32_t index = static_cast<uint32_t>(nodes.size());
+    nodes.push_back(leaf);
+    nodes[parent].firstChild = index;
+    return index;
+}
+
+void AutocompleteIndex::splitNode(uint32_t node, uint32_t at) {
+    // The node keeps its index, so its parent's links stay valid; the
+    // tail of its label moves to a new child that takes over its subtree
+    Node tail = nodes[node];
+    tail.labelOffset += at;
+    tail.labelLength -= at;
+    tail.nextSibling = NONE;
+
+    uint32_t index = static_cast<uint32_t>(nodes.size());
+    nodes.push_back(tail);
+
+    Node& head = nodes[node];
+    head.labelLength = at;
+    head.firstChild = index;
+    head.entry = NONE; // top is unchanged: the subtree holds the same entries
+}
+
+void AutocompleteIndex::promote(uint32_t node, uint32_t entry) {
+    Node& n = nodes[node];
+    uint32_t* begin = n.top;
+    uint32_t* end = n.top + n.topCount;
+    uint32_t* it = std::find(begin, end, entry);
+    if (it == end) {
+        if (n.topCount < TOP_K) {
+            *end = entry;
+            n.topCount++;
+        } else if (ranksBefore(entry, end[-1])) {
+            it = end - 1;
+            *it = entry;
+        } else {
+            return;
+        }
+    }
+    // The entry only got heavier, so it can only move forward
+    while (it != begin && ranksBefore(*it, it[-1])) {
+        std::iter_swap(it, it - 1);
+        --it;
+    }
+}
+
+// ==================== Maintenance ====================
+
+void AutocompleteIndex::add(const std::string& text, unsigned long long weight) {
+    std::string key = normalize(text);
+    if (key.empty()) {
+        return;
+    }
+
+    std::unique_lock<std::shared_timed_mutex> lock(indexMutex);
+    std::vector<uint32_t> path(1, 0);
+    uint32_t node = 0;
+    size_t pos = 0;
+    while (pos < key.size()) {
+        uint32_t child = findChild(node, key[pos]);
+        if (child == NONE) {
+            node = addNode(node, key, pos);
+            path.push_back(node);
+            break;
+        }
+
+        const Node& next = nodes[child];
+        uint32_t common = 0;
+        while (common < next.labelLength && pos + common < key.size() &&
+               labels[next.labelOffset + common] == key[pos + common]) {
+            common++;
+        }
+        if (common < next.labelLength) {
+            splitNode(child, common);
+        }
+        node = child;
+        path.push_back(node);
+        pos += common;
+    }
+
+    if (nodes[node].entry == NONE) {
+        nodes[node].entry = static_cast<uint32_t>(entries.size());
+        entries.push_back(Entry{text, 0});
+    }
+    uint32_t entry = nodes[node].entry;
+    entries[entry].weight += weight;
+
+    for (uint32_t onPath : path) {
+        promote(onPath, entry);
+    }
+}
+
+void AutocompleteIndex::clear() {
+    std::unique_lock<std::shared_timed_mutex> lock(indexMutex);
+    nodes.assign(1, Node());
+    labels.clear();
+    entries.clear();
+}
+
+size_t AutocompleteIndex::size() const {
+    std::shared_lock<std::shared_timed_mutex> lock(indexMutex);
+    return entries.size();
+}
+
+// ==================== Queries ====================
+
+std::vector<Completion> AutocompleteIndex::suggest(const std::string& prefix, size_t limit) const {
+    std::string key = normalize(prefix);
+    std::vector<Completion> completions;
+
+    std::shared_lock<std::shared_timed_mutex> lock(indexMutex);
+    uint32_t node = 0;
+    size_t pos = 0;
+    while (pos < key.size()) {
+        node = findChild(node, key[pos]);
+        if (node == NONE) {
+            return completions;
+        }
+        // The prefix may end part way along this edge
+        size_t length = std::min<size_t>(nodes[node].labelLength, key.size() - pos);
+        if (labels.compare(nodes[node].labelOffset, length, key, pos, length) != 0) {
+            return completions;
+        }
+        pos += length;
+    }
+
+    const Node& found = nodes[node];
+    size_t count = std::min<size_t>(found.topCount, limit);
+    for (size_t i = 0; i < count; i++) {
+        const Entry& entry = entries[found.top[i]];
+        completions.push_back(Completion{entry.text, entry.weight});
+    }
+    return completions;
+}
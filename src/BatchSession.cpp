@@ -0,0 +1,263 @@
+#include "../include/BatchSession.h"
+#include "../include/Exceptions.h"
+#include "../include/RecordWriter.h"
+#include <sstream>
+#include <limits>
+#include <stdexcept>
+
+// Buffered output written even while more input is waiting
+static const size_t FLUSH_BYTES = 64 * 1024;
+
+BatchSession::BatchSession(Library& lib, std::ostream& output)
+    : library(lib), out(output), commandCount(0), errorCount(0) {}
+
+const char* BatchSession::errorCode(const std::exception& e) {
+    if (dynamic_cast<const ItemNotFoundException*>(&e) != nullptr ||
+        dynamic_cast<const UserNotFoundException*>(&e) != nullptr) {
+        return "NOT_FOUND";
+    }
+    if (dynamic_cast<const ItemAlreadyBorrowedException*>(&e) != nullptr) {
+        return "ALREADY_BORROWED";
+    }
+    if (dynamic_cast<const BorrowLimitExceededException*>(&e) != nullptr) {
+        return "LIMIT_EXCEEDED";
+    }
+    if (dynamic_cast<const AuthenticationException*>(&e) != nullptr) {
+        return "AUTH_FAILED";
+    }
+    if (dynamic_cast<const InvalidOperationException*>(&e) != nullptr) {
+        return "INVALID";
+    }
+    if (dynamic_cast<const FileIOException*>(&e) != nullptr) {
+        return "IO_ERROR";
+    }
+    if (dynamic_cast<const std::invalid_argument*>(&e) != nullptr ||
+        dynamic_cast<const std::out_of_range*>(&e) != nullptr) {
+        return "BAD_ARGUMENT";
+    }
+    return "FAILED";
+}
+
+std::shared_ptr<Person> BatchSession::requireUser(const std::string& command) const {
+    if (!user) {
+        throw InvalidOperationException(command + " needs a login first");
+    }
+    return user;
+}
+
+void BatchSession::itemRecords(const std::vector<std::shared_ptr<LibraryItem>>& items) {
+    RecordWriter record(buffer);
+    for (const auto& item : items) {
+        record.field("ITEM").field(item->getItemId()).field(item->getItemType())
+              .field(item->getTitle()).field(item->getAvailableCopies())
+              .field(item->getTotalCopies());
+        record.endRecord();
+    }
+}
+
+void BatchSession::loanRecords(const std::vector<Transaction>& loans) {
+    RecordWriter record(buffer);
+    for (const auto& trans : loans) {
+        record.field("LOAN").field(trans.getTransactionId()).field(trans.getUserId())
+              .field(trans.getItemId()).field(static_cast<long long>(trans.getDueDate()));
+        record.endRecord();
+    }
+}
+
+std::vector<PopularItem> BatchSession::popularItems(const std::vector<std::string>& words) {
+    // report popular day|week|month K [type TYPE] [genre GENRE...]
+    PopularityWindow window;
+    if (words[2] == "day") {
+        window = PopularityWindow::Day;
+    } else if (words[2] == "week") {
+        window = PopularityWindow::Week;
+    } else if (words[2] == "month") {
+        window = PopularityWindow::Month;
+    } else {
+        throw InvalidOperationException("Unknown period: " + words[2]);
+    }
+    int k = std::stoi(words[3]);
+    if (k < 1) {
+        throw InvalidOperationException("report popular needs a positive count");
+    }
+
+    std::string type;
+    std::string genre;
+    size_t i = 4;
+    if (i + 1 < words.size() && words[i] == "type") {
+        type = words[i + 1];
+        i += 2;
+    }
+    if (i + 1 < words.size() && words[i] == "genre") {
+        for (i++; i < words.size(); i++) {
+            genre += (genre.empty() ? "" : " ") + words[i];
+        }
+    }
+    if (i != words.size()) {
+        throw InvalidOperationException("Expected type TYPE or genre GENRE after the count");
+    }
+    return library.getPopularItems(window, type, genre, static_cast<size_t>(k));
+}
+
+void BatchSession::runCommand(const std::string& command, const std::vector<std::string>& words,
+                              const std::string& rest) {
+    RecordWriter record(buffer);
+
+    if (command == "login" && words.size() == 3) {
+        user = library.authenticateUser(words[1], words[2]);
+        record.field("OK").field(command).field(user->getUserId()).field(user->getRole());
+    } else if (command == "logout" && words.size() == 1) {
+        user.reset();
+        record.field("OK").field(command);
+    } else if (command == "borrow" && words.size() == 2) {
+        Transaction trans = library.checkoutItem(requireUser(command)->getUserId(), words[1]);
+        record.field("OK").field(command).field(words[1]).field(trans.getTransactionId())
+              .field(static_cast<long long>(trans.getDueDate()));
+    } else if (command == "return" && words.size() == 2) {
+        Library::ReturnSummary summary = library.checkinItem(requireUser(command)->getUserId(),
+                                                             words[1]);
+        record.field("OK").field(command).field(words[1]).field(summary.fine)
+              .field(summary.setAsideForHold);
+    } else if (command == "search" && words.size() >= 3) {
+        std::vector<std::shared_ptr<LibraryItem>> items;
+        if (words[1] == "title") {
+            items = library.searchByTitle(rest);
+        } else if (words[1] == "type") {
+            items = library.searchByType(rest);
+        } else if (words[1] == "keywords") {
+            for (const auto& result : library.searchKeywords(rest, 0)) {
+                items.push_back(result.first);
+            }
+        } else {
+            throw InvalidOperationException("Unknown search: " + words[1]);
+        }
+        itemRecords(items);
+        record.field("OK").field(command).field(items.size());
+    } else if (command == "related" && words.size() == 3) {
+        int n = std::stoi(words[2]);
+        if (n < 1) {
+            throw InvalidOperationException("related needs a positive count");
+        }
+        library.getItem(words[1]); // Throws for an unknown item
+        std::vector<Recommendation> related = library.getRelatedItems(words[1],
+                                                                      static_cast<size_t>(n));
+        for (const auto& entry : related) {
+            record.field("RELATED").field(entry.itemId)
+                  .field(library.getItem(entry.itemId)->getTitle()).field(entry.coBorrows);
+            record.endRecord();
+        }
+        record.field("OK").field(command).field(related.size());
+    } else if (command == "report" && words.size() >= 2) {
+        // Loan and memory reports are for librarians; anyone may see their own
+        // activity and what is popular
+        std::shared_ptr<Person> reader = requireUser(command);
+        bool librarian = reader->getPatronRole() == PatronRole::Librarian;
+        time_t now = time(nullptr);
+        if (words[1] == "activity" && words.size() <= 3) {
+            std::string userId = words.size() == 3 ? words[2] : reader->getUserId();
+            if (userId != reader->getUserId() && !librarian) {
+                throw InvalidOperationException("Only librarians can see other users' activity");
+            }
+            library.getUser(userId); // Throws for an unknown user
+            UserStats userStats = library.getUserStats(userId);
+            record.field("ACTIVITY").field(userId).field(userStats.totalBorrowed)
+                  .field(userStats.currentlyBorrowed).field(userStats.totalFines)
+                  .field(library.getOutstandingBalance(userId));
+            record.endRecord();
+            record.field("OK").field(command).field(1);
+        } else if (words[1] == "popular" && words.size() >= 4) {
+            std::vector<PopularItem> popular = popularItems(words);
+            for (const auto& entry : popular) {
+                record.field("POPULAR").field(entry.itemId)
+                      .field(library.getItem(entry.itemId)->getTitle()).field(entry.borrows)
+                      .field(entry.error);
+                record.endRecord();
+            }
+            record.field("OK").field(command).field(popular.size());
+        } else if (!librarian) {
+            throw InvalidOperationException("Only librarians can run " + words[1] + " reports");
+        } else if (words[1] == "overdue" && words.size() == 2) {
+            std::vector<Transaction> loans =
+                library.getLoansDueBetween(std::numeric_limits<time_t>::min(), now - 1);
+            loanRecords(loans);
+            record.field("OK").field(command).field(loans.size());
+        } else if (words[1] == "memory" && words.size() == 2) {
+            std::vector<Library::MemoryFootprint> rows = library.getMemoryFootprint();
+            for (const auto& row : rows) {
+                record.field("MEMORY").field(row.structure).field(row.bytes)
+                      .field(row.allocations).field(row.objects);
+                record.endRecord();
+            }
+            record.field("OK").field(command).field(rows.size());
+        } else if (words[1] == "due-soon" && words.size() == 3) {
+            time_t hours = std::stoi(words[2]);
+            std::vector<Transaction> loans = library.getLoansDueBetween(now, now + hours * 60 * 60);
+            loanRecords(loans);
+            record.field("OK").field(command).field(loans.size());
+        } else {
+            throw InvalidOperationException("Unknown report: " + words[1]);
+        }
+    } else {
+        throw InvalidOperationException("Unknown command or wrong arguments: " + command);
+    }
+    record.endRecord();
+}
+
+bool BatchSession::execute(const std::string& line) {
+    std::istringstream parser(line);
+    std::vector<std::string> words;
+    std::string word;
+    while (parser >> word) {
+        words.push_back(word);
+    }
+    if (words.empty() || words[0][0] == '#') {
+        return true;
+    }
+
+    // A search query or report argument is everything after the second word
+    std::string rest;
+    if (words.size() >= 2) {
+        size_t start = line.find(words[1], line.find(words[0]) + words[0].size());
+        start = line.find_first_not_of(" \t", start + words[1].size());
+        if (start != std::string::npos) {
+            rest = line.substr(start, line.find_last_not_of(" \t\r") + 1 - start);
+        }
+    }
+
+    commandCount++;
+    size_t mark = buffer.size();
+    try {
+        runCommand(words[0], words, rest);
+    } catch (const std::exception& e) {
+        // Drop any records the failed command had started
+        buffer.resize(mark);
+        RecordWriter record(buffer);
+        record.field("ERROR").field(words[0]).field(errorCode(e)).field(e.what());
+        record.endRecord();
+        errorCount++;
+        return false;
+    }
+    if (buffer.size() >= FLUSH_BYTES) {
+        flush();
+    }
+    return true;
+}
+
+void BatchSession::run(std::istream& in) {
+    std::string line;
+    while (std::getline(in, line)) {
+        execute(line);
+        if (in.rdbuf()->in_avail() <= 0) {
+            flush(); // Whoever feeds us may be waiting for these replies
+        }
+    }
+    flush();
+}
+
+void BatchSession::flush() {
+    if (!buffer.empty()) {
+        out.write(buffer.data(), static_cast<std::streamsize>(buffer.size()));
+        out.flush();
+        buffer.clear();
+    }
+}
@@ -0,0 +1,144 @@
+#include "../include/CatalogIndex.h"
+#include "../include/Book.h"
+#include "../include/Magazine.h"
+#include "../include/Journal.h"
+#include <algorithm>
+#include <mutex>
+#include <cctype>
+
+std::string CatalogIndex::normalizeIsbn(const std::string& isbn) {
+    std::string key;
+    for (char c : isbn) {
+        if (std::isalnum(static_cast<unsigned char>(c))) {
+            key += static_cast<char>(std::toupper(static_cast<unsigned char>(c)));
+        }
+    }
+    return key;
+}
+
+std::string CatalogIndex::normalizeText(const std::string& text) {
+    std::string key;
+    bool pendingSpace = false;
+    for (char c : text) {
+        if (std::isspace(static_cast<unsigned char>(c))) {
+            pendingSpace = !key.empty();
+            continue;
+        }
+        if (pendingSpace) {
+            key += ' ';
+            pendingSpace = false;
+        }
+        key += static_cast<char>(std::tolower(static_cast<unsigned char>(c)));
+    }
+    return key;
+}
+
+void CatalogIndex::insert(KeyIndex& index, const std::string& key, uint32_t ordinal) {
+    if (!key.empty()) {
+        index[key].push_back(ordinal);
+    }
+}
+
+const CatalogIndex::Postings* CatalogIndex::lookup(const KeyIndex& index, const std::string& key) {
+    static const Postings none;
+    auto it = index.find(key);
+    return it == index.end() ? &none : &it->second;
+}
+
+std::vector<std::string> CatalogIndex::toItemIds(const Postings& ordinals) const {
+    std::vector<std::string> ids;
+    ids.reserve(ordinals.size());
+    for (uint32_t ordinal : ordinals) {
+        ids.push_back(itemIds[ordinal]);
+    }
+    std::sort(ids.begin(), ids.end());
+    return ids;
+}
+
+// ==================== Maintenance ====================
+
+void CatalogIndex::add(const std::shared_ptr<LibraryItem>& item) {
+    std::unique_lock<std::shared_timed_mutex> lock(indexMutex);
+    uint32_t ordinal = static_cast<uint32_t>(itemIds.size());
+    itemIds.push_back(item->getItemId());
+    insert(byType, normalizeText(item->getItemType()), ordinal);
+
+    // One dynamic_cast here instead of one per item on every lookup
+    if (auto book = std::dynamic_pointer_cast<Book>(item)) {
+        insert(byIsbn, normalizeIsbn(book->getIsbn()), ordinal);
+        insert(byAuthor, normalizeText(book->getAuthor()), ordinal);
+        insert(byGenre, normalizeText(book->getGenre()), ordinal);
+    } else if (auto journal = std::dynamic_pointer_cast<Journal>(item)) {
+        insert(byField, normalizeText(journal->getResearchField()), ordinal);
+    } else if (auto magazine = std::dynamic_pointer_cast<Magazine>(item)) {
+        insert(byCategory, normalizeText(magazine->getCategory()), ordinal);
+    }
+}
+
+void CatalogIndex::clear() {
+    std::unique_lock<std::shared_timed_mutex> lock(indexMutex);
+    itemIds.clear();
+    byIsbn.clear();
+    byAuthor.clear();
+    byGenre.clear();
+    byField.clear();
+    byCategory.clear();
+    byType.clear();
+}
+
+// ==================== Queries ====================
+
+std::vector<std::string> CatalogIndex::findByIsbn(const std::string& isbn) const {
+    std::shared_lock<std::shared_timed_mutex> lock(indexMutex);
+    return toItemIds(*lookup(byIsbn, normalizeIsbn(isbn)));
+}
+
+std::vector<std::string> CatalogIndex::find(const ItemQuery& query) const {
+    std::shared_lock<std::shared_timed_mutex> lock(indexMutex);
+
+    std::vector<const Postings*> lists;
+    if (!query.isbn.empty()) {
+        lists.push_back(lookup(byIsbn, normalizeIsbn(query.isbn)));
+    }
+    if (!query.author.empty()) {
+        lists.push_back(lookup(byAuthor, normalizeText(query.author)));
+    }
+    if (!query.genre.empty()) {
+        lists.push_back(lookup(byGenre, normalizeText(query.genre)));
+    }
+    if (!query.field.empty()) {
+        lists.push_back(lookup(byField, normalizeText(query.field)));
+    }
+    if (!query.category.empty()) {
+        lists.push_back(lookup(byCategory, normalizeText(query.category)));
+    }
+    if (!query.type.empty()) {
+        lists.push_back(lookup(byType, normalizeText(query.type)));
+    }
+    if (lists.empty()) {
+        return std::vector<std::string>();
+    }
+
+    // Smallest first: the running result never grows, and each of its
+    // entries is looked up in the next list by binary search, so a step
+    // costs O(result * log(list)) however long the other list is
+    std::sort(lists.begin(), lists.end(),
+              [](const Postings* a, const Postings* b) { return a->size() < b->size(); });
+
+    Postings result = *lists[0];
+    for (size_t i = 1; i < lists.size() && !result.empty(); i++) {
+        Postings narrowed;
+        auto from = lists[i]->begin();
+        for (uint32_t ordinal : result) {
+            from = std::lower_bound(from, lists[i]->end(), ordinal);
+            if (from == lists[i]->end()) {
+                break;
+            }
+            if (*from == ordinal) {
+                narrowed.push_back(ordinal);
+            }
+        }
+        result.swap(narrowed);
+    }
+    return toItemIds(result);
+}
@@ -0,0 +1,43 @@
+#include "../include/ChangeTracker.h"
+
+void ChangeTracker::markUser(const std::string& userId) {
+    std::lock_guard<std::mutex> lock(mutex);
+    users.insert(userId);
+}
+
+void ChangeTracker::markItem(const std::string& itemId) {
+    std::lock_guard<std::mutex> lock(mutex);
+    items.insert(itemId);
+}
+
+void ChangeTracker::markTransaction(size_t index) {
+    std::lock_guard<std::mutex> lock(mutex);
+    transactions.insert(index);
+}
+
+void ChangeTracker::clear() {
+    std::lock_guard<std::mutex> lock(mutex);
+    users.clear();
+    items.clear();
+    transactions.clear();
+}
+
+std::vector<std::string> ChangeTracker::getUsers() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return std::vector<std::string>(users.begin(), users.end());
+}
+
+std::vector<std::string> ChangeTracker::getItems() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return std::vector<std::string>(items.begin(), items.end());
+}
+
+std::vector<size_t> ChangeTracker::getTransactions() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return std::vector<size_t>(transactions.begin(), transactions.end());
+}
+
+size_t ChangeTracker::size() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return users.size() + items.size() + transactions.size();
+}
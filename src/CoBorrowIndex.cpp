@@ -0,0 +1,266 @@
+#include "../include/CoBorrowIndex.h"
+#include "../include/MemoryAccounting.h"
+#include <algorithm>
+#include <mutex>
+
+const size_t CoBorrowIndex::HISTORY;
+const size_t CoBorrowIndex::KEEP;
+
+// Patrons or rows handled by one task of a rebuild
+static const size_t REBUILD_GRAIN = 256;
+
+namespace {
+
+// Move 'item' to the newest end of a patron's window, dropping the oldest
+// item once the window is full
+void slide(std::vector<uint32_t>& window, uint32_t item) {
+    auto existing = std::find(window.begin(), window.end(), item);
+    if (existing != window.end()) {
+        window.erase(existing);
+    }
+    window.push_back(item);
+    if (window.size() > CoBorrowIndex::HISTORY) {
+        window.erase(window.begin());
+    }
+}
+
+bool inWindow(const std::vector<uint32_t>& window, uint32_t item) {
+    return std::find(window.begin(), window.end(), item) != window.end();
+}
+
+} // namespace
+
+bool CoBorrowIndex::stronger(const Cell& a, const Cell& b) {
+    return a.count != b.count ? a.count > b.count : a.item < b.item;
+}
+
+void CoBorrowIndex::prune(Row& row) {
+    std::nth_element(row.begin(), row.begin() + KEEP, row.end(), stronger);
+    row.resize(KEEP);
+}
+
+uint32_t CoBorrowIndex::ordinalOf(const std::string& itemId) {
+    auto found = ordinals.find(itemId);
+    if (found != ordinals.end()) {
+        return found->second;
+    }
+    uint32_t ordinal = static_cast<uint32_t>(itemIds.size());
+    ordinals.emplace(itemId, ordinal);
+    itemIds.push_back(itemId);
+    rows.emplace_back();
+    return ordinal;
+}
+
+void CoBorrowIndex::addPair(uint32_t a, uint32_t b, uint32_t count) {
+    for (uint32_t from : {a, b}) {
+        uint32_t to = from == a ? b : a;
+        Row& row = rows[from];
+        auto cell = std::find_if(row.begin(), row.end(),
+                                 [to](const Cell& c) { return c.item == to; });
+        if (cell != row.end()) {
+            cell->count += count;
+        } else {
+            row.push_back(Cell{to, count});
+            if (row.size() > 2 * KEEP) {
+                prune(row);
+            }
+        }
+    }
+}
+
+void CoBorrowIndex::recordBorrow(const std::string& userId, const std::string& itemId) {
+    MemoryScope scope(MemoryTag::Indexes);
+    std::unique_lock<std::shared_timed_mutex> lock(mutex);
+    uint32_t item = ordinalOf(itemId);
+    std::vector<uint32_t>& window = histories[userId];
+    if (!inWindow(window, item)) {
+        for (uint32_t other : window) {
+            addPair(item, other, 1);
+        }
+    }
+    slide(window, item);
+}
+
+void CoBorrowIndex::rebuild(const std::vector<std::pair<std::string, std::string>>& borrows,
+                            TaskPool& pool) {
+    MemoryScope scope(MemoryTag::Indexes);
+
+    // Number items and patrons, then lay out each patron's borrows together,
+    // oldest first: patron p owns events [patronStart[p], patronStart[p + 1])
+    std::unordered_map<std::string, uint32_t> newOrdinals;
+    std::vector<std::string> newItemIds;
+    std::unordered_map<std::string, uint32_t> patrons;
+    std::vector<std::string> patronIds;
+    std::vector<uint32_t> borrowItem(borrows.size());
+    std::vector<uint32_t> borrowPatron(borrows.size());
+    for (size_t i = 0; i < borrows.size(); i++) {
+        auto item = newOrdinals.emplace(borrows[i].second,
+                                        static_cast<uint32_t>(newItemIds.size()));
+        if (item.second) {
+            newItemIds.push_back(borrows[i].second);
+        }
+        auto patron = patrons.emplace(borrows[i].first, static_cast<uint32_t>(patronIds.size()));
+        if (patron.second) {
+            patronIds.push_back(borrows[i].first);
+        }
+        borrowItem[i] = item.first->second;
+        borrowPatron[i] = patron.first->second;
+    }
+    std::vector<size_t> patronStart(patronIds.size() + 1, 0);
+    for (uint32_t patron : borrowPatron) {
+        patronStart[patron + 1]++;
+    }
+    for (size_t p = 0; p < patronIds.size(); p++) {
+        patronStart[p + 1] += patronStart[p];
+    }
+    std::vector<uint32_t> events(borrows.size());
+    {
+        std::vector<size_t> next(patronStart.begin(), patronStart.end() - 1);
+        for (size_t i = 0; i < borrows.size(); i++) {
+            events[next[borrowPatron[i]]++] = borrowItem[i];
+        }
+    }
+
+    // Replay every patron's window, marking the borrows that paired their
+    // item with the window and keeping the window live borrows continue
+    std::vector<char> fresh(events.size());
+    std::vector<std::vector<uint32_t>> windows(patronIds.size());
+    pool.parallelFor(0, patronIds.size(), REBUILD_GRAIN, [&](size_t first, size_t last) {
+        MemoryScope taskScope(MemoryTag::Indexes);
+        for (size_t p = first; p < last; p++) {
+            for (size_t e = patronStart[p]; e < patronStart[p + 1]; e++) {
+                fresh[e] = !inWindow(windows[p], events[e]);
+                slide(windows[p], events[e]);
+            }
+        }
+    });
+
+    // Where each item was freshly borrowed, grouped by item
+    std::vector<size_t> postingStart(newItemIds.size() + 1, 0);
+    for (size_t e = 0; e < events.size(); e++) {
+        if (fresh[e]) {
+            postingStart[events[e] + 1]++;
+        }
+    }
+    for (size_t item = 0; item < newItemIds.size(); item++) {
+        postingStart[item + 1] += postingStart[item];
+    }
+    std::vector<size_t> postings(postingStart.back());
+    {
+        std::vector<size_t> next(postingStart.begin(), postingStart.end() - 1);
+        for (size_t e = 0; e < events.size(); e++) {
+            if (fresh[e]) {
+                postings[next[events[e]]++] = e;
+            }
+        }
+    }
+
+    // Each row is counted on its own: an item pairs with the window it
+    // entered, then with every item entering while it stays in the window
+    std::vector<Row> newRows(newItemIds.size());
+    pool.parallelFor(0, newRows.size(), REBUILD_GRAIN, [&](size_t first, size_t last) {
+        MemoryScope taskScope(MemoryTag::Indexes);
+        std::vector<uint32_t> counts(newItemIds.size(), 0);
+        std::vector<uint32_t> touched;
+        std::vector<uint32_t> seen;
+        for (size_t row = first; row < last; row++) {
+            uint32_t item = static_cast<uint32_t>(row);
+            auto pair = [&](uint32_t other) {
+                if (counts[other]++ == 0) {
+                    touched.push_back(other);
+                }
+            };
+            for (size_t k = postingStart[row]; k < postingStart[row + 1]; k++) {
+                size_t e = postings[k];
+                size_t p = std::upper_bound(patronStart.begin(), patronStart.end(), e) -
+                           patronStart.begin() - 1;
+
+                // The window it entered: the last HISTORY distinct items
+                seen.clear();
+                for (size_t j = e; j > patronStart[p] && seen.size() < HISTORY; j--) {
+                    if (!inWindow(seen, events[j - 1])) {
+                        seen.push_back(events[j - 1]);
+                        pair(events[j - 1]);
+                    }
+                }
+
+                // Later arrivals, until HISTORY other items push it out
+                seen.clear();
+                for (size_t j = e + 1; j < patronStart[p + 1] && seen.size() < HISTORY; j++) {
+                    if (events[j] == item) {
+                        seen.clear(); // Borrowed again: newest once more
+                        continue;
+                    }
+                    if (fresh[j]) {
+                        pair(events[j]);
+                    }
+                    if (!inWindow(seen, events[j])) {
+                        seen.push_back(events[j]);
+                    }
+                }
+            }
+
+            Row& cells = newRows[row];
+            cells.reserve(touched.size());
+            for (uint32_t other : touched) {
+                cells.push_back(Cell{other, counts[other]});
+                counts[other] = 0;
+            }
+            touched.clear();
+            if (cells.size() > 2 * KEEP) {
+                prune(cells);
+                cells.shrink_to_fit();
+            }
+        }
+    });
+
+    std::unordered_map<std::string, std::vector<uint32_t>> newHistories;
+    for (size_t p = 0; p < patronIds.size(); p++) {
+        newHistories[patronIds[p]].swap(windows[p]);
+    }
+
+    std::unique_lock<std::shared_timed_mutex> lock(mutex);
+    ordinals.swap(newOrdinals);
+    itemIds.swap(newItemIds);
+    rows.swap(newRows);
+    histories.swap(newHistories);
+}
+
+std::vector<Recommendation> CoBorrowIndex::related(const std::string& itemId, size_t n) const {
+    std::vector<Recommendation> result;
+    std::shared_lock<std::shared_timed_mutex> lock(mutex);
+    auto found = ordinals.find(itemId);
+    if (found == ordinals.end()) {
+        return result;
+    }
+
+    Row row = rows[found->second];
+    n = std::min(n, row.size());
+    std::partial_sort(row.begin(), row.begin() + n, row.end(), stronger);
+    for (size_t i = 0; i < n; i++) {
+        result.push_back(Recommendation{itemIds[row[i].item], row[i].count});
+    }
+    return result;
+}
+
+size_t CoBorrowIndex::getItemCount() const {
+    std::shared_lock<std::shared_timed_mutex> lock(mutex);
+    return itemIds.size();
+}
+
+size_t CoBorrowIndex::getCellCount() const {
+    std::shared_lock<std::shared_timed_mutex> lock(mutex);
+    size_t cells = 0;
+    for (const Row& row : rows) {
+        cells += row.size();
+    }
+    return cells;
+}
+
+void CoBorrowIndex::clear() {
+    std::unique_lock<std::shared_timed_mutex> lock(mutex);
+    ordinals.clear();
+    itemIds.clear();
+    rows.clear();
+    histories.clear();
+}
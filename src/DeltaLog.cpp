@@ -0,0 +1,150 @@
+#include "../include/DeltaLog.h"
+#include "../include/Exceptions.h"
+#include "../include/LibraryEvent.h"
+#include "../include/RecordWriter.h"
+#include <iostream>
+#include <cstdio>
+#include <unistd.h>
+
+namespace {
+
+struct Crc32Table {
+    uint32_t entries[256];
+
+    Crc32Table() {
+        for (uint32_t i = 0; i < 256; i++) {
+            uint32_t crc = i;
+            for (int bit = 0; bit < 8; bit++) {
+                crc = (crc & 1) ? 0xEDB88320u ^ (crc >> 1) : crc >> 1;
+            }
+            entries[i] = crc;
+        }
+    }
+};
+
+const Crc32Table CRC_TABLE;
+
+} // namespace
+
+DeltaLog::DeltaLog() : lastChecksum(0), blockCount(0), byteCount(0) {}
+
+uint32_t DeltaLog::crc32(const char* data, size_t size, uint32_t seed) {
+    uint32_t crc = ~seed;
+    for (size_t i = 0; i < size; i++) {
+        crc = CRC_TABLE.entries[(crc ^ static_cast<unsigned char>(data[i])) & 0xFF] ^ (crc >> 8);
+    }
+    return ~crc;
+}
+
+std::vector<DeltaLog::Block> DeltaLog::open(const std::string& filename) {
+    path = filename;
+    lastChecksum = 0;
+    blockCount = 0;
+    byteCount = 0;
+
+    std::vector<Block> blocks;
+    std::string data;
+    FILE* in = std::fopen(filename.c_str(), "rb");
+    if (in == nullptr) {
+        return blocks;
+    }
+    char buffer[65536];
+    size_t bytes;
+    while ((bytes = std::fread(buffer, 1, sizeof(buffer), in)) > 0) {
+        data.append(buffer, bytes);
+    }
+    std::fclose(in);
+
+    size_t pos = 0;
+    while (pos < data.size()) {
+        size_t headerEnd = data.find('\n', pos);
+        if (headerEnd == std::string::npos) {
+            break;
+        }
+        std::vector<std::string> header = LibraryEvent::splitRecord(data.substr(pos, headerEnd - pos));
+        if (header.size() != 6 || header[0] != "DELTA") {
+            break;
+        }
+
+        Block block;
+        size_t bodyBytes;
+        uint32_t previous;
+        uint32_t checksum;
+        try {
+            block.fromSequence = std::stoull(header[1]);
+            block.toSequence = std::stoull(header[2]);
+            bodyBytes = std::stoull(header[3]);
+            previous = static_cast<uint32_t>(std::stoul(header[4]));
+            checksum = static_cast<uint32_t>(std::stoul(header[5]));
+        } catch (const std::exception&) {
+            break;
+        }
+        if (bodyBytes > data.size() - headerEnd - 1 || previous != lastChecksum) {
+            break; // Torn by a crash mid-append, or not part of this chain
+        }
+        const char* body = data.data() + headerEnd + 1;
+        if (crc32(body, bodyBytes, previous) != checksum) {
+            break;
+        }
+
+        block.body.assign(body, bodyBytes);
+        blocks.push_back(std::move(block));
+        lastChecksum = checksum;
+        blockCount++;
+        pos = headerEnd + 1 + bodyBytes;
+    }
+
+    // Drop whatever follows the valid chain so new blocks extend it
+    if (pos < data.size()) {
+        std::cerr << "Discarding " << (data.size() - pos) << " byte(s) after the last valid block of "
+                  << filename << std::endl;
+        if (::truncate(filename.c_str(), static_cast<off_t>(pos)) != 0) {
+            throw FileIOException(filename);
+        }
+    }
+    byteCount = pos;
+    return blocks;
+}
+
+void DeltaLog::append(unsigned long long fromSequence, unsigned long long toSequence,
+                      const std::string& body) {
+    uint32_t checksum = crc32(body.data(), body.size(), lastChecksum);
+    std::string block;
+    RecordWriter out(block);
+    out.field("DELTA").field(fromSequence).field(toSequence).field(body.size())
+       .field(lastChecksum).field(checksum);
+    out.endRecord();
+    block += body;
+
+    FILE* file = std::fopen(path.c_str(), "ab");
+    if (file == nullptr) {
+        throw FileIOException(path);
+    }
+    // Synced, as the journal events it covers are discarded next
+    bool written = std::fwrite(block.data(), 1, block.size(), file) == block.size() &&
+                   std::fflush(file) == 0 && fsync(fileno(file)) == 0;
+    std::fclose(file);
+    if (!written) {
+        // Cut off a partial block so the next append still extends the chain
+        if (::truncate(path.c_str(), static_cast<off_t>(byteCount)) != 0) {
+            std::perror(path.c_str());
+        }
+        throw FileIOException(path);
+    }
+
+    lastChecksum = checksum;
+    blockCount++;
+    byteCount += block.size();
+}
+
+void DeltaLog::reset(const std::string& filename) {
+    path = filename;
+    lastChecksum = 0;
+    blockCount = 0;
+    byteCount = 0;
+    FILE* file = std::fopen(filename.c_str(), "wb");
+    if (file == nullptr) {
+        throw FileIOException(filename);
+    }
+    std::fclose(file);
+}
@@ -0,0 +1,244 @@
+#include "../include/EventJournal.h"
+#include "../include/Exceptions.h"
+#include <algorithm>
+#include <iterator>
+#include <unistd.h>
+
+EventJournal::EventJournal() : file(nullptr), stopWriter(false), failed(false) {}
+
+EventJournal::~EventJournal() {
+    close();
+}
+
+void EventJournal::open(const std::string& filename) {
+    close();
+    file = std::fopen(filename.c_str(), "ab");
+    if (file == nullptr) {
+        throw FileIOException(filename);
+    }
+    path = filename;
+    failed.store(false, std::memory_order_release);
+}
+
+void EventJournal::close() {
+    stopWriterThread();
+
+    std::exception_ptr error;
+    std::vector<DurableCallback> callbacks;
+    {
+        std::lock_guard<std::mutex> io(ioMutex);
+        callbacks = writePending(error);
+        if (file != nullptr) {
+            std::fclose(file);
+            file = nullptr;
+        }
+    }
+    notify(callbacks, error);
+}
+
+void EventJournal::append(const LibraryEvent& event) {
+    if (file == nullptr) {
+        return;
+    }
+
+    std::string line;
+    RecordWriter out(line);
+    event.writeTo(out);
+    out.endRecord();
+
+    // Deferred events were appended first, so they go out first
+    std::exception_ptr error;
+    std::vector<DurableCallback> callbacks;
+    bool written;
+    {
+        std::lock_guard<std::mutex> io(ioMutex);
+        callbacks = writePending(error);
+        written = std::fwrite(line.data(), 1, line.size(), file) == line.size() &&
+                  std::fflush(file) == 0;
+    }
+    notify(callbacks, error);
+
+    if (!written) {
+        failed.store(true, std::memory_order_release);
+        throw FileIOException(path);
+    }
+}
+
+void EventJournal::appendDeferred(const LibraryEvent& event, DurableCallback onDurable) {
+    if (file == nullptr) {
+        onDurable(nullptr);
+        return;
+    }
+
+    {
+        std::lock_guard<std::mutex> guard(pendingMutex);
+        RecordWriter out(pendingLines);
+        event.writeTo(out);
+        out.endRecord();
+        pendingCallbacks.push_back(std::move(onDurable));
+        if (!writer.joinable()) {
+            stopWriter = false;
+            writer = std::thread(&EventJournal::writerLoop, this);
+        }
+    }
+    pendingReady.notify_one();
+}
+
+void EventJournal::truncate() {
+    if (file == nullptr) {
+        return;
+    }
+
+    std::exception_ptr error;
+    std::vector<DurableCallback> callbacks;
+    {
+        std::lock_guard<std::mutex> io(ioMutex);
+        callbacks = writePending(error);
+        std::fclose(file);
+        file = std::fopen(path.c_str(), "wb");
+    }
+    notify(callbacks, error);
+
+    if (file == nullptr) {
+        failed.store(true, std::memory_order_release);
+        throw FileIOException(path);
+    }
+}
+
+// ==================== Group Commit ====================
+
+std::vector<EventJournal::DurableCallback> EventJournal::writePending(std::exception_ptr& error) {
+    std::string lines;
+    std::vector<DurableCallback> callbacks;
+    {
+        std::lock_guard<std::mutex> guard(pendingMutex);
+        lines.swap(pendingLines);
+        callbacks.swap(pendingCallbacks);
+    }
+
+    // Callers are told their events are safe, so the group must reach the
+    // disk, not just the page cache: one sync covers every event in it
+    if (!lines.empty() &&
+        (file == nullptr || std::fwrite(lines.data(), 1, lines.size(), file) != lines.size() ||
+         std::fflush(file) != 0 || fdatasync(fileno(file)) != 0)) {
+        failed.store(true, std::memory_order_release);
+        error = std::make_exception_ptr(FileIOException(path));
+    }
+    return callbacks;
+}
+
+void EventJournal::notify(std::vector<DurableCallback>& callbacks, std::exception_ptr error) {
+    for (auto& callback : callbacks) {
+        callback(error);
+    }
+}
+
+void EventJournal::writerLoop() {
+    while (true) {
+        {
+            std::unique_lock<std::mutex> guard(pendingMutex);
+            pendingReady.wait(guard, [this] { return stopWriter || !pendingLines.empty(); });
+            if (pendingLines.empty()) {
+                return; // Stopping, and nothing left to write
+            }
+        }
+
+        // Everything queued while the previous flush ran goes out together
+        std::exception_ptr error;
+        std::vector<DurableCallback> callbacks;
+        {
+            std::lock_guard<std::mutex> io(ioMutex);
+            callbacks = writePending(error);
+        }
+        notify(callbacks, error);
+    }
+}
+
+void EventJournal::stopWriterThread() {
+    {
+        std::lock_guard<std::mutex> guard(pendingMutex);
+        stopWriter = true;
+    }
+    pendingReady.notify_all();
+    if (writer.joinable()) {
+        writer.join();
+    }
+}
+
+std::vector<LibraryEvent> EventJournal::readAll(const std::string& filename, TaskPool& pool) {
+    std::vector<LibraryEvent> events;
+
+    FILE* in = std::fopen(filename.c_str(), "rb");
+    if (in == nullptr) {
+        return events;
+    }
+
+    std::string data;
+    char buffer[1 << 16];
+    size_t bytes;
+    while ((bytes = std::fread(buffer, 1, sizeof(buffer), in)) > 0) {
+        data.append(buffer, bytes);
+    }
+    std::fclose(in);
+
+    // Drop a torn final line left by a crash mid-append
+    size_t end = data.rfind('\n');
+    if (end == std::string::npos) {
+        return events;
+    }
+    end++;
+
+    // Cut the buffer into one range per pool thread, each ending on a newline
+    unsigned threadCount = std::max(1u, std::min<unsigned>(pool.getParallelism(),
+                                                           static_cast<unsigned>(end / 65536 + 1)));
+    std::vector<size_t> bounds(1, 0);
+    for (unsigned t = 1; t < threadCount; t++) {
+        size_t cut = data.find('\n', std::max(bounds.back(), end * t / threadCount));
+        if (cut == std::string::npos || cut + 1 >= end) {
+            break;
+        }
+        bounds.push_back(cut + 1);
+    }
+    bounds.push_back(end);
+
+    size_t ranges = bounds.size() - 1;
+    std::vector<std::vector<LibraryEvent>> parsed(ranges);
+    std::vector<std::string> errors(ranges);
+    std::vector<size_t> errorAt(ranges);
+
+    pool.parallelFor(0, ranges, 1, [&](size_t first, size_t last) {
+        for (size_t r = first; r < last; r++) {
+            size_t pos = bounds[r];
+            try {
+                while (pos < bounds[r + 1]) {
+                    size_t eol = data.find('\n', pos);
+                    if (eol > pos) {
+                        parsed[r].push_back(LibraryEvent::parse(data.substr(pos, eol - pos)));
+                    }
+                    pos = eol + 1;
+                }
+            } catch (const std::exception& e) {
+                errors[r] = e.what();
+                errorAt[r] = pos;
+            }
+        }
+    });
+
+    for (size_t r = 0; r < ranges; r++) {
+        if (!errors[r].empty()) {
+            size_t line = std::count(data.begin(), data.begin() + errorAt[r], '\n') + 1;
+            throw FileIOException(filename + " line " + std::to_string(line) + " (" +
+                                  errors[r] + ")");
+        }
+    }
+
+    size_t total = 0;
+    for (const auto& part : parsed) {
+        total += part.size();
+    }
+    events.reserve(total);
+    for (auto& part : parsed) {
+        std::move(part.begin(), part.end(), std::back_inserter(events));
+    }
+    return events;
+}
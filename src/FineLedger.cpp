@@ -0,0 +1,105 @@
+#include "../include/FineLedger.h"
+#include "../include/Exceptions.h"
+#include "../include/MemoryAccounting.h"
+
+void FineLedger::post(const std::string& userId, const std::string& reference,
+                      LedgerEntryType type, double amount, time_t when) {
+    if (amount <= 0) {
+        throw InvalidOperationException("Ledger amounts must be positive");
+    }
+    append(LedgerEntry{userId, reference, type, amount, when});
+}
+
+void FineLedger::restore(const LedgerEntry& entry) {
+    append(entry);
+}
+
+void FineLedger::append(const LedgerEntry& entry) {
+    MemoryScope scope(MemoryTag::Fines);
+    std::lock_guard<std::mutex> lock(mutex);
+
+    bool credit = (entry.type == LedgerEntryType::Payment || entry.type == LedgerEntryType::Waiver);
+    balances[entry.userId] += credit ? -entry.amount : entry.amount;
+
+    userEntries[entry.userId].push_back(entries.size());
+    entries.push_back(entry);
+}
+
+double FineLedger::getBalance(const std::string& userId) const {
+    std::lock_guard<std::mutex> lock(mutex);
+
+    auto it = balances.find(userId);
+    if (it == balances.end()) {
+        return 0.0;
+    }
+    return it->second;
+}
+
+std::vector<LedgerEntry> FineLedger::getUserEntries(const std::string& userId) const {
+    std::lock_guard<std::mutex> lock(mutex);
+
+    std::vector<LedgerEntry> result;
+    auto it = userEntries.find(userId);
+    if (it != userEntries.end()) {
+        for (size_t index : it->second) {
+            result.push_back(entries[index]);
+        }
+    }
+    return result;
+}
+
+std::vector<LedgerEntry> FineLedger::getEntries() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return entries;
+}
+
+std::vector<LedgerEntry> FineLedger::getEntriesSince(size_t first) const {
+    std::lock_guard<std::mutex> lock(mutex);
+    if (first >= entries.size()) {
+        return std::vector<LedgerEntry>();
+    }
+    return std::vector<LedgerEntry>(entries.begin() + first, entries.end());
+}
+
+size_t FineLedger::getEntryCount() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return entries.size();
+}
+
+void FineLedger::clear() {
+    std::lock_guard<std::mutex> lock(mutex);
+
+    entries.clear();
+    balances.clear();
+    userEntries.clear();
+}
+
+std::string FineLedger::typeToString(LedgerEntryType type) {
+    switch (type) {
+        case LedgerEntryType::Accrual:
+            return "Accrual";
+        case LedgerEntryType::Assessment:
+            return "Assessment";
+        case LedgerEntryType::Payment:
+            return "Payment";
+        case LedgerEntryType::Waiver:
+            return "Waiver";
+    }
+    return "Unknown";
+}
+
+LedgerEntryType FineLedger::typeFromString(const std::string& name) {
+    if (name == "Accrual") {
+        return LedgerEntryType::Accrual;
+    }
+    if (name == "Assessment") {
+        return LedgerEntryType::Assessment;
+    }
+    if (name == "Payment") {
+        return LedgerEntryType::Payment;
+    }
+    if (name == "Waiver") {
+        return LedgerEntryType::Waiver;
+    }
+    throw InvalidOperationException("Unknown ledger entry type: " + name);
+}
@@ -0,0 +1,477 @@
+#include "../include/FullTextIndex.h"
+#include "../include/Book.h"
+#include "../include/Magazine.h"
+#include "../include/Journal.h"
+#include "../include/Exceptions.h"
+#include <algorithm>
+#include <fstream>
+#include <mutex>
+#include <cmath>
+#include <cctype>
+#include <limits>
+
+namespace {
+
+const double K1 = 1.2;
+const double B = 0.75;
+
+// Keeps an upper bound above any score it covers despite rounding
+const double BOUND_SLACK = 1e-9;
+
+const char INDEX_MAGIC[8] = {'L', 'M', 'S', 'F', 'T', 'S', '1', '\0'};
+
+template <typename T>
+void writeValue(std::ofstream& file, const T& value) {
+    file.write(reinterpret_cast<const char*>(&value), sizeof(value));
+}
+
+template <typename T>
+void readValue(std::ifstream& file, T& value) {
+    file.read(reinterpret_cast<char*>(&value), sizeof(value));
+}
+
+void writeString(std::ofstream& file, const std::string& text) {
+    writeValue(file, static_cast<uint32_t>(text.size()));
+    file.write(text.data(), text.size());
+}
+
+bool readString(std::ifstream& file, std::string& text) {
+    uint32_t length = 0;
+    readValue(file, length);
+    if (!file) {
+        return false;
+    }
+    text.resize(length);
+    file.read(&text[0], length);
+    return static_cast<bool>(file);
+}
+
+} // namespace
+
+const uint32_t FullTextIndex::SKIP_INTERVAL;
+
+// Walks one posting list in document order
+class FullTextIndex::Cursor {
+private:
+    const PostingList* list;
+    size_t offset;
+    uint32_t decoded; // Postings read so far
+
+    uint32_t readVarint() {
+        uint32_t value = 0;
+        int shift = 0;
+        uint8_t byte;
+        do {
+            byte = list->bytes[offset++];
+            value |= static_cast<uint32_t>(byte & 0x7F) << shift;
+            shift += 7;
+        } while (byte & 0x80);
+        return value;
+    }
+
+public:
+    uint32_t doc;
+    uint32_t tf;
+    bool done;
+    double idf;
+    double bound; // Largest score this term can add to any document
+    size_t term;  // Position of the term in sorted query order
+
+    Cursor(const PostingList& postingList, size_t termOrder)
+        : list(&postingList), offset(0), decoded(0), doc(0), tf(0), done(false), idf(0), bound(0),
+          term(termOrder) {
+        next();
+    }
+
+    void next() {
+        if (decoded == list->count) {
+            done = true;
+            return;
+        }
+        doc = (decoded == 0 ? 0 : doc) + readVarint();
+        tf = readVarint();
+        decoded++;
+    }
+
+    // Move to the first posting at or after 'target'
+    void seek(uint32_t target) {
+        if (done || doc >= target) {
+            return;
+        }
+
+        // Every posting before a block is at most its baseDoc, so the last
+        // block whose baseDoc is below the target can be entered directly
+        auto it = std::lower_bound(list->skips.begin(), list->skips.end(), target,
+                                   [](const SkipEntry& skip, uint32_t value) {
+                                       return skip.baseDoc < value;
+                                   });
+        if (it != list->skips.begin()) {
+            --it;
+            if (it->index > decoded) {
+                offset = it->offset;
+                decoded = it->index;
+                doc = it->baseDoc;
+                next();
+            }
+        }
+        while (!done && doc < target) {
+            next();
+        }
+    }
+};
+
+void FullTextIndex::appendVarint(std::vector<uint8_t>& bytes, uint32_t value) {
+    while (value >= 0x80) {
+        bytes.push_back(static_cast<uint8_t>(value | 0x80));
+        value >>= 7;
+    }
+    bytes.push_back(static_cast<uint8_t>(value));
+}
+
+std::vector<std::string> FullTextIndex::tokenize(const std::string& text) {
+    std::vector<std::string> words;
+    std::string word;
+    for (char c : text) {
+        unsigned char byte = static_cast<unsigned char>(c);
+        if (std::isalnum(byte) || byte >= 0x80) {
+            word += static_cast<char>(std::tolower(byte));
+        } else if (!word.empty()) {
+            words.push_back(word);
+            word.clear();
+        }
+    }
+    if (!word.empty()) {
+        words.push_back(word);
+    }
+    return words;
+}
+
+std::vector<std::string> FullTextIndex::documentText(const LibraryItem& item) {
+    std::vector<std::string> fields;
+    fields.push_back(item.getTitle());
+    fields.push_back(item.getPublisher());
+
+    if (auto book = dynamic_cast<const Book*>(&item)) {
+        fields.push_back(book->getAuthor());
+        fields.push_back(book->getGenre());
+    } else if (auto journal = dynamic_cast<const Journal*>(&item)) {
+        fields.push_back(journal->getEditor());
+        fields.push_back(journal->getResearchField());
+    } else if (auto magazine = dynamic_cast<const Magazine*>(&item)) {
+        fields.push_back(magazine->getMonth());
+        fields.push_back(magazine->getCategory());
+    }
+    return fields;
+}
+
+double FullTextIndex::averageLength() const {
+    if (itemIds.empty() || totalLength == 0) {
+        return 1.0;
+    }
+    return static_cast<double>(totalLength) / itemIds.size();
+}
+
+double FullTextIndex::idf(const PostingList& list) const {
+    double documents = static_cast<double>(itemIds.size());
+    return std::log(1.0 + (documents - list.count + 0.5) / (list.count + 0.5));
+}
+
+double FullTextIndex::termScore(double termIdf, uint32_t tf, uint32_t length) const {
+    double norm = K1 * (1.0 - B + B * length / averageLength());
+    return termIdf * tf * (K1 + 1.0) / (tf + norm);
+}
+
+// ==================== Maintenance ====================
+
+void FullTextIndex::add(const LibraryItem& item) {
+    std::unordered_map<std::string, uint32_t> counts;
+    uint32_t length = 0;
+    for (const std::string& field : documentText(item)) {
+        for (const std::string& word : tokenize(field)) {
+            counts[word]++;
+            length++;
+        }
+    }
+
+    std::unique_lock<std::shared_timed_mutex> lock(indexMutex);
+    uint32_t doc = static_cast<uint32_t>(itemIds.size());
+    itemIds.push_back(item.getItemId());
+    docLengths.push_back(length);
+    totalLength += length;
+    minLength = doc == 0 ? length : std::min(minLength, length);
+
+    for (const auto& pair : counts) {
+        PostingList& list = postings[pair.first];
+        if (list.count > 0 && list.count % SKIP_INTERVAL == 0) {
+            list.skips.push_back(SkipEntry{list.lastDoc, static_cast<uint32_t>(list.bytes.size()),
+                                           list.count});
+        }
+        appendVarint(list.bytes, list.count == 0 ? doc : doc - list.lastDoc);
+        appendVarint(list.bytes, pair.second);
+        list.count++;
+        list.lastDoc = doc;
+        list.maxTf = std::max(list.maxTf, pair.second);
+    }
+}
+
+void FullTextIndex::clear() {
+    std::unique_lock<std::shared_timed_mutex> lock(indexMutex);
+    itemIds.clear();
+    docLengths.clear();
+    totalLength = 0;
+    minLength = 0;
+    postings.clear();
+}
+
+size_t FullTextIndex::size() const {
+    std::shared_lock<std::shared_timed_mutex> lock(indexMutex);
+    return itemIds.size();
+}
+
+// ==================== Queries ====================
+
+std::vector<TextMatch> FullTextIndex::search(const std::string& query, size_t limit) const {
+    std::vector<std::string> words = tokenize(query);
+    std::sort(words.begin(), words.end());
+    words.erase(std::unique(words.begin(), words.end()), words.end());
+
+    std::shared_lock<std::shared_timed_mutex> lock(indexMutex);
+
+    std::vector<Cursor> cursors;
+    for (const std::string& word : words) {
+        auto it = postings.find(word);
+        if (it == postings.end()) {
+            continue;
+        }
+        cursors.emplace_back(it->second, cursors.size());
+        Cursor& cursor = cursors.back();
+        cursor.idf = idf(it->second);
+        // Frequency raises a term's score and length lowers it
+        cursor.bound = termScore(cursor.idf, it->second.maxTf, minLength) * (1.0 + BOUND_SLACK);
+    }
+    if (cursors.empty()) {
+        return std::vector<TextMatch>();
+    }
+
+    // upTo[i] bounds the combined score of the i weakest terms
+    std::sort(cursors.begin(), cursors.end(),
+              [](const Cursor& a, const Cursor& b) { return a.bound < b.bound; });
+    std::vector<double> upTo(cursors.size() + 1, 0.0);
+    for (size_t i = 0; i < cursors.size(); i++) {
+        upTo[i + 1] = upTo[i] + cursors[i].bound;
+    }
+
+    // Heap of the best k so far with the weakest on top
+    typedef std::pair<double, uint32_t> Hit;
+    auto better = [this](const Hit& a, const Hit& b) {
+        if (a.first != b.first) {
+            return a.first > b.first;
+        }
+        return itemIds[a.second] < itemIds[b.second];
+    };
+    size_t k = limit == 0 ? itemIds.size() : limit;
+    std::vector<Hit> heap;
+    double threshold = 0.0;
+
+    // Each term's contribution to the current document. Floating-point
+    // addition is not associative, so the final score adds them up in
+    // query term order, whichever terms proposed the document; otherwise
+    // equal scores could differ in the last bit and break the ID ties.
+    std::vector<double> parts(cursors.size());
+
+    // Terms below 'essential' cannot lift a document to the threshold on
+    // their own, so only the others propose candidates
+    size_t essential = 0;
+    while (essential < cursors.size()) {
+        uint32_t doc = std::numeric_limits<uint32_t>::max();
+        for (size_t i = essential; i < cursors.size(); i++) {
+            if (!cursors[i].done) {
+                doc = std::min(doc, cursors[i].doc);
+            }
+        }
+        if (doc == std::numeric_limits<uint32_t>::max()) {
+            break;
+        }
+
+        uint32_t length = docLengths[doc];
+        std::fill(parts.begin(), parts.end(), 0.0);
+        double score = 0.0;
+        for (size_t i = essential; i < cursors.size(); i++) {
+            if (!cursors[i].done && cursors[i].doc == doc) {
+                double part = termScore(cursors[i].idf, cursors[i].tf, length);
+                parts[cursors[i].term] = part;
+                score += part;
+                cursors[i].next();
+            }
+        }
+
+        // Strongest remaining terms first, giving up once even all of
+        // them together would fall short
+        bool pruned = false;
+        for (size_t i = essential; i-- > 0;) {
+            if (score + upTo[i + 1] < threshold) {
+                pruned = true;
+                break;
+            }
+            cursors[i].seek(doc);
+            if (!cursors[i].done && cursors[i].doc == doc) {
+                double part = termScore(cursors[i].idf, cursors[i].tf, length);
+                parts[cursors[i].term] = part;
+                score += part;
+            }
+        }
+        if (pruned) {
+            continue;
+        }
+        score = 0.0;
+        for (double part : parts) {
+            score += part;
+        }
+
+        Hit hit(score, doc);
+        if (heap.size() < k) {
+            heap.push_back(hit);
+            std::push_heap(heap.begin(), heap.end(), better);
+        } else if (better(hit, heap.front())) {
+            std::pop_heap(heap.begin(), heap.end(), better);
+            heap.back() = hit;
+            std::push_heap(heap.begin(), heap.end(), better);
+        } else {
+            continue;
+        }
+
+        if (heap.size() == k) {
+            threshold = heap.front().first;
+            while (essential < cursors.size() && upTo[essential + 1] < threshold) {
+                essential++;
+            }
+        }
+    }
+
+    std::sort(heap.begin(), heap.end(), better);
+    std::vector<TextMatch> matches;
+    matches.reserve(heap.size());
+    for (const Hit& hit : heap) {
+        matches.push_back(TextMatch{itemIds[hit.second], hit.first});
+    }
+    return matches;
+}
+
+// ==================== Persistence ====================
+
+void FullTextIndex::save(const std::string& filename, unsigned long long sequence) const {
+    std::shared_lock<std::shared_timed_mutex> lock(indexMutex);
+    std::ofstream file(filename, std::ios::binary | std::ios::trunc);
+    if (!file.is_open()) {
+        throw FileIOException(filename);
+    }
+
+    // Native byte order: the file only ever travels with its snapshot
+    file.write(INDEX_MAGIC, sizeof(INDEX_MAGIC));
+    writeValue(file, static_cast<uint64_t>(sequence));
+    writeValue(file, static_cast<uint64_t>(itemIds.size()));
+    writeValue(file, totalLength);
+    writeValue(file, minLength);
+    for (size_t doc = 0; doc < itemIds.size(); doc++) {
+        writeString(file, itemIds[doc]);
+        writeValue(file, docLengths[doc]);
+    }
+
+    writeValue(file, static_cast<uint64_t>(postings.size()));
+    for (const auto& pair : postings) {
+        const PostingList& list = pair.second;
+        writeString(file, pair.first);
+        writeValue(file, list.count);
+        writeValue(file, list.lastDoc);
+        writeValue(file, list.maxTf);
+        writeValue(file, static_cast<uint32_t>(list.bytes.size()));
+        file.write(reinterpret_cast<const char*>(list.bytes.data()), list.bytes.size());
+        writeValue(file, static_cast<uint32_t>(list.skips.size()));
+        for (const SkipEntry& skip : list.skips) {
+            writeValue(file, skip.baseDoc);
+            writeValue(file, skip.offset);
+            writeValue(file, skip.index);
+        }
+    }
+
+    if (!file.good()) {
+        throw FileIOException(filename);
+    }
+}
+
+bool FullTextIndex::load(const std::string& filename, unsigned long long sequence, size_t documents) {
+    clear();
+    std::ifstream file(filename, std::ios::binary);
+    if (!file.is_open()) {
+        return false;
+    }
+
+    FullTextIndex loaded;
+    try {
+        char magic[sizeof(INDEX_MAGIC)];
+        uint64_t savedSequence = 0;
+        uint64_t savedDocuments = 0;
+        file.read(magic, sizeof(magic));
+        readValue(file, savedSequence);
+        readValue(file, savedDocuments);
+        if (!file || !std::equal(magic, magic + sizeof(magic), INDEX_MAGIC) ||
+            savedSequence != sequence || savedDocuments != documents) {
+            return false;
+        }
+
+        readValue(file, loaded.totalLength);
+        readValue(file, loaded.minLength);
+        loaded.itemIds.resize(documents);
+        loaded.docLengths.resize(documents);
+        for (size_t doc = 0; doc < documents; doc++) {
+            if (!readString(file, loaded.itemIds[doc])) {
+                return false;
+            }
+            readValue(file, loaded.docLengths[doc]);
+        }
+
+        uint64_t terms = 0;
+        readValue(file, terms);
+        for (uint64_t t = 0; t < terms && file; t++) {
+            std::string term;
+            if (!readString(file, term)) {
+                return false;
+            }
+            PostingList& list = loaded.postings[term];
+            uint32_t byteCount = 0;
+            uint32_t skipCount = 0;
+            readValue(file, list.count);
+            readValue(file, list.lastDoc);
+            readValue(file, list.maxTf);
+            readValue(file, byteCount);
+            if (!file) {
+                return false;
+            }
+            list.bytes.resize(byteCount);
+            file.read(reinterpret_cast<char*>(list.bytes.data()), byteCount);
+            readValue(file, skipCount);
+            if (!file) {
+                return false;
+            }
+            list.skips.resize(skipCount);
+            for (SkipEntry& skip : list.skips) {
+                readValue(file, skip.baseDoc);
+                readValue(file, skip.offset);
+                readValue(file, skip.index);
+            }
+        }
+        if (!file) {
+            return false;
+        }
+    } catch (const std::exception&) {
+        return false; // Lengths from a damaged file
+    }
+
+    std::unique_lock<std::shared_timed_mutex> lock(indexMutex);
+    itemIds.swap(loaded.itemIds);
+    docLengths.swap(loaded.docLengths);
+    totalLength = loaded.totalLength;
+    minLength = loaded.minLength;
+    postings.swap(loaded.postings);
+    return true;
+}
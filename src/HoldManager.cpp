@@ -0,0 +1,233 @@
+#include "../include/HoldManager.h"
+#include "../include/Exceptions.h"
+#include "../include/MemoryAccounting.h"
+#include <algorithm>
+
+// ==================== Waiting List ====================
+
+void HoldManager::placeHold(const std::string& itemId, const std::string& userId,
+                            HoldPriority priority) {
+    std::lock_guard<std::mutex> lock(mutex);
+    MemoryScope scope(MemoryTag::Holds);
+
+    if (ready.find(HoldKey(itemId, userId)) != ready.end()) {
+        throw InvalidOperationException("A copy is already waiting for pickup: " + itemId);
+    }
+    queues[itemId].enqueue(userId, priority);
+    userHolds[userId].insert(itemId);
+}
+
+bool HoldManager::cancelWaiting(const std::string& itemId, const std::string& userId) {
+    std::lock_guard<std::mutex> lock(mutex);
+
+    auto it = queues.find(itemId);
+    if (it == queues.end() || !it->second.cancel(userId)) {
+        return false;
+    }
+
+    if (it->second.empty()) {
+        queues.erase(it);
+    }
+    userHolds[userId].erase(itemId);
+    return true;
+}
+
+std::string HoldManager::popNextWaiting(const std::string& itemId) {
+    std::lock_guard<std::mutex> lock(mutex);
+
+    auto it = queues.find(itemId);
+    if (it == queues.end()) {
+        return "";
+    }
+
+    std::string userId = it->second.popNext();
+    if (it->second.empty()) {
+        queues.erase(it);
+    }
+    // The user keeps the item in userHolds until the ready hold is picked up
+    return userId;
+}
+
+bool HoldManager::hasWaiting(const std::string& itemId) const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return queues.find(itemId) != queues.end();
+}
+
+int HoldManager::getQueuePosition(const std::string& itemId, const std::string& userId) const {
+    std::lock_guard<std::mutex> lock(mutex);
+
+    auto it = queues.find(itemId);
+    if (it == queues.end()) {
+        return 0;
+    }
+    return it->second.positionOf(userId);
+}
+
+int HoldManager::getQueueLength(const std::string& itemId) const {
+    std::lock_guard<std::mutex> lock(mutex);
+
+    auto it = queues.find(itemId);
+    if (it == queues.end()) {
+        return 0;
+    }
+    return it->second.size();
+}
+
+// ==================== Pickup Shelf ====================
+
+void HoldManager::markReady(const std::string& itemId, const std::string& userId,
+                            const std::string& barcode, time_t now) {
+    restoreReady(ReadyHold{itemId, userId, barcode, now + PICKUP_DAYS * 24 * 60 * 60});
+}
+
+void HoldManager::restoreReady(const ReadyHold& hold) {
+    std::lock_guard<std::mutex> lock(mutex);
+    MemoryScope scope(MemoryTag::Holds);
+
+    HoldKey key(hold.itemId, hold.userId);
+    ready[key] = hold;
+    userHolds[hold.userId].insert(hold.itemId);
+    expiries.push(ExpiryEntry(hold.expiresAt, key));
+}
+
+bool HoldManager::findReady(const std::string& itemId, const std::string& userId,
+                            ReadyHold& hold) const {
+    std::lock_guard<std::mutex> lock(mutex);
+
+    auto it = ready.find(HoldKey(itemId, userId));
+    if (it == ready.end()) {
+        return false;
+    }
+    hold = it->second;
+    return true;
+}
+
+ReadyHold HoldManager::takeReady(const std::string& itemId, const std::string& userId) {
+    std::lock_guard<std::mutex> lock(mutex);
+
+    auto it = ready.find(HoldKey(itemId, userId));
+    if (it == ready.end()) {
+        throw InvalidOperationException("No hold ready for pickup: " + itemId);
+    }
+
+    ReadyHold hold = it->second;
+    ready.erase(it);
+    userHolds[userId].erase(itemId);
+    // The matching expiry entry is discarded lazily by takeEarliestExpired()
+    return hold;
+}
+
+bool HoldManager::takeEarliestExpired(time_t now, ReadyHold& hold) {
+    std::lock_guard<std::mutex> lock(mutex);
+
+    while (!expiries.empty() && expiries.top().first <= now) {
+        ExpiryEntry entry = expiries.top();
+        expiries.pop();
+
+        // Skip entries whose hold was picked up, cancelled or re-readied since
+        auto it = ready.find(entry.second);
+        if (it == ready.end() || it->second.expiresAt != entry.first) {
+            continue;
+        }
+
+        hold = it->second;
+        userHolds[hold.userId].erase(hold.itemId);
+        ready.erase(it);
+        return true;
+    }
+    return false;
+}
+
+bool HoldManager::takeEarliestExpired(const std::string& itemId, time_t now, ReadyHold& hold) {
+    std::lock_guard<std::mutex> lock(mutex);
+
+    // Ready holds are keyed (itemId, userId), so one item's holds are contiguous
+    auto earliest = ready.end();
+    for (auto it = ready.lower_bound(HoldKey(itemId, ""));
+         it != ready.end() && it->first.first == itemId; ++it) {
+        if (it->second.expiresAt <= now &&
+            (earliest == ready.end() || it->second.expiresAt < earliest->second.expiresAt)) {
+            earliest = it;
+        }
+    }
+    if (earliest == ready.end()) {
+        return false;
+    }
+
+    // The heap entry is discarded lazily by the global variant
+    hold = earliest->second;
+    userHolds[hold.userId].erase(itemId);
+    ready.erase(earliest);
+    return true;
+}
+
+std::vector<std::string> HoldManager::getUserHolds(const std::string& userId) const {
+    std::lock_guard<std::mutex> lock(mutex);
+
+    auto it = userHolds.find(userId);
+    if (it == userHolds.end()) {
+        return std::vector<std::string>();
+    }
+    return std::vector<std::string>(it->second.begin(), it->second.end());
+}
+
+// ==================== Snapshot Support ====================
+
+std::vector<std::pair<std::string, std::string>> HoldManager::getWaitingEntries() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    std::vector<std::pair<std::string, std::string>> result;
+
+    for (const auto& pair : queues) {
+        for (const auto& userId : pair.second.entries()) {
+            result.push_back(std::make_pair(pair.first, userId));
+        }
+    }
+
+    // Group by item so snapshots do not depend on hash order; stable keeps
+    // each item's service order
+    std::stable_sort(result.begin(), result.end(),
+                     [](const std::pair<std::string, std::string>& a,
+                        const std::pair<std::string, std::string>& b) {
+                         return a.first < b.first;
+                     });
+    return result;
+}
+
+std::vector<ReadyHold> HoldManager::getReadyHolds() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    std::vector<ReadyHold> result;
+
+    for (const auto& pair : ready) {
+        result.push_back(pair.second);
+    }
+    return result;
+}
+
+size_t HoldManager::getHoldCount() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    size_t count = ready.size();
+    for (const auto& pair : queues) {
+        count += pair.second.size();
+    }
+    return count;
+}
+
+std::vector<ReadyHold> HoldManager::getReadyHolds(const std::string& itemId) const {
+    std::lock_guard<std::mutex> lock(mutex);
+    std::vector<ReadyHold> result;
+
+    for (auto it = ready.lower_bound(HoldKey(itemId, ""));
+         it != ready.end() && it->first.first == itemId; ++it) {
+        result.push_back(it->second);
+    }
+    return result;
+}
+
+void HoldManager::clear() {
+    std::lock_guard<std::mutex> lock(mutex);
+
+    queues.clear();
+    ready.clear();
+    userHolds.clear();
+    expiries = decltype(expiries)();
+}
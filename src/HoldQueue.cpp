@@ -0,0 +1,133 @@
+#include "../include/HoldQueue.h"
+#include "../include/Exceptions.h"
+
+HoldPriority holdPriorityForRole(const std::string& role) {
+    if (role == "Faculty") {
+        return HoldPriority::Faculty;
+    }
+    if (role == "Librarian") {
+        return HoldPriority::Librarian;
+    }
+    return HoldPriority::Student;
+}
+
+// ==================== Level ====================
+
+void ItemHoldQueue::Level::append(const std::string& userId) {
+    users.push_back(userId);
+
+    // Node i covers (i - lowbit(i), i]; all of it is already known except the new entry
+    size_t i = users.size();
+    size_t lowbit = i & (~i + 1);
+    tree.push_back(prefix(i - 1) - prefix(i - lowbit) + 1);
+    live++;
+}
+
+void ItemHoldQueue::Level::remove(size_t index) {
+    for (size_t i = index + 1; i <= tree.size(); i += i & (~i + 1)) {
+        tree[i - 1]--;
+    }
+    live--;
+}
+
+int ItemHoldQueue::Level::prefix(size_t count) const {
+    int sum = 0;
+    for (size_t i = count; i > 0; i -= i & (~i + 1)) {
+        sum += tree[i - 1];
+    }
+    return sum;
+}
+
+void ItemHoldQueue::Level::reset() {
+    users.clear();
+    tree.clear();
+    head = 0;
+    live = 0;
+}
+
+// ==================== ItemHoldQueue ====================
+
+void ItemHoldQueue::enqueue(const std::string& userId, HoldPriority priority) {
+    if (contains(userId)) {
+        throw InvalidOperationException("User already has a hold on this item: " + userId);
+    }
+
+    int level = static_cast<int>(priority);
+    positions[userId] = std::make_pair(level, levels[level].users.size());
+    levels[level].append(userId);
+}
+
+bool ItemHoldQueue::cancel(const std::string& userId) {
+    auto it = positions.find(userId);
+    if (it == positions.end()) {
+        return false;
+    }
+
+    Level& level = levels[it->second.first];
+    level.remove(it->second.second);
+    level.users[it->second.second].clear(); // Tombstone, skipped by popNext()
+    positions.erase(it);
+
+    if (level.live == 0) {
+        level.reset();
+    }
+    return true;
+}
+
+std::string ItemHoldQueue::popNext() {
+    for (Level& level : levels) {
+        if (level.live == 0) {
+            continue;
+        }
+
+        // Skip cancelled entries; each is skipped at most once
+        while (level.users[level.head].empty()) {
+            level.head++;
+        }
+
+        // Popped entries stay counted in the tree; positionOf() subtracts
+        // everything before the head cursor instead
+        std::string userId = level.users[level.head];
+        level.head++;
+        level.live--;
+        positions.erase(userId);
+
+        if (level.live == 0) {
+            level.reset();
+        }
+        return userId;
+    }
+    return "";
+}
+
+bool ItemHoldQueue::contains(const std::string& userId) const {
+    return positions.find(userId) != positions.end();
+}
+
+int ItemHoldQueue::positionOf(const std::string& userId) const {
+    auto it = positions.find(userId);
+    if (it == positions.end()) {
+        return 0;
+    }
+
+    int position = 0;
+    for (int l = 0; l < it->second.first; l++) {
+        position += levels[l].live;
+    }
+
+    const Level& level = levels[it->second.first];
+    position += level.prefix(it->second.second + 1) - level.prefix(level.head);
+    return position;
+}
+
+std::vector<std::string> ItemHoldQueue::entries() const {
+    std::vector<std::string> result;
+    for (const Level& level : levels) {
+        for (size_t i = level.head; i < level.users.size(); i++) {
+            if (!level.users[i].empty()) {
+                result.push_back(level.users[i]);
+            }
+        }
+    }
+    return result;
+}
@@ -0,0 +1,92 @@
+#include "../include/Holdings.h"
+#include "../include/Exceptions.h"
+#include <algorithm>
+
+Holdings::Holdings() : availableCopies(0) {}
+
+int Holdings::addCopy(const std::string& barcode) {
+    if (barcodeIndex.find(barcode) != barcodeIndex.end()) {
+        throw InvalidOperationException("Barcode already exists: " + barcode);
+    }
+
+    int index = static_cast<int>(copies.size());
+    copies.push_back(ItemCopy{barcode, CopyState::Available, ""});
+    barcodeIndex[barcode] = index;
+    freeCopies.push_back(index);
+    availableCopies.fetch_add(1, std::memory_order_release);
+    return index;
+}
+
+int Holdings::checkoutAny(const std::string& userId) {
+    if (freeCopies.empty()) {
+        return -1;
+    }
+
+    int index = freeCopies.back();
+    freeCopies.pop_back();
+
+    copies[index].state = CopyState::OnLoan;
+    copies[index].borrower = userId;
+    availableCopies.fetch_sub(1, std::memory_order_release);
+    return index;
+}
+
+void Holdings::checkin(int copyIndex) {
+    if (copyIndex < 0 || copyIndex >= getTotalCopies() ||
+        copies[copyIndex].state != CopyState::OnLoan) {
+        throw InvalidOperationException("Copy is not currently on loan");
+    }
+
+    copies[copyIndex].state = CopyState::Available;
+    copies[copyIndex].borrower = "";
+    freeCopies.push_back(copyIndex);
+    availableCopies.fetch_add(1, std::memory_order_release);
+}
+
+int Holdings::reserveAny(const std::string& userId) {
+    int index = checkoutAny(userId);
+    if (index >= 0) {
+        copies[index].state = CopyState::OnHoldShelf;
+    }
+    return index;
+}
+
+void Holdings::lendReserved(int copyIndex, const std::string& userId) {
+    if (copyIndex < 0 || copyIndex >= getTotalCopies() ||
+        copies[copyIndex].state != CopyState::OnHoldShelf ||
+        copies[copyIndex].borrower != userId) {
+        throw InvalidOperationException("Copy is not on the hold shelf for user: " + userId);
+    }
+    copies[copyIndex].state = CopyState::OnLoan;
+}
+
+void Holdings::releaseReserved(int copyIndex) {
+    if (copyIndex < 0 || copyIndex >= getTotalCopies() ||
+        copies[copyIndex].state != CopyState::OnHoldShelf) {
+        throw InvalidOperationException("Copy is not on the hold shelf");
+    }
+    copies[copyIndex].state = CopyState::Available;
+    copies[copyIndex].borrower = "";
+    freeCopies.push_back(copyIndex);
+    availableCopies.fetch_add(1, std::memory_order_release);
+}
+
+void Holdings::restoreCopy(int copyIndex, CopyState state, const std::string& userId) {
+    auto it = std::find(freeCopies.begin(), freeCopies.end(), copyIndex);
+    if (it == freeCopies.end()) {
+        throw InvalidOperationException("Copy is not available to restore");
+    }
+
+    freeCopies.erase(it);
+    copies[copyIndex].state = state;
+    copies[copyIndex].borrower = userId;
+    availableCopies.fetch_sub(1, std::memory_order_release);
+}
+
+int Holdings::findCopy(const std::string& barcode) const {
+    auto it = barcodeIndex.find(barcode);
+    if (it == barcodeIndex.end()) {
+        return -1;
+    }
+    return it->second;
+}
@@ -0,0 +1,197 @@
+#include "../include/ItemStore.h"
+#include "../include/Exceptions.h"
+#include <mutex>
+
+ItemStore::ItemStore() : hand(0), capacity(0), loads(0), evictions(0) {}
+
+void ItemStore::adoptMapping(std::unique_ptr<MappedFile> file) {
+    std::unique_lock<std::shared_timed_mutex> lock(mutex);
+    mapping = std::move(file);
+}
+
+void ItemStore::add(const std::shared_ptr<LibraryItem>& item) {
+    std::unique_lock<std::shared_timed_mutex> lock(mutex);
+    Entry& entry = entries[item->getItemId()];
+    entry.item = item;
+    entry.record = nullptr;
+    entry.length = 0;
+    entry.type = item->getItemType();
+    entry.restored.clear();
+    entry.pinned = true;
+}
+
+void ItemStore::addLazy(const std::string& itemId, const char* record, size_t length,
+                        const std::string& type, int totalCopies) {
+    std::unique_lock<std::shared_timed_mutex> lock(mutex);
+    // Snapshots list items in ID order, so this is normally an append
+    auto it = entries.emplace_hint(entries.end(), std::piecewise_construct,
+                                   std::forward_as_tuple(itemId), std::forward_as_tuple());
+    Entry& entry = it->second;
+    entry.item.reset();
+    entry.record = record;
+    entry.length = length;
+    entry.type = type;
+    entry.availableCopies = totalCopies;
+    entry.restored.clear();
+    entry.pinned = false;
+}
+
+std::shared_ptr<LibraryItem> ItemStore::find(const std::string& itemId) {
+    EntryMap::iterator it;
+    {
+        std::shared_lock<std::shared_timed_mutex> lock(mutex);
+        it = entries.find(itemId);
+        if (it == entries.end()) {
+            return nullptr;
+        }
+    }
+    return resident(it);
+}
+
+bool ItemStore::contains(const std::string& itemId) const {
+    std::shared_lock<std::shared_timed_mutex> lock(mutex);
+    return entries.find(itemId) != entries.end();
+}
+
+std::shared_ptr<LibraryItem> ItemStore::resident(EntryMap::iterator it) {
+    Entry& entry = it->second;
+    {
+        std::shared_lock<std::shared_timed_mutex> lock(mutex);
+        if (entry.item) {
+            entry.referenced.store(true, std::memory_order_relaxed);
+            return entry.item;
+        }
+    }
+
+    std::unique_lock<std::shared_timed_mutex> lock(mutex);
+    if (!entry.item) {
+        entry.item = build(entry);
+        loads++;
+        entry.referenced.store(true, std::memory_order_relaxed);
+        clock.push_back(it);
+    }
+    std::shared_ptr<LibraryItem> item = entry.item;
+    if (capacity > 0 && clock.size() > capacity) {
+        evict();
+    }
+    return item;
+}
+
+std::shared_ptr<LibraryItem> ItemStore::decode(EntryMap::const_iterator it) const {
+    const Entry& entry = it->second;
+    std::shared_lock<std::shared_timed_mutex> lock(mutex);
+    if (entry.item) {
+        return entry.item;
+    }
+    return build(entry);
+}
+
+std::shared_ptr<LibraryItem> ItemStore::build(const Entry& entry) const {
+    std::shared_ptr<LibraryItem> item = loader(entry.record, entry.length);
+    for (const RestoredCopy& copy : entry.restored) {
+        item->restoreCopy(copy.barcode, copy.state, copy.userId);
+    }
+    return item;
+}
+
+std::vector<ItemStore::EntryMap::iterator> ItemStore::listEntries() {
+    // Map iterators survive inserts, and entries are only erased by clear()
+    std::shared_lock<std::shared_timed_mutex> lock(mutex);
+    std::vector<EntryMap::iterator> list;
+    list.reserve(entries.size());
+    for (auto it = entries.begin(); it != entries.end(); ++it) {
+        list.push_back(it);
+    }
+    return list;
+}
+
+std::vector<ItemStore::EntryMap::const_iterator> ItemStore::listEntries() const {
+    std::shared_lock<std::shared_timed_mutex> lock(mutex);
+    std::vector<EntryMap::const_iterator> list;
+    list.reserve(entries.size());
+    for (auto it = entries.begin(); it != entries.end(); ++it) {
+        list.push_back(it);
+    }
+    return list;
+}
+
+void ItemStore::evict() {
+    // Each entry is visited at most twice: once to clear its bit, once to go
+    size_t budget = 2 * clock.size();
+    while (clock.size() > capacity && budget-- > 0) {
+        if (hand >= clock.size()) {
+            hand = 0;
+        }
+        Entry& entry = clock[hand]->second;
+        bool drop = entry.pinned || !entry.item;
+        if (!drop) {
+            if (entry.referenced.exchange(false, std::memory_order_relaxed) ||
+                entry.item.use_count() > 1) {
+                hand++;
+                continue;
+            }
+            entry.item.reset();
+            evictions++;
+        }
+        clock[hand] = clock.back();
+        clock.pop_back();
+    }
+}
+
+void ItemStore::pin(const std::string& itemId) {
+    {
+        std::shared_lock<std::shared_timed_mutex> lock(mutex);
+        auto it = entries.find(itemId);
+        if (it == entries.end()) {
+            throw ItemNotFoundException(itemId);
+        }
+        if (it->second.pinned) {
+            return;
+        }
+    }
+    std::shared_ptr<LibraryItem> item = find(itemId);
+    std::unique_lock<std::shared_timed_mutex> lock(mutex);
+    entries.find(itemId)->second.pinned = true;
+}
+
+void ItemStore::restoreCopy(const std::string& itemId, const std::string& barcode,
+                            CopyState state, const std::string& userId) {
+    std::unique_lock<std::shared_timed_mutex> lock(mutex);
+    auto it = entries.find(itemId);
+    if (it == entries.end()) {
+        throw ItemNotFoundException(itemId);
+    }
+    Entry& entry = it->second;
+    if (entry.item) {
+        entry.item->restoreCopy(barcode, state, userId);
+    } else {
+        entry.availableCopies--;
+        entry.restored.push_back(RestoredCopy{barcode, state, userId});
+    }
+}
+
+size_t ItemStore::size() const {
+    std::shared_lock<std::shared_timed_mutex> lock(mutex);
+    return entries.size();
+}
+
+size_t ItemStore::getResidentCount() const {
+    std::shared_lock<std::shared_timed_mutex> lock(mutex);
+    size_t count = 0;
+    for (const auto& pair : entries) {
+        if (pair.second.item) {
+            count++;
+        }
+    }
+    return count;
+}
+
+void ItemStore::clear() {
+    std::unique_lock<std::shared_timed_mutex> lock(mutex);
+    entries.clear();
+    clock.clear();
+    hand = 0;
+    mapping.reset();
+    loads = 0;
+    evictions = 0;
+}
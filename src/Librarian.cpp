@@ -1,11 +1,11 @@
 #include "../include/Librarian.h"
 #include <iostream>
-#include <sstream>
 
 Librarian::Librarian(const std::string& id, const std::string& name, const std::string& email,
                      const std::string& password, int age, const std::string& empId,
                      const std::string& shft)
-    : Person(id, name, email, password, age), employeeId(empId), shift(shft) {}
+    : Person(id, name, email, password, age, PatronRole::Librarian), employeeId(empId),
+      shift(shft) {}
 
 void Librarian::displayInfo() const {
     std::cout << "\n=== Librarian Information ===" << std::endl;
@@ -22,21 +22,10 @@ std::string Librarian::getRole() const {
     return "Librarian";
 }
 
-int Librarian::getMaxBorrowLimit() const {
-    // Librarians can borrow up to 15 items
-    return 15;
-}
-
-int Librarian::getBorrowDuration() const {
-    // Librarians can borrow for 60 days
-    return 60;
-}
-
-std::string Librarian::serialize() const {
-    std::ostringstream oss;
-    oss << "LIBRARIAN|" << Person::serialize() << "|" 
-        << employeeId << "|" << shift;
-    return oss.str();
+void Librarian::writeTo(RecordWriter& out) const {
+    out.field("LIBRARIAN");
+    Person::writeTo(out);
+    out.field(employeeId).field(shift);
 }
 
 Librarian::~Librarian() {
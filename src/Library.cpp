@@ -1,15 +1,44 @@
 #include "../include/Library.h"
 #include "../include/Exceptions.h"
+#include "../include/MemoryAccounting.h"
 #include <iostream>
 #include <algorithm>
 #include <fstream>
 #include <sstream>
+#include <iomanip>
+#include <thread>
+#include <unordered_map>
+#include <cmath>
+#include <limits>
+#include <sys/stat.h>
+#include <unistd.h>
 
 // Initialize static singleton instance
 Library* Library::instance = nullptr;
 
-Library::Library() {
-    // Private constructor
+// Smallest range of records worth handing to another thread in a scan
+static const size_t SCAN_GRAIN = 4096;
+
+// Counters in each day's most-borrowed summaries; items borrowed more than
+// 1/128 of a day's loans are always counted
+static const size_t POPULARITY_COUNTERS = 128;
+
+// Worker threads for a pool in which 'threadCount' threads, the caller
+// included, share each parallel loop
+static unsigned workersFor(unsigned threadCount) {
+    if (threadCount == 0) {
+        threadCount = std::max(1u, std::thread::hardware_concurrency());
+    }
+    return threadCount - 1;
+}
+
+Library::Library()
+    : popularity(POPULARITY_COUNTERS), lastSequence(0), savedSequence(0), ledgerSaved(0),
+      baseBytes(0), lazyCatalog(false), indexesDeferred(false), deferredSequence(0),
+      deferredItemCount(0), policyChecked(0), taskPool(new TaskPool(workersFor(0))) {
+    items.setLoader([this](const char* record, size_t length) {
+        return loadItem(record, length);
+    });
 }
 
 Library* Library::getInstance() {
@@ -25,16 +54,28 @@ Library::~Library() {
 
 // ==================== User Management ====================
 
+void Library::applyAddUser(const std::shared_ptr<Person>& user) {
+    MemoryScope scope(MemoryTag::Users);
+    if (users.find(user->getUserId()) != users.end()) {
+        throw InvalidOperationException("User ID already exists: " + user->getUserId());
+    }
+    
+    users[user->getUserId()] = user;
+    stats.onUserRegistered(user->getUserId());
+    changes.markUser(user->getUserId());
+}
+
 void Library::registerStudent(const std::string& id, const std::string& name,
                               const std::string& email, const std::string& password, int age,
                               const std::string& studentId, const std::string& major, int year) {
-    if (users.find(id) != users.end()) {
-        throw InvalidOperationException("User ID already exists: " + id);
-    }
-    
-    auto student = std::make_shared<Student>(id, name, email, password, age, 
+    std::lock_guard<std::mutex> lock(stateMutex);
+    requireWritableJournal();
+    MemoryScope scope(MemoryTag::Users);
+    auto student = std::make_shared<Student>(id, name, email, password, age,
                                              studentId, major, year);
-    users[id] = student;
+    applyAddUser(student);
+    recordEvent(LibraryEvent::userRegistered(student->serialize(), time(nullptr)));
+    shareUser(student);
     std::cout << "Student registered successfully!" << std::endl;
 }
 
@@ -42,26 +83,28 @@ void Library::registerFaculty(const std::string& id, const std::string& name,
                               const std::string& email, const std::string& password, int age,
                               const std::string& empId, const std::string& dept,
                               const std::string& designation) {
-    if (users.find(id) != users.end()) {
-        throw InvalidOperationException("User ID already exists: " + id);
-    }
-    
+    std::lock_guard<std::mutex> lock(stateMutex);
+    requireWritableJournal();
+    MemoryScope scope(MemoryTag::Users);
     auto faculty = std::make_shared<Faculty>(id, name, email, password, age,
                                              empId, dept, designation);
-    users[id] = faculty;
+    applyAddUser(faculty);
+    recordEvent(LibraryEvent::userRegistered(faculty->serialize(), time(nullptr)));
+    shareUser(faculty);
     std::cout << "Faculty registered successfully!" << std::endl;
 }
 
 void Library::registerLibrarian(const std::string& id, const std::string& name,
                                 const std::string& email, const std::string& password, int age,
                                 const std::string& empId, const std::string& shift) {
-    if (users.find(id) != users.end()) {
-        throw InvalidOperationException("User ID already exists: " + id);
-    }
-    
+    std::lock_guard<std::mutex> lock(stateMutex);
+    requireWritableJournal();
+    MemoryScope scope(MemoryTag::Users);
     auto librarian = std::make_shared<Librarian>(id, name, email, password, age,
                                                  empId, shift);
-    users[id] = librarian;
+    applyAddUser(librarian);
+    recordEvent(LibraryEvent::userRegistered(librarian->serialize(), time(nullptr)));
+    shareUser(librarian);
     std::cout << "Librarian registered successfully!" << std::endl;
 }
 
@@ -102,45 +145,101 @@ std::shared_ptr<Person> Library::getUser(const std::string& userId) {
 
 // ==================== Item Management ====================
 
+void Library::applyAddItem(const std::shared_ptr<LibraryItem>& item) {
+    MemoryScope scope(MemoryTag::Items);
+    if (items.contains(item->getItemId())) {
+        throw InvalidOperationException("Item ID already exists: " + item->getItemId());
+    }
+    
+    items.add(item);
+    if (indexesDeferred) {
+        // The deferred build indexes every item, but reuses a saved
+        // full-text index that only covers the base snapshot
+        MemoryScope indexScope(MemoryTag::Indexes);
+        unindexedItems.push_back(item->getItemId());
+    } else {
+        MemoryScope indexScope(MemoryTag::Indexes);
+        titleIndex.add(item->getItemId(), item->getTitle());
+        catalogIndex.add(item);
+        fullTextIndex.add(*item);
+        addCompletions(*item, 0);
+        yearIndex.insert(item->getPublicationYear(), item->getItemId());
+    }
+    stats.onItemAdded(item->getItemId());
+    stats.onAvailabilityChange(0, item->getAvailableCopies());
+    queryCache.invalidate(QueryCache::catalogOf(item->getItemType()) |
+                          QueryCache::availabilityOf(item->getItemType()));
+    changes.markItem(item->getItemId());
+}
+
 void Library::addBook(const std::string& id, const std::string& title,
                      const std::string& publisher, int year, const std::string& isbn,
                      const std::string& author, const std::string& genre, int pages) {
-    if (items.find(id) != items.end()) {
-        throw InvalidOperationException("Item ID already exists: " + id);
-    }
-    
-    auto book = std::make_shared<Book>(id, title, publisher, year, isbn, 
+    std::lock_guard<std::mutex> lock(stateMutex);
+    requireWritableJournal();
+    MemoryScope scope(MemoryTag::Items);
+    auto book = std::make_shared<Book>(id, title, publisher, year, isbn,
                                        author, genre, pages);
-    items[id] = book;
+    applyAddItem(book);
+    recordEvent(LibraryEvent::itemAdded(book->serialize(), time(nullptr)));
+    shareItem(book);
     std::cout << "Book added successfully!" << std::endl;
 }
 
 void Library::addMagazine(const std::string& id, const std::string& title,
                          const std::string& publisher, int year, int issue,
                          const std::string& month, const std::string& category) {
-    if (items.find(id) != items.end()) {
-        throw InvalidOperationException("Item ID already exists: " + id);
-    }
-    
+    std::lock_guard<std::mutex> lock(stateMutex);
+    requireWritableJournal();
+    MemoryScope scope(MemoryTag::Items);
     auto magazine = std::make_shared<Magazine>(id, title, publisher, year,
                                                issue, month, category);
-    items[id] = magazine;
+    applyAddItem(magazine);
+    recordEvent(LibraryEvent::itemAdded(magazine->serialize(), time(nullptr)));
+    shareItem(magazine);
     std::cout << "Magazine added successfully!" << std::endl;
 }
 
 void Library::addJournal(const std::string& id, const std::string& title,
                         const std::string& publisher, int year, int volume,
                         const std::string& field, const std::string& editor, bool peerReviewed) {
-    if (items.find(id) != items.end()) {
-        throw InvalidOperationException("Item ID already exists: " + id);
-    }
-    
+    std::lock_guard<std::mutex> lock(stateMutex);
+    requireWritableJournal();
+    MemoryScope scope(MemoryTag::Items);
     auto journal = std::make_shared<Journal>(id, title, publisher, year, volume,
                                             field, editor, peerReviewed);
-    items[id] = journal;
+    applyAddItem(journal);
+    recordEvent(LibraryEvent::itemAdded(journal->serialize(), time(nullptr)));
+    shareItem(journal);
     std::cout << "Journal added successfully!" << std::endl;
 }
 
+void Library::applyAddCopies(const std::string& itemId, int count, time_t now) {
+    MemoryScope scope(MemoryTag::Items);
+    auto item = getItem(itemId);
+    expireHolds(item, now);
+    
+    int copiesBefore = item->getAvailableCopies();
+    item->addCopies(count);
+    promoteHolds(item, now);
+    onCopiesChanged(*item, copiesBefore);
+    changes.markItem(itemId);
+}
+
+void Library::addCopies(const std::string& itemId, int count) {
+    std::lock_guard<std::mutex> lock(stateMutex);
+    requireWritableJournal();
+    time_t now = time(nullptr);
+    applyAddCopies(itemId, count, now);
+    recordEvent(LibraryEvent::copiesAdded(itemId, count, now));
+    syncSharedItem(itemId);
+    
+    auto item = getItem(itemId);
+    std::cout << count << " cop" << (count == 1 ? "y" : "ies") << " added. "
+              << item->getTitle() << " now has " << item->getTotalCopies()
+              << " copies." << std::endl;
+}
+
 void Library::displayAllItems() const {
     if (items.empty()) {
         std::cout << "\nNo items in the library." << std::endl;
@@ -148,61 +247,314 @@ void Library::displayAllItems() const {
     }
     
     std::cout << "\n========== All Library Items ==========" << std::endl;
-    for (const auto& pair : items) {
-        pair.second->displayInfo();
+    items.forEach([](const std::shared_ptr<LibraryItem>& item) {
+        item->displayInfo();
         std::cout << "-------------------------------------------" << std::endl;
+    });
+}
+
+void Library::onCopiesChanged(const LibraryItem& item, int copiesBefore) {
+    // A changed item can no longer be decoded again from its snapshot record
+    items.pin(item.getItemId());
+    int copiesAfter = item.getAvailableCopies();
+    stats.onAvailabilityChange(copiesBefore, copiesAfter);
+    // Listings only change when a title gains its first free copy or loses its last
+    if ((copiesBefore > 0) != (copiesAfter > 0)) {
+        queryCache.invalidate(QueryCache::availabilityOf(item.getItemType()));
     }
 }
 
+std::vector<std::shared_ptr<LibraryItem>> Library::getAvailableItemList() const {
+    const std::string key = "available";
+    QueryCache::Result results;
+    if (queryCache.lookup(key, results)) {
+        return results;
+    }
+    
+    QueryCache::Stamp stamp = queryCache.stamp(QueryCache::ALL_AVAILABILITY);
+    // Free copies are a hot field, so only the listed items are decoded
+    std::vector<std::string> availableIds;
+    items.forEachSummary([&availableIds](const std::string& itemId, const std::string&,
+                                         int availableCopies) {
+        if (availableCopies > 0) {
+            availableIds.push_back(itemId);
+        }
+    });
+    for (const auto& itemId : availableIds) {
+        if (auto item = items.find(itemId)) {
+            results.push_back(item);
+        }
+    }
+    
+    queryCache.store(key, stamp, results);
+    return results;
+}
+
 void Library::displayAvailableItems() const {
-    bool found = false;
+    std::vector<std::shared_ptr<LibraryItem>> available = getAvailableItemList();
     std::cout << "\n========== Available Items ==========" << std::endl;
-    for (const auto& pair : items) {
-        if (pair.second->getAvailability()) {
-            pair.second->displayInfo();
-            std::cout << "-------------------------------------------" << std::endl;
-            found = true;
-        }
+    for (const auto& item : available) {
+        item->displayInfo();
+        std::cout << "-------------------------------------------" << std::endl;
     }
     
-    if (!found) {
+    if (available.empty()) {
         std::cout << "No items currently available." << std::endl;
     }
 }
 
 std::shared_ptr<LibraryItem> Library::getItem(const std::string& itemId) {
-    auto it = items.find(itemId);
-    if (it == items.end()) {
+    auto item = items.find(itemId);
+    if (!item) {
         throw ItemNotFoundException(itemId);
     }
-    return it->second;
+    return item;
+}
+
+std::shared_ptr<LibraryItem> Library::getItemByIsbn(const std::string& isbn) {
+    ensureIndexes();
+    std::vector<std::string> matches = catalogIndex.findByIsbn(isbn);
+    if (matches.empty()) {
+        throw ItemNotFoundException("ISBN " + isbn);
+    }
+    return getItem(matches.front());
 }
 
 // ==================== Search Functionality ====================
 
 std::vector<std::shared_ptr<LibraryItem>> Library::searchByTitle(const std::string& title) const {
-    std::vector<std::shared_ptr<LibraryItem>> results;
+    if (traceRecorder) {
+        traceRecorder->record(TraceOp::SearchTitle, "", title);
+    }
     std::string lowerTitle = title;
     std::transform(lowerTitle.begin(), lowerTitle.end(), lowerTitle.begin(), ::tolower);
     
-    for (const auto& pair : items) {
-        std::string itemTitle = pair.second->getTitle();
+    const std::string key = "title|" + lowerTitle;
+    QueryCache::Result results;
+    if (queryCache.lookup(key, results)) {
+        return results;
+    }
+    
+    QueryCache::Stamp stamp = queryCache.stamp(QueryCache::ALL_CATALOG);
+    // Scan without caching what is decoded, then keep only the matches
+    std::vector<std::string> matches;
+    items.scan([&](const std::shared_ptr<LibraryItem>& item) {
+        std::string itemTitle = item->getTitle();
         std::transform(itemTitle.begin(), itemTitle.end(), itemTitle.begin(), ::tolower);
-        
+    
         if (itemTitle.find(lowerTitle) != std::string::npos) {
-            results.push_back(pair.second);
+            matches.push_back(item->getItemId());
+        }
+    });
+    for (const auto& itemId : matches) {
+        if (auto item = items.find(itemId)) {
+            results.push_back(item);
         }
     }
     
+    queryCache.store(key, stamp, results);
     return results;
 }
 
+std::vector<std::pair<std::shared_ptr<LibraryItem>, int>>
+Library::searchByTitleFuzzy(const std::string& title, int maxDistance, size_t limit) const {
+    std::vector<std::pair<std::shared_ptr<LibraryItem>, int>> results;
+    
+    ensureIndexes();
+    for (const auto& match : titleIndex.search(title, maxDistance, limit, *taskPool)) {
+        if (auto item = items.find(match.itemId)) {
+            results.push_back(std::make_pair(item, match.distance));
+        }
+    }
+    
+    return results;
+}
+
+std::vector<std::pair<std::shared_ptr<LibraryItem>, double>>
+Library::searchKeywords(const std::string& query, size_t limit) const {
+    if (traceRecorder) {
+        traceRecorder->record(TraceOp::SearchKeywords, "", query, limit);
+    }
+    std::vector<std::pair<std::shared_ptr<LibraryItem>, double>> results;
+    
+    ensureIndexes();
+    for (const auto& match : fullTextIndex.search(query, limit)) {
+        if (auto item = items.find(match.itemId)) {
+            results.push_back(std::make_pair(item, match.score));
+        }
+    }
+    
+    return results;
+}
+
+void Library::recordPopularity(const LibraryItem& item, time_t when) const {
+    const Book* book = dynamic_cast<const Book*>(&item);
+    popularity.record(item.getItemId(), item.getItemType(), book ? book->getGenre() : "", when);
+}
+
+void Library::rebuildPopularity() const {
+    // Only loans made within the longest window can count
+    popularity.clear();
+    time_t from = time(nullptr) - PopularityTracker::MONTH_DAYS * 24 * 60 * 60;
+    for (size_t index : borrowIndex.range(from, std::numeric_limits<time_t>::max())) {
+        const Transaction& trans = transactions.get(index);
+        recordPopularity(*items.find(trans.getItemId()), trans.getBorrowDate());
+    }
+}
+
+void Library::rebuildCoBorrows() const {
+    std::vector<std::pair<std::string, std::string>> borrows;
+    borrows.reserve(transactions.size());
+    transactions.forEach([&borrows](const Transaction& trans) {
+        borrows.emplace_back(trans.getUserId(), trans.getItemId());
+    });
+    coBorrows.rebuild(borrows, *taskPool);
+}
+
+std::vector<PopularItem> Library::getPopularItems(PopularityWindow window,
+                                                  const std::string& type,
+                                                  const std::string& genre, size_t k) const {
+    ensureIndexes();
+    return popularity.top(window, type, genre, k, time(nullptr));
+}
+
+void Library::displayPopularItems(PopularityWindow window, const std::string& type,
+                                  const std::string& genre, size_t k) const {
+    std::vector<PopularItem> popular = getPopularItems(window, type, genre, k);
+    std::cout << "\n========== Most Borrowed This "
+              << PopularityTracker::windowName(window) << " ==========" << std::endl;
+    if (!type.empty() || !genre.empty()) {
+        std::cout << "Only " << (type.empty() ? "items" : type + " items")
+                  << (genre.empty() ? "" : " in " + genre) << std::endl;
+    }
+    if (popular.empty()) {
+        std::cout << "No borrows in this period." << std::endl;
+        return;
+    }
+    int rank = 1;
+    for (const auto& entry : popular) {
+        auto item = items.find(entry.itemId);
+        std::cout << std::setw(3) << rank++ << ". " << entry.itemId << " - "
+                  << (item ? item->getTitle() : std::string("(removed)")) << ": "
+                  << entry.borrows << " borrow(s)";
+        if (entry.error > 0) {
+            std::cout << " (at most " << entry.error << " fewer)";
+        }
+        std::cout << std::endl;
+    }
+}
+
+std::vector<Recommendation> Library::getRelatedItems(const std::string& itemId,
+                                                     size_t n) const {
+    ensureIndexes();
+    return coBorrows.related(itemId, n);
+}
+
+void Library::displayRelatedItems(const std::string& itemId, size_t n) const {
+    auto item = items.find(itemId);
+    if (!item) {
+        throw ItemNotFoundException(itemId);
+    }
+    std::vector<Recommendation> related = getRelatedItems(itemId, n);
+    std::cout << "\n========== Also Borrowed ==========" << std::endl;
+    std::cout << "Patrons who borrowed " << item->getTitle() << " also borrowed:" << std::endl;
+    if (related.empty()) {
+        std::cout << "Nothing yet." << std::endl;
+        return;
+    }
+    int rank = 1;
+    for (const auto& entry : related) {
+        auto other = items.find(entry.itemId);
+        std::cout << std::setw(3) << rank++ << ". " << entry.itemId << " - "
+                  << (other ? other->getTitle() : std::string("(removed)")) << ": "
+                  << "borrowed together " << entry.coBorrows << " time(s)" << std::endl;
+    }
+}
+
+void Library::addCompletions(const LibraryItem& item, unsigned long long borrows) const {
+    MemoryScope scope(MemoryTag::Indexes);
+    titleCompletions.add(item.getTitle(), borrows);
+    if (auto book = dynamic_cast<const Book*>(&item)) {
+        authorCompletions.add(book->getAuthor(), borrows);
+    }
+}
+
+std::vector<Completion> Library::suggestTitles(const std::string& prefix, size_t limit) const {
+    ensureIndexes();
+    return titleCompletions.suggest(prefix, limit);
+}
+
+std::vector<Completion> Library::suggestAuthors(const std::string& prefix, size_t limit) const {
+    ensureIndexes();
+    return authorCompletions.suggest(prefix, limit);
+}
+
 std::vector<std::shared_ptr<LibraryItem>> Library::searchByType(const std::string& type) const {
+    if (traceRecorder) {
+        traceRecorder->record(TraceOp::SearchType, "", type);
+    }
+    ItemQuery query;
+    query.type = type;
+    
+    // Same key for every spelling the type index treats as equal
+    std::string lowerType;
+    std::istringstream words(type);
+    for (std::string word; words >> word;) {
+        lowerType += (lowerType.empty() ? "" : " ") + word;
+    }
+    std::transform(lowerType.begin(), lowerType.end(), lowerType.begin(), ::tolower);
+    
+    const std::string key = "type|" + lowerType;
+    QueryCache::Result results;
+    if (queryCache.lookup(key, results)) {
+        return results;
+    }
+    
+    // Adding a magazine leaves cached book listings valid
+    QueryCache::Stamp stamp = queryCache.stamp(QueryCache::catalogOf(lowerType));
+    if (indexesDeferred) {
+        // The kind is loaded eagerly, so a listing needs no index build
+        std::vector<std::string> matches;
+        items.forEachSummary([&](const std::string& itemId, const std::string& itemType, int) {
+            std::string lowerItemType = itemType;
+            std::transform(lowerItemType.begin(), lowerItemType.end(), lowerItemType.begin(),
+                           ::tolower);
+            if (lowerItemType == lowerType) {
+                matches.push_back(itemId);
+            }
+        });
+        for (const auto& itemId : matches) {
+            if (auto item = items.find(itemId)) {
+                results.push_back(item);
+            }
+        }
+    } else {
+        results = findItems(query);
+    }
+    queryCache.store(key, stamp, results);
+    return results;
+}
+
+std::vector<std::shared_ptr<LibraryItem>> Library::findItems(const ItemQuery& query) const {
+    std::vector<std::shared_ptr<LibraryItem>> results;
+    
+    ensureIndexes();
+    for (const auto& itemId : catalogIndex.find(query)) {
+        if (auto item = items.find(itemId)) {
+            results.push_back(item);
+        }
+    }
+    
+    return results;
+}
+
+std::vector<std::shared_ptr<LibraryItem>> Library::getItemsPublishedBetween(int fromYear, int toYear) const {
     std::vector<std::shared_ptr<LibraryItem>> results;
     
-    for (const auto& pair : items) {
-        if (pair.second->getItemType() == type) {
-            results.push_back(pair.second);
+    ensureIndexes();
+    for (const auto& itemId : yearIndex.range(fromYear, toYear)) {
+        if (auto item = items.find(itemId)) {
+            results.push_back(item);
         }
     }
     
@@ -211,201 +563,1053 @@ std::vector<std::shared_ptr<LibraryItem>> Library::searchByType(const std::strin
 
 // ==================== Transaction Management ====================
 
-int Library::getNextTransactionId() const {
-    return transactions.size() + 1;
+size_t Library::transactionIndex(const std::string& transactionId) {
+    // Transaction IDs are "T<n>" and T<n> lives at index n - 1
+    if (transactionId.size() < 2 || transactionId[0] != 'T') {
+        throw InvalidOperationException("Malformed transaction ID: " + transactionId);
+    }
+    return std::stoul(transactionId.substr(1)) - 1;
 }
 
-void Library::borrowItem(const std::string& userId, const std::string& itemId) {
+const Transaction& Library::applyBorrow(const std::string& userId, const std::string& itemId,
+                                        const std::string& transactionId, time_t due,
+                                        double lateFeePerDay, double fineCap, time_t now) {
+    MemoryScope scope(MemoryTag::Transactions);
+    auto item = getItem(itemId);
+    expireHolds(item, now);
+    
+    auto& loans = openLoans[itemId]; // getItem() checked the item exists
+    if (loans.find(userId) != loans.end()) {
+        throw InvalidOperationException("User already has a copy of this item: " + itemId);
+    }
+    
+    size_t index = transactionIndex(transactionId);
+    if (transactions.isCommitted(index)) {
+        throw InvalidOperationException("Transaction ID already used: " + transactionId);
+    }
+    
+    // Lend the copy held for this user, or any free copy
+    int copiesBefore = item->getAvailableCopies();
+    std::string barcode;
+    ReadyHold readyHold;
+    if (holds.findReady(itemId, userId, readyHold)) {
+        barcode = readyHold.barcode;
+        item->lendReservedCopy(barcode, userId);
+        holds.takeReady(itemId, userId);
+    } else {
+        barcode = item->borrowItem(userId);
+    }
+    
+    transactions.commit(index, Transaction(transactionId, userId, itemId, barcode, now, due,
+                                           lateFeePerDay, fineCap));
+    loans[userId] = index;
+    borrowIndex.insert(now, index);
+    dueIndex.insert(due, index);
+    changes.markTransaction(index);
+    
+    stats.onBorrow(userId, itemId, item->getItemKind(), now);
+    onCopiesChanged(*item, copiesBefore);
+    if (!indexesDeferred) {
+        addCompletions(*item, 1); // A deferred build weights by the loans it finds
+        recordPopularity(*item, now);
+    }
+    return transactions.get(index);
+}
+
+Transaction Library::checkoutItem(const std::string& userId, const std::string& itemId,
+                                  EventJournal::DurableCallback onDurable) {
+    if (traceRecorder) {
+        traceRecorder->record(TraceOp::Borrow, userId, itemId);
+    }
+    // IDs come from the log's slot allocator, outside the lock; a refused
+    // borrow leaves a gap. The row itself is committed under the lock,
+    // since openLoans and the indexes point at it as soon as they change.
+    size_t slot = transactions.allocate();
+    std::lock_guard<std::mutex> lock(stateMutex);
+    requireWritableJournal();
+    sweepExpiredHolds();
+    time_t now = time(nullptr);
+    refreshLoanPolicy(now);
+    
     // Get user and item
     auto user = getUser(userId);
     auto item = getItem(itemId);
+    const LoanRule& terms = loanTerms(*user, *item);
     
-    // Check if item is available
-    if (!item->getAvailability()) {
-        throw ItemAlreadyBorrowedException(itemId);
-    }
+    // A copy on the hold shelf for this user takes precedence
+    ReadyHold readyHold;
+    bool hasReadyHold = holds.findReady(itemId, userId, readyHold);
     
-    // Check user's current borrow count
-    int currentBorrowCount = 0;
-    for (const auto& trans : transactions) {
-        if (trans.getUserId() == userId && !trans.getIsReturned()) {
-            currentBorrowCount++;
-        }
+    // Check if any copy is available
+    if (!hasReadyHold && !item->getAvailability()) {
+        throw ItemAlreadyBorrowedException(itemId);
     }
     
-    if (currentBorrowCount >= user->getMaxBorrowLimit()) {
+    // The role's limit counts every open loan; the kind's only loans of that kind
+    UserStats userStats = stats.getUserStats(userId);
+    if (userStats.currentlyBorrowed >= loanPolicy.getMaxTotalLoans(user->getPatronRole())) {
         throw BorrowLimitExceededException("User has reached maximum borrow limit");
     }
+    if (userStats.borrowedOf(item->getItemKind()) >= terms.maxLoans) {
+        throw BorrowLimitExceededException(std::string("User has reached maximum ") +
+                                           LoanPolicy::kindName(item->getItemKind()) +
+                                           " borrow limit");
+    }
     
     // Create transaction
-    std::string tid = "T" + std::to_string(getNextTransactionId());
-    Transaction trans(tid, userId, itemId, user->getBorrowDuration());
-    transactions.push_back(trans);
-    
-    // Update item status
-    item->borrowItem(userId);
+    std::string tid = "T" + std::to_string(slot + 1);
+    time_t due = now + terms.loanDays * 24 * 60 * 60;
+    Transaction trans = applyBorrow(userId, itemId, tid, due, terms.lateFeePerDay, terms.fineCap,
+                                    now);
+    if (!indexesDeferred) {
+        // Replay is partitioned by item, so only live borrows arrive in
+        // each patron's order; recovery rebuilds from the transactions
+        coBorrows.recordBorrow(userId, itemId);
+    }
+    recordEvent(LibraryEvent::itemBorrowed(userId, itemId, tid, due, terms.lateFeePerDay,
+                                           terms.fineCap, now),
+                std::move(onDurable));
+    syncSharedItem(itemId);
+    syncSharedUser(userId);
+    return trans;
+}
+
+void Library::borrowItem(const std::string& userId, const std::string& itemId) {
+    Transaction trans = checkoutItem(userId, itemId);
     
     std::cout << "\nItem borrowed successfully!" << std::endl;
     std::cout << "Due date: " << Transaction::timeToString(trans.getDueDate()) << std::endl;
 }
 
-void Library::returnItem(const std::string& userId, const std::string& itemId) {
-    // Find the transaction
-    Transaction* trans = nullptr;
-    for (auto& t : transactions) {
-        if (t.getUserId() == userId && t.getItemId() == itemId && !t.getIsReturned()) {
-            trans = &t;
-            break;
-        }
-    }
+double Library::applyReturn(const std::string& userId, const std::string& itemId, time_t now) {
+    MemoryScope scope(MemoryTag::Transactions);
+    auto item = getItem(itemId);
+    expireHolds(item, now);
     
-    if (trans == nullptr) {
+    auto& loans = openLoans[itemId];
+    auto loan = loans.find(userId);
+    if (loan == loans.end()) {
         throw InvalidOperationException("No active borrow found for this item and user");
     }
+    Transaction& trans = transactions.at(loan->second);
+    dueIndex.erase(trans.getDueDate(), loan->second);
+    changes.markTransaction(loan->second);
+    loans.erase(loan);
     
-    // Get item to get late fee
-    auto item = getItem(itemId);
+    int copiesBefore = item->getAvailableCopies();
+    
+    // Process return, at the terms the loan was made on
+    double fine = trans.processReturn(now);
     
-    // Process return
-    double fine = trans->processReturn(item->getLateFeePerDay());
+    // Charge whatever the nightly accrual has not already put on the ledger
+    double remainder = fine - trans.getAccruedFine();
+    if (remainder > 0.005) {
+        fineLedger.post(userId, trans.getTransactionId(), LedgerEntryType::Assessment,
+                        remainder, now);
+    }
     
-    // Update item status
-    item->returnItem();
+    // Put the lent copy back on the shelf
+    item->returnItem(trans.getCopyBarcode());
+    
+    // Hand the copy straight to the next patron waiting for it
+    promoteHolds(item, now);
+    
+    stats.onReturn(userId, item->getItemKind(), fine);
+    onCopiesChanged(*item, copiesBefore);
+    return fine;
+}
+
+Library::ReturnSummary Library::checkinItem(const std::string& userId, const std::string& itemId,
+                                            EventJournal::DurableCallback onDurable) {
+    if (traceRecorder) {
+        traceRecorder->record(TraceOp::Return, userId, itemId);
+    }
+    std::lock_guard<std::mutex> lock(stateMutex);
+    requireWritableJournal();
+    sweepExpiredHolds();
+    time_t now = time(nullptr);
+    
+    auto item = getItem(itemId);
+    int copiesBefore = item->getAvailableCopies();
+    
+    ReturnSummary summary;
+    summary.fine = applyReturn(userId, itemId, now);
+    summary.setAsideForHold = item->getAvailableCopies() == copiesBefore;
+    recordEvent(LibraryEvent::itemReturned(userId, itemId, now), std::move(onDurable));
+    syncSharedItem(itemId);
+    syncSharedUser(userId);
+    return summary;
+}
+
+void Library::returnItem(const std::string& userId, const std::string& itemId) {
+    ReturnSummary summary = checkinItem(userId, itemId);
     
     std::cout << "\nItem returned successfully!" << std::endl;
-    if (fine > 0) {
-        std::cout << "Late fee: $" << fine << std::endl;
+    if (summary.fine > 0) {
+        std::cout << "Late fee: $" << summary.fine << std::endl;
     } else {
         std::cout << "No late fee." << std::endl;
     }
+    if (summary.setAsideForHold) {
+        std::cout << "The copy has been set aside for the next hold on " << itemId << "." << std::endl;
+    }
 }
 
-void Library::displayUserTransactions(const std::string& userId) const {
-    bool found = false;
-    std::cout << "\n========== Transactions for User: " << userId << " ==========" << std::endl;
+// ==================== Loan Policy ====================
+
+// Changes whenever the file is rewritten; empty while it does not exist
+static std::string fileStamp(const std::string& filename) {
+    struct stat info;
+    if (::stat(filename.c_str(), &info) != 0) {
+        return "";
+    }
+    return std::to_string(static_cast<long long>(info.st_mtime)) + "/" +
+           std::to_string(static_cast<long long>(info.st_size));
+}
+
+void Library::configureLoanPolicy(const std::string& filename, const std::string& branch) {
+    std::lock_guard<std::mutex> lock(stateMutex);
+    std::string stamp = fileStamp(filename);
+    loanPolicy = stamp.empty() ? LoanPolicy() : LoanPolicy::compile(filename, branch);
+    policyFile = filename;
+    policyBranch = branch;
+    policyStamp = stamp;
+    policyChecked = time(nullptr);
+}
+
+void Library::refreshLoanPolicy(time_t now) {
+    // One look at the file per second at most
+    if (policyFile.empty() || now == policyChecked) {
+        return;
+    }
+    policyChecked = now;
+    std::string stamp = fileStamp(policyFile);
+    if (stamp == policyStamp) {
+        return;
+    }
+
+    try {
+        loanPolicy = stamp.empty() ? LoanPolicy() : LoanPolicy::compile(policyFile, policyBranch);
+        // Reached from inside a checkout, so keep it off the caller's output
+        std::cerr << "Loan policy reloaded from "
+                  << (stamp.empty() ? "the built-in defaults" : policyFile) << "." << std::endl;
+    } catch (const LibraryException& e) {
+        std::cerr << "Keeping the current loan policy: " << e.what() << std::endl;
+    }
+    // Remembered either way, so a broken file is reported once
+    policyStamp = stamp;
+}
+
+const LoanRule& Library::loanTerms(const Person& user, const LibraryItem& item) const {
+    return loanPolicy.getRule(user.getPatronRole(), item.getItemKind());
+}
+
+void Library::displayLoanTerms(const std::string& userId) {
+    std::lock_guard<std::mutex> lock(stateMutex);
+    refreshLoanPolicy(time(nullptr));
+    auto user = users.find(userId);
+    if (user == users.end()) {
+        throw UserNotFoundException(userId);
+    }
+    
+    std::cout << "\n=== Loan Terms ===" << std::endl;
+    std::cout << "Up to " << loanPolicy.getMaxTotalLoans(user->second->getPatronRole())
+              << " loans in all" << std::endl;
+    for (int kind = 0; kind < LoanPolicy::KINDS; kind++) {
+        ItemKind itemKind = static_cast<ItemKind>(kind);
+        const LoanRule& rule = loanPolicy.getRule(user->second->getPatronRole(), itemKind);
+        std::cout << LoanPolicy::kindName(itemKind) << ": up to " << rule.maxLoans
+                  << " loans for " << rule.loanDays << " days, $" << std::fixed
+                  << std::setprecision(2) << rule.lateFeePerDay << " per day late";
+        if (rule.fineCap > 0) {
+            std::cout << " (at most $" << rule.fineCap << " per loan)";
+        }
+        std::cout << std::endl;
+    }
+}
+
+// ==================== Holds / Reservations ====================
+
+void Library::promoteHolds(const std::shared_ptr<LibraryItem>& item, time_t now) {
+    std::string itemId = item->getItemId();
+    
+    while (item->getAvailability() && holds.hasWaiting(itemId)) {
+        std::string nextUser = holds.popNextWaiting(itemId);
+        std::string barcode = item->reserveCopy(nextUser);
+        holds.markReady(itemId, nextUser, barcode, now);
+    }
+}
+
+void Library::expireHolds(const std::shared_ptr<LibraryItem>& item, time_t now) {
+    // Earliest first, each promotion dated at the expiry it follows, so the
+    // outcome does not depend on when the sweep happens to run
+    ReadyHold hold;
+    while (holds.takeEarliestExpired(item->getItemId(), now, hold)) {
+        int copiesBefore = item->getAvailableCopies();
+        item->releaseReservedCopy(hold.barcode);
+        promoteHolds(item, hold.expiresAt);
+        onCopiesChanged(*item, copiesBefore);
+    }
+}
+
+void Library::applyPlaceHold(const std::string& userId, const std::string& itemId, time_t now) {
+    auto item = getItem(itemId);
+    expireHolds(item, now);
+    
+    // A patron waits for a copy only if they do not already have one
+    auto loans = openLoans.find(itemId);
+    if (loans != openLoans.end() && loans->second.count(userId) > 0) {
+        throw InvalidOperationException("User already has a copy of this item: " + itemId);
+    }
+    if (item->getAvailability()) {
+        throw InvalidOperationException("Item is available, borrow it directly: " + itemId);
+    }
+    
+    auto user = users.find(userId);
+    if (user == users.end()) {
+        throw UserNotFoundException(userId);
+    }
+    holds.placeHold(itemId, userId, holdPriorityForRole(user->second->getRole()));
+}
+
+void Library::placeHold(const std::string& userId, const std::string& itemId) {
+    std::lock_guard<std::mutex> lock(stateMutex);
+    requireWritableJournal();
+    sweepExpiredHolds();
+    time_t now = time(nullptr);
+    
+    getUser(userId);
+    applyPlaceHold(userId, itemId, now);
+    recordEvent(LibraryEvent::holdPlaced(userId, itemId, now));
+    
+    std::cout << "\nHold placed successfully!" << std::endl;
+    std::cout << "Queue position: " << holds.getQueuePosition(itemId, userId) << std::endl;
+}
+
+void Library::applyCancelHold(const std::string& userId, const std::string& itemId, time_t now) {
+    auto item = getItem(itemId);
+    expireHolds(item, now);
+    
+    ReadyHold ready;
+    if (holds.findReady(itemId, userId, ready)) {
+        // Put the held copy back into circulation
+        int copiesBefore = item->getAvailableCopies();
+        holds.takeReady(itemId, userId);
+        item->releaseReservedCopy(ready.barcode);
+        promoteHolds(item, now);
+        onCopiesChanged(*item, copiesBefore);
+    } else if (!holds.cancelWaiting(itemId, userId)) {
+        throw InvalidOperationException("No hold found for this item and user");
+    }
+}
+
+void Library::cancelHold(const std::string& userId, const std::string& itemId) {
+    std::lock_guard<std::mutex> lock(stateMutex);
+    requireWritableJournal();
+    time_t now = time(nullptr);
+    applyCancelHold(userId, itemId, now);
+    recordEvent(LibraryEvent::holdCancelled(userId, itemId, now));
+    syncSharedItem(itemId);
+    std::cout << "\nHold cancelled." << std::endl;
+}
+
+int Library::getHoldPosition(const std::string& userId, const std::string& itemId) const {
+    return holds.getQueuePosition(itemId, userId);
+}
+
+void Library::displayUserHolds(const std::string& userId) const {
+    auto heldItems = holds.getUserHolds(userId);
+    std::cout << "\n========== Holds for User: " << userId << " ==========" << std::endl;
     
-    for (const auto& trans : transactions) {
-        if (trans.getUserId() == userId) {
-            trans.displayInfo();
-            std::cout << "-------------------------------------------" << std::endl;
-            found = true;
+    if (heldItems.empty()) {
+        std::cout << "No holds found for this user." << std::endl;
+        return;
+    }
+    
+    for (const auto& itemId : heldItems) {
+        std::cout << "Item: " << itemId << std::endl;
+        ReadyHold ready;
+        if (holds.findReady(itemId, userId, ready)) {
+            std::cout << "Status: Ready for pickup (copy " << ready.barcode << ")" << std::endl;
+            std::cout << "Pick up by: " << Transaction::timeToString(ready.expiresAt) << std::endl;
+        } else {
+            std::cout << "Status: Waiting, position " << holds.getQueuePosition(itemId, userId)
+                      << " of " << holds.getQueueLength(itemId) << std::endl;
         }
+        std::cout << "-------------------------------------------" << std::endl;
     }
+}
+
+void Library::processExpiredHolds() {
+    std::lock_guard<std::mutex> lock(stateMutex);
+    sweepExpiredHolds();
+}
+
+void Library::sweepExpiredHolds() {
+    // Expiry is derived from time rather than journaled: replay reaches the
+    // same state through expireHolds() on the next event for each item
+    ReadyHold hold;
+    while (holds.takeEarliestExpired(time(nullptr), hold)) {
+        auto item = items.find(hold.itemId);
+        if (!item) {
+            continue;
+        }
+        int copiesBefore = item->getAvailableCopies();
+        item->releaseReservedCopy(hold.barcode);
+        // Runs inside checkouts and returns, whose output must stay clean
+        std::cerr << "Hold expired: " << hold.itemId << " for user " << hold.userId << std::endl;
+        promoteHolds(item, hold.expiresAt);
+        onCopiesChanged(*item, copiesBefore);
+        syncSharedItem(hold.itemId);
+    }
+}
+
+void Library::displayUserTransactions(const std::string& userId) const {
+    auto snapshot = getTransactionSnapshot();
+    std::cout << "\n========== Transactions for User: " << userId << " ==========" << std::endl;
+    
+    std::string text = formatTransactions(*snapshot, [&userId](const Transaction& trans) {
+        return trans.getUserId() == userId;
+    });
+    std::cout << text;
     
-    if (!found) {
+    if (text.empty()) {
         std::cout << "No transactions found for this user." << std::endl;
     }
+    
+    double balance = fineLedger.getBalance(userId);
+    if (balance > 0.005) {
+        std::cout << "Outstanding Fine Balance: $" << std::fixed << std::setprecision(2)
+                  << balance << std::endl;
+    }
+}
+
+std::shared_ptr<const TransactionSnapshot> Library::getTransactionSnapshot() const {
+    // Only the publish step excludes writers; scanning the result does not
+    std::lock_guard<std::mutex> lock(stateMutex);
+    return transactions.publish();
+}
+
+std::vector<Transaction> Library::transactionsAt(const std::vector<size_t>& indexes, bool openOnly) const {
+    // Published after the lookup, so the snapshot holds every index found
+    auto snapshot = getTransactionSnapshot();
+    std::vector<Transaction> result;
+    result.reserve(indexes.size());
+    
+    for (size_t index : indexes) {
+        const Transaction& trans = snapshot->at(index);
+        if (!openOnly || !trans.getIsReturned()) {
+            result.push_back(trans);
+        }
+    }
+    return result;
+}
+
+std::vector<Transaction> Library::getLoansDueBetween(time_t from, time_t to) const {
+    return transactionsAt(dueIndex.range(from, to), true);
+}
+
+std::vector<Transaction> Library::getLoansBorrowedBetween(time_t from, time_t to) const {
+    return transactionsAt(borrowIndex.range(from, to), false);
 }
 
 void Library::displayAllTransactions() const {
-    if (transactions.empty()) {
+    // Printing the full history can take a while; borrows and returns
+    // carry on against the live store meanwhile
+    auto snapshot = getTransactionSnapshot();
+    if (snapshot->empty()) {
         std::cout << "\nNo transactions in the system." << std::endl;
         return;
     }
     
     std::cout << "\n========== All Transactions ==========" << std::endl;
-    for (const auto& trans : transactions) {
-        trans.displayInfo();
-        std::cout << "-------------------------------------------" << std::endl;
+    std::cout << formatTransactions(*snapshot, [](const Transaction&) { return true; });
+}
+
+std::string Library::formatTransactions(const TransactionSnapshot& snapshot,
+                                        const std::function<bool(const Transaction&)>& keep) const {
+    return taskPool->parallelReduce(
+        0, snapshot.size(), SCAN_GRAIN, std::string(),
+        [&snapshot, &keep](size_t begin, size_t end) {
+            std::ostringstream out;
+            for (size_t i = begin; i < end; i++) {
+                const Transaction& trans = snapshot.at(i);
+                if (!trans.getTransactionId().empty() && keep(trans)) {
+                    trans.displayInfo(out);
+                    out << "-------------------------------------------" << std::endl;
+                }
+            }
+            return out.str();
+        },
+        [](std::string text, std::string part) {
+            text += part;
+            return text;
+        });
+}
+
+// ==================== Fines ====================
+
+Library::AccrualSummary Library::applyFineAccrual(time_t now) {
+    // Only open loans already past due can accrue
+    std::vector<size_t> overdue = dueIndex.range(std::numeric_limits<time_t>::min(), now - 1);
+    
+    // Each loan is touched by exactly one task, and carries its own terms
+    typedef std::pair<std::unordered_map<std::string, double>, int> Partial;
+    Partial accrued = taskPool->parallelReduce(
+        0, overdue.size(), SCAN_GRAIN, Partial(),
+        [this, now, &overdue](size_t begin, size_t end) {
+            Partial partial;
+            for (size_t i = begin; i < end; i++) {
+                const Transaction& trans = transactions.get(overdue[i]);
+                double delta = transactions.at(overdue[i]).accrueFine(now);
+                if (delta > 0) {
+                    changes.markTransaction(overdue[i]);
+                    partial.first[trans.getUserId()] += delta;
+                    partial.second++;
+                }
+            }
+            return partial;
+        },
+        [](Partial total, Partial partial) {
+            for (const auto& pair : partial.first) {
+                total.first[pair.first] += pair.second;
+            }
+            total.second += partial.second;
+            return total;
+        });
+    
+    // One ledger entry per user, posted in user order
+    std::map<std::string, double> perUser(accrued.first.begin(), accrued.first.end());
+    AccrualSummary summary = {0.0, accrued.second, 0};
+    
+    for (const auto& pair : perUser) {
+        fineLedger.post(pair.first, "Daily accrual", LedgerEntryType::Accrual, pair.second, now);
+        summary.totalAccrued += pair.second;
     }
+    summary.userCount = perUser.size();
+    return summary;
+}
+
+void Library::runFineAccrual() {
+    std::lock_guard<std::mutex> lock(stateMutex);
+    requireWritableJournal();
+    time_t now = time(nullptr);
+    AccrualSummary summary = applyFineAccrual(now);
+    recordEvent(LibraryEvent::finesAccrued(now));
+    
+    std::cout << "\nFine accrual complete: $" << std::fixed << std::setprecision(2)
+              << summary.totalAccrued << " accrued on " << summary.loanCount
+              << " overdue loan(s) for " << summary.userCount << " user(s)." << std::endl;
+}
+
+void Library::applyLedgerCredit(const std::string& userId, double amount, LedgerEntryType type,
+                                const std::string& reference, time_t now) {
+    fineLedger.post(userId, reference, type, amount, now);
+}
+
+void Library::payFine(const std::string& userId, double amount) {
+    std::lock_guard<std::mutex> lock(stateMutex);
+    requireWritableJournal();
+    getUser(userId);
+    
+    if (amount <= 0) {
+        throw InvalidOperationException("Payment amount must be positive");
+    }
+    if (amount > fineLedger.getBalance(userId) + 0.005) {
+        throw InvalidOperationException("Payment exceeds outstanding balance for user: " + userId);
+    }
+    
+    time_t now = time(nullptr);
+    applyLedgerCredit(userId, amount, LedgerEntryType::Payment, "Payment", now);
+    recordEvent(LibraryEvent::finePaid(userId, amount, now));
+    std::cout << "\nPayment recorded. Outstanding balance: $" << std::fixed << std::setprecision(2)
+              << fineLedger.getBalance(userId) << std::endl;
+}
+
+void Library::waiveFine(const std::string& userId, double amount, const std::string& reason) {
+    std::lock_guard<std::mutex> lock(stateMutex);
+    requireWritableJournal();
+    getUser(userId);
+    
+    if (amount <= 0) {
+        throw InvalidOperationException("Waiver amount must be positive");
+    }
+    if (amount > fineLedger.getBalance(userId) + 0.005) {
+        throw InvalidOperationException("Waiver exceeds outstanding balance for user: " + userId);
+    }
+    
+    time_t now = time(nullptr);
+    applyLedgerCredit(userId, amount, LedgerEntryType::Waiver, reason, now);
+    recordEvent(LibraryEvent::fineWaived(userId, amount, reason, now));
+    std::cout << "\nWaiver recorded. Outstanding balance: $" << std::fixed << std::setprecision(2)
+              << fineLedger.getBalance(userId) << std::endl;
+}
+
+double Library::getOutstandingBalance(const std::string& userId) const {
+    return fineLedger.getBalance(userId);
+}
+
+void Library::displayUserLedger(const std::string& userId) const {
+    auto entries = fineLedger.getUserEntries(userId);
+    std::cout << "\n========== Fine Ledger for User: " << userId << " ==========" << std::endl;
+    
+    if (entries.empty()) {
+        std::cout << "No fines recorded for this user." << std::endl;
+    }
+    
+    for (const auto& entry : entries) {
+        std::cout << Transaction::timeToString(entry.timestamp) << "  "
+                  << std::left << std::setw(11) << FineLedger::typeToString(entry.type) << std::right
+                  << " $" << std::fixed << std::setprecision(2) << entry.amount
+                  << "  " << entry.reference << std::endl;
+    }
+    std::cout << "Outstanding Balance: $" << std::fixed << std::setprecision(2)
+              << fineLedger.getBalance(userId) << std::endl;
 }
 
 // ==================== Reports ====================
 
 void Library::generateOverdueReport() const {
-    bool found = false;
+    // Open loans due before now, oldest due date first
+    std::vector<Transaction> overdue = getLoansDueBetween(std::numeric_limits<time_t>::min(),
+                                                          time(nullptr) - 1);
+    
     std::cout << "\n========== Overdue Items Report ==========" << std::endl;
     
-    for (const auto& trans : transactions) {
-        if (!trans.getIsReturned() && trans.isOverdue()) {
-            std::cout << "\nUser: " << trans.getUserId() << std::endl;
-            std::cout << "Item: " << trans.getItemId() << std::endl;
-            std::cout << "Days Overdue: " << trans.daysOverdue() << std::endl;
-            std::cout << "-------------------------------------------" << std::endl;
-            found = true;
-        }
+    for (const auto& trans : overdue) {
+        std::cout << "\nUser: " << trans.getUserId() << std::endl;
+        std::cout << "Item: " << trans.getItemId() << std::endl;
+        std::cout << "Days Overdue: " << trans.daysOverdue() << std::endl;
+        std::cout << "-------------------------------------------" << std::endl;
     }
     
-    if (!found) {
+    if (overdue.empty()) {
         std::cout << "No overdue items." << std::endl;
+    } else {
+        std::cout << "Total Overdue Loans: " << overdue.size() << std::endl;
     }
 }
 
-void Library::generateUserActivityReport(const std::string& userId) const {
-    int totalBorrowed = 0;
-    int currentlyBorrowed = 0;
-    double totalFines = 0.0;
-    
-    for (const auto& trans : transactions) {
-        if (trans.getUserId() == userId) {
-            totalBorrowed++;
-            if (!trans.getIsReturned()) {
-                currentlyBorrowed++;
-            }
-            totalFines += trans.getFineAmount();
-        }
+void Library::generateDueSoonReport(int hours) const {
+    time_t now = time(nullptr);
+    std::vector<Transaction> dueSoon = getLoansDueBetween(now, now + hours * 60 * 60);
+    
+    std::cout << "\n========== Loans Due in the Next " << hours << " Hours ==========" << std::endl;
+    
+    for (const auto& trans : dueSoon) {
+        std::cout << "\nUser: " << trans.getUserId() << std::endl;
+        std::cout << "Item: " << trans.getItemId() << std::endl;
+        std::cout << "Due Date: " << Transaction::timeToString(trans.getDueDate()) << std::endl;
+        std::cout << "-------------------------------------------" << std::endl;
     }
     
+    if (dueSoon.empty()) {
+        std::cout << "No loans due in this period." << std::endl;
+    } else {
+        std::cout << "Total Loans Due: " << dueSoon.size() << std::endl;
+    }
+}
+
+void Library::generateUserActivityReport(const std::string& userId) const {
+    UserStats userStats = stats.getUserStats(userId);
+    
     std::cout << "\n========== User Activity Report ==========" << std::endl;
     std::cout << "User ID: " << userId << std::endl;
-    std::cout << "Total Items Borrowed: " << totalBorrowed << std::endl;
-    std::cout << "Currently Borrowed: " << currentlyBorrowed << std::endl;
-    std::cout << "Total Fines Paid: $" << totalFines << std::endl;
+    std::cout << "Total Items Borrowed: " << userStats.totalBorrowed << std::endl;
+    std::cout << "Currently Borrowed: " << userStats.currentlyBorrowed << std::endl;
+    std::cout << "Total Fines Paid: $" << userStats.totalFines << std::endl;
+    std::cout << "Outstanding Balance: $" << std::fixed << std::setprecision(2)
+              << fineLedger.getBalance(userId) << std::endl;
 }
 
+// ==================== Statistics ====================
+
 int Library::getAvailableItems() const {
-    int count = 0;
-    for (const auto& pair : items) {
-        if (pair.second->getAvailability()) {
-            count++;
-        }
-    }
-    return count;
+    return stats.getAvailableItems();
+}
+
+int Library::getAvailableCopies() const {
+    return stats.getAvailableCopies();
+}
+
+UserStats Library::getUserStats(const std::string& userId) const {
+    return stats.getUserStats(userId);
 }
 
-// ==================== File I/O ====================
+ItemStats Library::getItemStats(const std::string& itemId) const {
+    return stats.getItemStats(itemId);
+}
 
-void Library::saveToFile(const std::string& filename) const {
-    std::ofstream file(filename);
-    if (!file.is_open()) {
-        throw FileIOException(filename);
+void Library::displayStatistics() const {
+    std::cout << "\n========== Library Statistics ==========" << std::endl;
+    std::cout << "Total Users: " << getTotalUsers() << std::endl;
+    std::cout << "Total Items: " << getTotalItems() << std::endl;
+    std::cout << "Available Items: " << stats.getAvailableItems() << std::endl;
+    std::cout << "Available Copies: " << stats.getAvailableCopies() << std::endl;
+    std::cout << "Active Loans: " << stats.getActiveLoans() << std::endl;
+    std::cout << "Total Transactions: " << getTotalTransactions() << std::endl;
+    
+    unsigned long long lookups = queryCache.getLookups();
+    unsigned long long hits = queryCache.getHits();
+    std::cout << "Query Cache: " << hits << " hit(s) of " << lookups << " lookup(s)";
+    if (lookups > 0) {
+        std::cout << " (" << std::fixed << std::setprecision(1) << 100.0 * hits / lookups
+                  << "% hit rate)";
     }
+    std::cout << std::endl;
+    
+    if (lazyCatalog) {
+        std::cout << "Decoded Items: " << items.getResidentCount() << " of " << items.size()
+                  << " (" << items.getLoadCount() << " decoded on demand, "
+                  << items.getEvictionCount() << " evicted)" << std::endl;
+    }
+}
+
+std::vector<std::string> Library::verifyStatistics() const {
+    std::lock_guard<std::mutex> lock(stateMutex);
+    std::vector<std::string> mismatches;
+    
+    // Recount everything from the underlying stores, in parallel
+    struct Recount {
+        std::unordered_map<std::string, UserStats> users;
+        std::unordered_map<std::string, ItemStats> items;
+        int activeLoans;
+    };
+    Recount identity;
+    identity.activeLoans = 0;
+    const std::unordered_map<std::string, ItemKind> kinds = itemKinds(); // Read-only below
+    
+    Recount counted = taskPool->parallelReduce(
+        0, transactions.size(), SCAN_GRAIN, identity,
+        [this, &identity, &kinds](size_t begin, size_t end) {
+            Recount partial = identity;
+            for (size_t i = begin; i < end; i++) {
+                if (!transactions.isCommitted(i)) {
+                    continue;
+                }
+                const Transaction& trans = transactions.get(i);
+                UserStats& user = partial.users[trans.getUserId()];
+                user.totalBorrowed++;
+                if (trans.getIsReturned()) {
+                    user.totalFines += trans.getFineAmount();
+                } else {
+                    user.currentlyBorrowed++;
+                    auto kind = kinds.find(trans.getItemId());
+                    if (kind != kinds.end()) {
+                        user.borrowedByKind[static_cast<int>(kind->second)]++;
+                    }
+                    partial.activeLoans++;
+                }
+    
+                ItemStats& item = partial.items[trans.getItemId()];
+                item.borrowCount++;
+                item.lastBorrowed = std::max(item.lastBorrowed, trans.getBorrowDate());
+            }
+            return partial;
+        },
+        [](Recount total, Recount partial) {
+            for (const auto& pair : partial.users) {
+                UserStats& user = total.users[pair.first];
+                user.totalBorrowed += pair.second.totalBorrowed;
+                user.currentlyBorrowed += pair.second.currentlyBorrowed;
+                for (int kind = 0; kind < ITEM_KIND_COUNT; kind++) {
+                    user.borrowedByKind[kind] += pair.second.borrowedByKind[kind];
+                }
+                user.totalFines += pair.second.totalFines;
+            }
+            for (const auto& pair : partial.items) {
+                ItemStats& item = total.items[pair.first];
+                item.borrowCount += pair.second.borrowCount;
+                item.lastBorrowed = std::max(item.lastBorrowed, pair.second.lastBorrowed);
+            }
+            total.activeLoans += partial.activeLoans;
+            return total;
+        });
+    int activeLoans = counted.activeLoans;
     
-    // Save users
-    file << "USERS_START" << std::endl;
     for (const auto& pair : users) {
-        file << pair.second->serialize() << std::endl;
+        UserStats expected = counted.users[pair.first];
+        UserStats actual = stats.getUserStats(pair.first);
+        bool kindsMatch = true;
+        for (int kind = 0; kind < ITEM_KIND_COUNT; kind++) {
+            kindsMatch = kindsMatch && expected.borrowedByKind[kind] == actual.borrowedByKind[kind];
+        }
+        if (expected.totalBorrowed != actual.totalBorrowed ||
+            expected.currentlyBorrowed != actual.currentlyBorrowed || !kindsMatch ||
+            std::abs(expected.totalFines - actual.totalFines) > 0.005) {
+            mismatches.push_back("User counters differ: " + pair.first);
+        }
     }
-    file << "USERS_END" << std::endl;
     
-    // Save items
-    file << "ITEMS_START" << std::endl;
-    for (const auto& pair : items) {
-        file << pair.second->serialize() << std::endl;
+    // Availability is recounted over a flat list of (itemId, free copies)
+    std::vector<std::pair<std::string, int>> itemList;
+    itemList.reserve(items.size());
+    items.forEachSummary([&itemList](const std::string& itemId, const std::string&,
+                                     int availableCopies) {
+        itemList.push_back(std::make_pair(itemId, availableCopies));
+    });
+    
+    typedef std::pair<int, int> Availability; // (items with a copy, copies)
+    Availability available = taskPool->parallelReduce(
+        0, itemList.size(), SCAN_GRAIN, Availability(0, 0),
+        [&itemList](size_t begin, size_t end) {
+            Availability partial(0, 0);
+            for (size_t i = begin; i < end; i++) {
+                int copies = itemList[i].second;
+                partial.second += copies;
+                if (copies > 0) {
+                    partial.first++;
+                }
+            }
+            return partial;
+        },
+        [](Availability total, Availability partial) {
+            return Availability(total.first + partial.first, total.second + partial.second);
+        });
+    int availableItems = available.first;
+    int availableCopies = available.second;
+    
+    for (const auto& pair : itemList) {
+        ItemStats expected = counted.items[pair.first];
+        ItemStats actual = stats.getItemStats(pair.first);
+        if (expected.borrowCount != actual.borrowCount ||
+            expected.lastBorrowed != actual.lastBorrowed) {
+            mismatches.push_back("Item counters differ: " + pair.first);
+        }
     }
-    file << "ITEMS_END" << std::endl;
     
-    // Save transactions
-    file << "TRANSACTIONS_START" << std::endl;
-    for (const auto& trans : transactions) {
-        file << trans.serialize() << std::endl;
+    if (availableItems != stats.getAvailableItems()) {
+        mismatches.push_back("Available item count differs: counted " +
+                             std::to_string(availableItems) + ", cached " +
+                             std::to_string(stats.getAvailableItems()));
+    }
+    if (availableCopies != stats.getAvailableCopies()) {
+        mismatches.push_back("Available copy count differs: counted " +
+                             std::to_string(availableCopies) + ", cached " +
+                             std::to_string(stats.getAvailableCopies()));
+    }
+    if (activeLoans != stats.getActiveLoans()) {
+        mismatches.push_back("Active loan count differs: counted " +
+                             std::to_string(activeLoans) + ", cached " +
+                             std::to_string(stats.getActiveLoans()));
+    }
+    
+    return mismatches;
+}
+
+// ==================== Memory Footprint ====================
+
+std::vector<Library::MemoryFootprint> Library::getMemoryFootprint() const {
+    std::vector<MemoryFootprint> rows;
+    std::vector<MemoryUsage> usage = MemoryAccounting::usage();
+    if (usage.empty()) {
+        return rows;
     }
-    file << "TRANSACTIONS_END" << std::endl;
     
-    file.close();
-    std::cout << "\nData saved successfully to " << filename << std::endl;
+    unsigned long long objects[MemoryAccounting::TAG_COUNT] = {};
+    {
+        std::lock_guard<std::mutex> lock(stateMutex);
+        objects[static_cast<int>(MemoryTag::Users)] = users.size();
+        objects[static_cast<int>(MemoryTag::Items)] = items.size();
+        objects[static_cast<int>(MemoryTag::Transactions)] = transactions.size();
+        objects[static_cast<int>(MemoryTag::Holds)] = holds.getHoldCount();
+        objects[static_cast<int>(MemoryTag::Fines)] = fineLedger.getEntryCount();
+    }
+    for (const MemoryUsage& tag : usage) {
+        rows.push_back(MemoryFootprint{MemoryAccounting::tagName(tag.tag), tag.liveBytes,
+                                       tag.liveAllocations, objects[static_cast<int>(tag.tag)]});
+    }
+    return rows;
 }
 
-void Library::loadFromFile(const std::string& filename) {
-    std::ifstream file(filename);
-    if (!file.is_open()) {
-        throw FileIOException(filename);
+void Library::displayMemoryFootprint() const {
+    std::vector<MemoryFootprint> rows = getMemoryFootprint();
+    std::cout << "\n========== Memory Footprint ==========" << std::endl;
+    if (rows.empty()) {
+        std::cout << "Memory accounting is not built in (LIBRARY_MEMORY_ACCOUNTING)." << std::endl;
+        return;
     }
     
-    std::string line;
-    // Note: Full deserialization would require parsing the saved data
-    // This is a simplified version showing the structure
+    std::cout << std::left << std::setw(14) << "Structure" << std::right
+              << std::setw(14) << "Live bytes" << std::setw(13) << "Allocations"
+              << std::setw(11) << "Objects" << std::setw(12) << "Bytes/obj"
+              << std::setw(12) << "Bytes/alloc" << std::endl;
+    long long totalBytes = 0;
+    long long totalAllocations = 0;
+    for (const auto& row : rows) {
+        std::cout << std::left << std::setw(14) << row.structure << std::right
+                  << std::setw(14) << row.bytes << std::setw(13) << row.allocations;
+        if (row.objects > 0) {
+            std::cout << std::setw(11) << row.objects << std::setw(12)
+                      << row.bytes / static_cast<long long>(row.objects);
+        } else {
+            std::cout << std::setw(11) << "-" << std::setw(12) << "-";
+        }
+        std::cout << std::setw(12) << (row.allocations > 0 ? row.bytes / row.allocations : 0)
+                  << std::endl;
+        totalBytes += row.bytes;
+        totalAllocations += row.allocations;
+    }
+    std::cout << std::left << std::setw(14) << "Total" << std::right
+              << std::setw(14) << totalBytes << std::setw(13) << totalAllocations << std::endl;
     
-    file.close();
-    std::cout << "\nData loaded successfully from " << filename << std::endl;
+    // The rest of the resident set is code, stacks, allocator overhead and
+    // mapped files such as a lazy catalog's snapshot
+    std::ifstream statm("/proc/self/statm");
+    unsigned long long pages = 0;
+    unsigned long long resident = 0;
+    if (statm >> pages >> resident) {
+        std::cout << "Resident set: " << resident * sysconf(_SC_PAGESIZE) << " bytes" << std::endl;
+    }
+}
+
+// ==================== Shared Catalog ====================
+
+void Library::publishSharedCatalog(const std::string& regionName, int itemCapacity,
+                                   int userCapacity) {
+    std::lock_guard<std::mutex> lock(stateMutex);
+    if (static_cast<size_t>(itemCapacity) < items.size() ||
+        static_cast<size_t>(userCapacity) < users.size()) {
+        throw InvalidOperationException("Shared catalog capacity is below the current catalog size");
+    }
+    
+    sharedCatalog.reset();
+    sharedCatalog = SharedCatalog::create(regionName, itemCapacity, userCapacity);
+    try {
+        fillSharedCatalog();
+    } catch (const LibraryException&) {
+        sharedCatalog.reset();
+        throw;
+    }
+    sharedCatalog->markReady();
+    
+    std::cout << "Shared catalog published as " << regionName << " ("
+              << sharedCatalog->getMappedSize() / 1024 << " KB, room for "
+              << itemCapacity << " items and " << userCapacity << " users)." << std::endl;
+}
+
+void Library::unpublishSharedCatalog() {
+    std::lock_guard<std::mutex> lock(stateMutex);
+    // Readers that still have the region mapped keep working off the last
+    // state; destroying it marks the region retired so they can tell
+    sharedCatalog.reset();
+}
+
+void Library::shareUser(const std::shared_ptr<Person>& user) {
+    if (sharedCatalog) {
+        try {
+            writeSharedUser(user);
+        } catch (const LibraryException&) {
+            growSharedCatalog();
+        }
+    }
+}
+
+void Library::shareItem(const std::shared_ptr<LibraryItem>& item) {
+    if (sharedCatalog) {
+        try {
+            writeSharedItem(item);
+        } catch (const LibraryException&) {
+            growSharedCatalog();
+        }
+    }
+}
+
+void Library::writeSharedUser(const std::shared_ptr<Person>& user) {
+    // Readers show the role's total limit and its loan period for books
+    const LoanRule& terms = loanPolicy.getRule(user->getPatronRole(), ItemKind::Book);
+    sharedCatalog->addUser(user->getUserId(), user->getName(), user->getEmail(),
+                           user->getRole(), loanPolicy.getMaxTotalLoans(user->getPatronRole()),
+                           terms.loanDays,
+                           stats.getUserStats(user->getUserId()).currentlyBorrowed);
+}
+
+void Library::writeSharedItem(const std::shared_ptr<LibraryItem>& item) {
+    // Readers show the fee a student would pay
+    sharedCatalog->addItem(item->getItemId(), item->getTitle(), item->getPublisher(),
+                           item->getItemType(), item->getPublicationYear(),
+                           item->getTotalCopies(), item->getAvailableCopies(),
+                           loanPolicy.getRule(PatronRole::Student,
+                                              item->getItemKind()).lateFeePerDay);
+}
+
+void Library::fillSharedCatalog() {
+    for (const auto& pair : users) {
+        writeSharedUser(pair.second);
+    }
+    items.forEach([this](const std::shared_ptr<LibraryItem>& item) {
+        writeSharedItem(item);
+    });
+}
+
+void Library::growSharedCatalog() {
+    // The record that did not fit is already applied and journaled, so
+    // copy everything, it included, into a region twice the size
+    std::unique_ptr<SharedCatalog> previous = std::move(sharedCatalog);
+    const std::string regionName = previous->getName();
+    int itemCapacity = static_cast<int>(std::max<size_t>(previous->getItemCapacity(),
+                                                         items.size()) * 2);
+    int userCapacity = static_cast<int>(std::max<size_t>(previous->getUserCapacity(),
+                                                         users.size()) * 2);
+    try {
+        sharedCatalog = SharedCatalog::create(regionName, itemCapacity, userCapacity);
+        fillSharedCatalog();
+    } catch (const LibraryException& e) {
+        // Both regions are retired as they are destroyed, so readers learn
+        // their view is stale instead of serving it as live
+        sharedCatalog.reset();
+        previous.reset();
+        std::cerr << "Catalog not shared: " << e.what() << std::endl;
+        return;
+    }
+    sharedCatalog->markReady();
+
+    // Readers still mapping the old region switch over when they see it retired
+    previous->retire();
+    std::cout << "Shared catalog " << regionName << " grown to room for " << itemCapacity
+              << " items and " << userCapacity << " users." << std::endl;
+}
+
+void Library::syncSharedUser(const std::string& userId) {
+    if (sharedCatalog) {
+        sharedCatalog->updateUserLoans(userId, stats.getUserStats(userId).currentlyBorrowed);
+    }
+}
+
+void Library::syncSharedItem(const std::string& itemId) {
+    if (sharedCatalog) {
+        auto item = getItem(itemId);
+        sharedCatalog->updateItemCopies(itemId, item->getTotalCopies(), item->getAvailableCopies());
+    }
+}
+
+// ==================== Task Pool ====================
+
+void Library::configureTaskPool(unsigned threadCount) {
+    // Reports use the pool without the state lock, so resize it only
+    // while nothing else is running (at startup)
+    std::lock_guard<std::mutex> lock(stateMutex);
+    taskPool.reset(new TaskPool(workersFor(threadCount)));
+}
+
+unsigned Library::getTaskPoolSize() const {
+    return taskPool->getParallelism();
+}
+
+void Library::shutdownTaskPool() {
+    taskPool->shutdown();
+}
+
+// ==================== Workload Traces ====================
+
+void Library::startTraceRecording(const std::string& filename) {
+    // The recording starts from exactly the state saved, as nothing can
+    // change it until the lock is released
+    std::lock_guard<std::mutex> lock(stateMutex);
+    writeSnapshot(TraceRecorder::snapshotFileFor(filename));
+    traceRecorder.reset(new TraceRecorder(filename));
+}
+
+void Library::stopTraceRecording() {
+    traceRecorder.reset();
 }
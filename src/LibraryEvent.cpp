@@ -0,0 +1,176 @@
+#include "../include/LibraryEvent.h"
+#include "../include/Exceptions.h"
+
+namespace {
+
+const char* const TYPE_NAMES[] = {
+    "USER_REGISTERED", "ITEM_ADDED", "COPIES_ADDED", "ITEM_BORROWED", "ITEM_RETURNED",
+    "HOLD_PLACED", "HOLD_CANCELLED", "FINES_ACCRUED", "FINE_PAID", "FINE_WAIVED"
+};
+const int TYPE_COUNT = sizeof(TYPE_NAMES) / sizeof(TYPE_NAMES[0]);
+
+std::string amountToString(double amount) {
+    std::string text;
+    RecordWriter out(text);
+    out.field(amount);
+    return text;
+}
+
+} // namespace
+
+LibraryEvent::LibraryEvent(EventType t, time_t ts, const std::vector<std::string>& f)
+    : type(t), sequence(0), timestamp(ts), fields(f) {}
+
+// ==================== Factories ====================
+
+LibraryEvent LibraryEvent::userRegistered(const std::string& userRecord, time_t now) {
+    return LibraryEvent(EventType::UserRegistered, now, splitRecord(userRecord));
+}
+
+LibraryEvent LibraryEvent::itemAdded(const std::string& itemRecord, time_t now) {
+    return LibraryEvent(EventType::ItemAdded, now, splitRecord(itemRecord));
+}
+
+LibraryEvent LibraryEvent::copiesAdded(const std::string& itemId, int count, time_t now) {
+    return LibraryEvent(EventType::CopiesAdded, now, {itemId, std::to_string(count)});
+}
+
+LibraryEvent LibraryEvent::itemBorrowed(const std::string& userId, const std::string& itemId,
+                                        const std::string& transactionId, time_t dueDate,
+                                        double lateFeePerDay, double fineCap, time_t now) {
+    return LibraryEvent(EventType::ItemBorrowed, now,
+                        {userId, itemId, transactionId, std::to_string(dueDate),
+                         amountToString(lateFeePerDay), amountToString(fineCap)});
+}
+
+LibraryEvent LibraryEvent::itemReturned(const std::string& userId, const std::string& itemId,
+                                        time_t now) {
+    return LibraryEvent(EventType::ItemReturned, now, {userId, itemId});
+}
+
+LibraryEvent LibraryEvent::holdPlaced(const std::string& userId, const std::string& itemId,
+                                      time_t now) {
+    return LibraryEvent(EventType::HoldPlaced, now, {userId, itemId});
+}
+
+LibraryEvent LibraryEvent::holdCancelled(const std::string& userId, const std::string& itemId,
+                                         time_t now) {
+    return LibraryEvent(EventType::HoldCancelled, now, {userId, itemId});
+}
+
+LibraryEvent LibraryEvent::finesAccrued(time_t now) {
+    return LibraryEvent(EventType::FinesAccrued, now, {});
+}
+
+LibraryEvent LibraryEvent::finePaid(const std::string& userId, double amount, time_t now) {
+    return LibraryEvent(EventType::FinePaid, now, {userId, amountToString(amount)});
+}
+
+LibraryEvent LibraryEvent::fineWaived(const std::string& userId, double amount,
+                                      const std::string& reason, time_t now) {
+    return LibraryEvent(EventType::FineWaived, now, {userId, amountToString(amount), reason});
+}
+
+// ==================== Accessors ====================
+
+const std::string& LibraryEvent::field(size_t index) const {
+    if (index >= fields.size()) {
+        throw InvalidOperationException("Malformed " + typeToString(type) + " event");
+    }
+    return fields[index];
+}
+
+bool LibraryEvent::isCirculation() const {
+    switch (type) {
+        case EventType::CopiesAdded:
+        case EventType::ItemBorrowed:
+        case EventType::ItemReturned:
+        case EventType::HoldPlaced:
+        case EventType::HoldCancelled:
+            return true;
+        default:
+            return false;
+    }
+}
+
+const std::string& LibraryEvent::getItemKey() const {
+    return type == EventType::CopiesAdded ? field(0) : field(1);
+}
+
+// ==================== Serialization ====================
+
+void LibraryEvent::writeTo(RecordWriter& out) const {
+    out.field(sequence).field(timestamp).field(TYPE_NAMES[static_cast<int>(type)]);
+    for (const auto& f : fields) {
+        out.field(f);
+    }
+}
+
+std::string LibraryEvent::serialize() const {
+    std::string line;
+    RecordWriter out(line);
+    writeTo(out);
+    return line;
+}
+
+LibraryEvent LibraryEvent::parse(const std::string& line) {
+    std::vector<std::string> parts = splitRecord(line);
+    if (parts.size() < 3) {
+        throw InvalidOperationException("Malformed journal line: " + line);
+    }
+
+    int typeIndex = -1;
+    for (int i = 0; i < TYPE_COUNT; i++) {
+        if (parts[2] == TYPE_NAMES[i]) {
+            typeIndex = i;
+            break;
+        }
+    }
+    if (typeIndex < 0) {
+        throw InvalidOperationException("Unknown event type: " + parts[2]);
+    }
+
+    LibraryEvent event(static_cast<EventType>(typeIndex),
+                       static_cast<time_t>(std::stoll(parts[1])),
+                       std::vector<std::string>(parts.begin() + 3, parts.end()));
+    event.setSequence(std::stoull(parts[0]));
+    return event;
+}
+
+std::string LibraryEvent::typeToString(EventType type) {
+    return TYPE_NAMES[static_cast<int>(type)];
+}
+
+std::vector<std::string> LibraryEvent::splitRecord(const std::string& record) {
+    std::vector<std::string> parts;
+    if (record.find('\\') != std::string::npos) {
+        // Undo RecordWriter's escaping
+        std::string part;
+        for (size_t i = 0; i < record.size(); i++) {
+            char c = record[i];
+            if (c == '\\' && i + 1 < record.size()) {
+                char escaped = record[++i];
+                part += escaped == 'n' ? '\n' : escaped == 'r' ? '\r' : escaped;
+            } else if (c == '|') {
+                parts.push_back(part);
+                part.clear();
+            } else {
+                part += c;
+            }
+        }
+        parts.push_back(part);
+        return parts;
+    }
+
+    size_t start = 0;
+    while (true) {
+        size_t end = record.find('|', start);
+        if (end == std::string::npos) {
+            parts.push_back(record.substr(start));
+            break;
+        }
+        parts.push_back(record.substr(start, end - start));
+        start = end + 1;
+    }
+    return parts;
+}
@@ -1,35 +1,95 @@
 #include "../include/LibraryItem.h"
 #include "../include/Exceptions.h"
-#include <sstream>
 
-LibraryItem::LibraryItem(const std::string& id, const std::string& t, 
-                         const std::string& pub, int year)
-    : itemId(id), title(t), publisher(pub), publicationYear(year), 
-      isAvailable(true), currentBorrower("") {}
+LibraryItem::LibraryItem(const std::string& id, const std::string& t,
+                         const std::string& pub, int year, ItemKind kind)
+    : itemId(id), title(t), publisher(pub), publicationYear(year), itemKind(kind) {
+    // Every title starts with a single physical copy
+    addCopies(1);
+}
 
 LibraryItem::~LibraryItem() {
     // Base class destructor
 }
 
-void LibraryItem::borrowItem(const std::string& userId) {
-    if (!isAvailable) {
+std::string LibraryItem::borrowItem(const std::string& userId) {
+    int copyIndex = holdings.checkoutAny(userId);
+    if (copyIndex < 0) {
         throw ItemAlreadyBorrowedException(itemId);
     }
-    isAvailable = false;
-    currentBorrower = userId;
+    return holdings.getCopy(copyIndex).barcode;
 }
 
-void LibraryItem::returnItem() {
-    if (isAvailable) {
+void LibraryItem::returnItem(const std::string& barcode) {
+    int copyIndex = holdings.findCopy(barcode);
+    if (copyIndex < 0 || holdings.getCopy(copyIndex).state != CopyState::OnLoan) {
         throw InvalidOperationException("Item is not currently borrowed: " + itemId);
     }
-    isAvailable = true;
-    currentBorrower = "";
+    holdings.checkin(copyIndex);
+}
+
+std::string LibraryItem::reserveCopy(const std::string& userId) {
+    int copyIndex = holdings.reserveAny(userId);
+    if (copyIndex < 0) {
+        return "";
+    }
+    return holdings.getCopy(copyIndex).barcode;
+}
+
+void LibraryItem::lendReservedCopy(const std::string& barcode, const std::string& userId) {
+    holdings.lendReserved(holdings.findCopy(barcode), userId);
+}
+
+void LibraryItem::releaseReservedCopy(const std::string& barcode) {
+    holdings.releaseReserved(holdings.findCopy(barcode));
+}
+
+void LibraryItem::restoreCopy(const std::string& barcode, CopyState state,
+                              const std::string& userId) {
+    int copyIndex = holdings.findCopy(barcode);
+    if (copyIndex < 0) {
+        throw InvalidOperationException("Unknown copy barcode: " + barcode);
+    }
+    holdings.restoreCopy(copyIndex, state, userId);
+}
+
+void LibraryItem::addCopies(int count) {
+    if (count <= 0) {
+        throw InvalidOperationException("Copy count must be positive");
+    }
+    for (int i = 0; i < count; i++) {
+        holdings.addCopy(itemId + "-C" + std::to_string(holdings.getTotalCopies() + 1));
+    }
+}
+
+std::string LibraryItem::getCurrentBorrower() const {
+    // Only meaningful for single-copy titles
+    if (holdings.getTotalCopies() == 1) {
+        return holdings.getCopy(0).borrower;
+    }
+    return "";
+}
+
+void LibraryItem::displayAvailability() const {
+    int available = holdings.getAvailableCopies();
+    int total = holdings.getTotalCopies();
+
+    std::cout << "Status: " << (available > 0 ? "Available" : "Borrowed") << std::endl;
+    if (total > 1) {
+        std::cout << "Copies Available: " << available << " of " << total << std::endl;
+    } else if (available == 0) {
+        std::cout << "Current Borrower: " << getCurrentBorrower() << std::endl;
+    }
+}
+
+void LibraryItem::writeTo(RecordWriter& out) const {
+    out.field(itemId).field(title).field(publisher).field(publicationYear)
+       .field(holdings.getTotalCopies()).field(holdings.getAvailableCopies());
 }
 
 std::string LibraryItem::serialize() const {
-    std::ostringstream oss;
-    oss << itemId << "|" << title << "|" << publisher << "|" 
-        << publicationYear << "|" << isAvailable << "|" << currentBorrower;
-    return oss.str();
+    std::string record;
+    RecordWriter out(record);
+    writeTo(out);
+    return record;
 }
@@ -0,0 +1,945 @@
+#include "../include/Library.h"
+#include "../include/Exceptions.h"
+#include "../include/MemoryAccounting.h"
+#include <iostream>
+#include <algorithm>
+#include <fstream>
+#include <sstream>
+#include <thread>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <functional>
+#include <unordered_map>
+#include <fcntl.h>
+#include <unistd.h>
+
+// Library snapshots, the event journal and crash recovery.
+//
+// Every mutation is applied through an apply*() function and then appended
+// to the journal. A checkpoint saves the records changed since the last one
+// as a delta after the base snapshot, or compacts everything into a new base.
+// Recovery loads the base and its deltas and replays the journal tail through
+// the same apply*() functions.
+
+// The full-text index is saved beside each snapshot under this suffix
+static const std::string FULL_TEXT_SUFFIX = ".fts";
+
+// Snapshot bytes buffered between writes
+static const size_t SNAPSHOT_CHUNK = 1 << 20;
+
+// Delta snapshots are chained beside the base under this suffix
+static const std::string DELTA_SUFFIX = ".delta";
+
+// Deltas appended before the next save compacts them into a new base
+static const size_t MAX_DELTA_BLOCKS = 8;
+
+// Push a written file's contents to disk
+static void syncFile(const std::string& filename) {
+    int fd = ::open(filename.c_str(), O_RDONLY);
+    if (fd < 0) {
+        throw FileIOException(filename);
+    }
+    bool synced = ::fsync(fd) == 0;
+    ::close(fd);
+    if (!synced) {
+        throw FileIOException(filename);
+    }
+}
+
+// Make files created or renamed beside 'filename' survive a power loss
+static void syncDirectoryOf(const std::string& filename) {
+    size_t slash = filename.rfind('/');
+    std::string directory = slash == std::string::npos ? "."
+                          : slash == 0 ? "/" : filename.substr(0, slash);
+    int fd = ::open(directory.c_str(), O_RDONLY | O_DIRECTORY);
+    if (fd < 0) {
+        throw FileIOException(directory);
+    }
+    bool synced = ::fsync(fd) == 0;
+    ::close(fd);
+    if (!synced) {
+        throw FileIOException(directory);
+    }
+}
+
+// Kind, ID and total copies of an item record, leaving the rest undecoded
+static void itemHotFields(const char* record, size_t length, std::string& kind,
+                          std::string& itemId, int& totalCopies) {
+    // Common prefix: TYPE|itemId|title|publisher|year|totalCopies|...
+    if (std::memchr(record, '\\', length) != nullptr) {
+        std::vector<std::string> fields = LibraryEvent::splitRecord(std::string(record, length));
+        kind = fields.at(0);
+        itemId = fields.at(1);
+        totalCopies = std::stoi(fields.at(5));
+        return;
+    }
+
+    const char* end = record + length;
+    const char* start = record;
+    for (int field = 0; field <= 5; field++) {
+        const char* bar = static_cast<const char*>(std::memchr(start, '|', end - start));
+        if (bar == nullptr && field < 5) {
+            throw InvalidOperationException("Malformed item record: " + std::string(record, length));
+        }
+        if (field == 0) {
+            kind.assign(start, bar);
+        } else if (field == 1) {
+            itemId.assign(start, bar);
+        } else if (field == 5) {
+            totalCopies = std::stoi(std::string(start, bar != nullptr ? bar : end));
+        }
+        start = bar + 1;
+    }
+}
+
+// getItemType() of the item a record of this kind decodes to
+static std::string itemTypeOfKind(const std::string& kind) {
+    if (kind == "BOOK") {
+        return "Book";
+    }
+    if (kind == "MAGAZINE") {
+        return "Magazine";
+    }
+    if (kind == "JOURNAL") {
+        return "Journal";
+    }
+    throw InvalidOperationException("Malformed item record: " + kind);
+}
+
+// ==================== Journal ====================
+
+void Library::requireWritableJournal() const {
+    if (journal.hasFailed()) {
+        throw InvalidOperationException("Journal " + journal.getPath() +
+                                        " failed; changes are refused until recovery");
+    }
+}
+
+void Library::recordEvent(LibraryEvent event, EventJournal::DurableCallback onDurable) {
+    MemoryScope scope(MemoryTag::Journal);
+    event.setSequence(++lastSequence);
+    if (onDurable) {
+        journal.appendDeferred(event, std::move(onDurable));
+    } else if (journal.isOpen()) {
+        // The change is already applied; say so rather than look refused
+        try {
+            journal.append(event);
+        } catch (const FileIOException& e) {
+            throw NotDurableException(e.what());
+        }
+    }
+}
+
+void Library::applyEvent(const LibraryEvent& event) {
+    time_t now = event.getTimestamp();
+
+    switch (event.getType()) {
+        case EventType::UserRegistered:
+            applyAddUser(createUser(event.getFields()));
+            break;
+        case EventType::ItemAdded:
+            applyAddItem(createItem(event.getFields()));
+            break;
+        case EventType::CopiesAdded:
+            applyAddCopies(event.field(0), std::stoi(event.field(1)), now);
+            break;
+        case EventType::ItemBorrowed: {
+            double lateFeePerDay;
+            double fineCap;
+            if (event.getFields().size() >= 6) {
+                lateFeePerDay = std::stod(event.field(4));
+                fineCap = std::stod(event.field(5));
+            } else {
+                // Journaled before loans kept their terms
+                const LoanRule& terms = loanTerms(*getUser(event.field(0)),
+                                                  *getItem(event.field(1)));
+                lateFeePerDay = terms.lateFeePerDay;
+                fineCap = terms.fineCap;
+            }
+            applyBorrow(event.field(0), event.field(1), event.field(2),
+                        static_cast<time_t>(std::stoll(event.field(3))), lateFeePerDay, fineCap,
+                        now);
+            break;
+        }
+        case EventType::ItemReturned:
+            applyReturn(event.field(0), event.field(1), now);
+            break;
+        case EventType::HoldPlaced:
+            applyPlaceHold(event.field(0), event.field(1), now);
+            break;
+        case EventType::HoldCancelled:
+            applyCancelHold(event.field(0), event.field(1), now);
+            break;
+        case EventType::FinesAccrued:
+            applyFineAccrual(now);
+            break;
+        case EventType::FinePaid:
+            applyLedgerCredit(event.field(0), std::stod(event.field(1)),
+                              LedgerEntryType::Payment, "Payment", now);
+            break;
+        case EventType::FineWaived:
+            applyLedgerCredit(event.field(0), std::stod(event.field(1)),
+                              LedgerEntryType::Waiver, event.field(2), now);
+            break;
+    }
+}
+
+// A journaled event was applied once already, so failing to apply it again
+// means the recovered state has diverged: recovery must stop
+static InvalidOperationException replayFailure(const LibraryEvent& event, const std::string& why) {
+    return InvalidOperationException("Journal event " + std::to_string(event.getSequence()) +
+                                     " does not replay (" + why + ")");
+}
+
+size_t Library::replayEvents(const std::vector<LibraryEvent>& events, size_t first) {
+    size_t applied = 0;
+    size_t i = first;
+
+    while (i < events.size()) {
+        if (!events[i].isCirculation()) {
+            // Registrations, new titles and fine runs touch many partitions:
+            // apply them on their own as barriers between parallel runs
+            try {
+                applyEvent(events[i]);
+                applied++;
+            } catch (const std::exception& e) {
+                throw replayFailure(events[i], e.what());
+            }
+            lastSequence = events[i].getSequence();
+            i++;
+            continue;
+        }
+
+        size_t end = i;
+        while (end < events.size() && events[end].isCirculation()) {
+            end++;
+        }
+        applied += replayCirculation(events, i, end);
+        lastSequence = events[end - 1].getSequence();
+        i = end;
+    }
+
+    return applied;
+}
+
+size_t Library::replayCirculation(const std::vector<LibraryEvent>& events,
+                                  size_t begin, size_t end) {
+    // Partition by item: every event of one item runs in the same task in
+    // journal order, while different items proceed in parallel. Borrows
+    // commit their own transaction log slot, so tasks share nothing else.
+    size_t partitions = std::min<size_t>(taskPool->getParallelism(), (end - begin) / 1024 + 1);
+    std::vector<size_t> appliedCounts(partitions, 0);
+    std::vector<size_t> failedAt(partitions, end); // First event each partition could not apply
+    std::vector<std::string> failures(partitions);
+    std::hash<std::string> hasher;
+
+    // Open-loan entries are created on first use; create the ones this
+    // run needs now so no task inserts into the outer map
+    for (size_t i = begin; i < end; i++) {
+        openLoans[events[i].getItemKey()];
+    }
+
+    taskPool->parallelFor(0, partitions, 1, [&](size_t first, size_t last) {
+        for (size_t p = first; p < last; p++) {
+            for (size_t i = begin; i < end; i++) {
+                if (hasher(events[i].getItemKey()) % partitions != p) {
+                    continue;
+                }
+                try {
+                    applyEvent(events[i]);
+                    appliedCounts[p]++;
+                } catch (const std::exception& e) {
+                    // The rest of this item's events would build on a bad state
+                    failedAt[p] = i;
+                    failures[p] = e.what();
+                    break;
+                }
+            }
+        }
+    });
+
+    // Report the earliest failure in journal order, whatever thread hit it
+    size_t firstFailure = 0;
+    for (size_t p = 1; p < partitions; p++) {
+        if (failedAt[p] < failedAt[firstFailure]) {
+            firstFailure = p;
+        }
+    }
+    if (failedAt[firstFailure] < end) {
+        throw replayFailure(events[failedAt[firstFailure]], failures[firstFailure]);
+    }
+
+    size_t applied = 0;
+    for (size_t count : appliedCounts) {
+        applied += count;
+    }
+    return applied;
+}
+
+// ==================== Recovery ====================
+
+bool Library::recover(const std::string& snapshotFile, const std::string& journalFile) {
+    std::lock_guard<std::mutex> lock(stateMutex);
+    auto start = std::chrono::steady_clock::now();
+    bool restored = false;
+
+    std::ifstream probe(snapshotFile);
+    if (probe.good()) {
+        probe.close();
+        readSnapshot(snapshotFile);
+        restored = true;
+    }
+
+    std::vector<LibraryEvent> events = EventJournal::readAll(journalFile, *taskPool);
+
+    // The journal may still hold events the snapshot already covers
+    size_t first = 0;
+    while (first < events.size() && events[first].getSequence() <= lastSequence) {
+        first++;
+    }
+
+    size_t applied = replayEvents(events, first);
+    if (first < events.size()) {
+        restored = true;
+        if (!indexesDeferred) {
+            rebuildCoBorrows();
+        }
+    }
+
+    journal.open(journalFile);
+
+    if (restored) {
+        auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(
+            std::chrono::steady_clock::now() - start);
+        std::cout << "Recovered " << users.size() << " user(s) and " << items.size()
+                  << " item(s); replayed " << applied << " of " << (events.size() - first)
+                  << " journal event(s) in " << elapsed.count() << " ms." << std::endl;
+    }
+    return restored;
+}
+
+void Library::checkpoint(const std::string& snapshotFile) {
+    std::lock_guard<std::mutex> lock(stateMutex);
+    std::string deltaFile = snapshotFile + DELTA_SUFFIX;
+
+    // Fold the chain into a new base once replaying it costs more than it saves
+    bool compact = baseBytes == 0 || deltaLog.getPath() != deltaFile ||
+                   deltaLog.getBlockCount() >= MAX_DELTA_BLOCKS ||
+                   deltaLog.getByteCount() > baseBytes / 2;
+
+    if (compact) {
+        // Write beside the old snapshot and swap, so a crash mid-write leaves
+        // the previous snapshot plus a complete journal
+        std::string tempFile = snapshotFile + ".tmp";
+        size_t bytes = writeSnapshot(tempFile);
+        // A stale index left by a crash between the renames is detected by its
+        // sequence stamp and rebuilt
+        std::string indexFile = snapshotFile + FULL_TEXT_SUFFIX;
+        std::string tempIndexFile = tempFile + FULL_TEXT_SUFFIX;
+        syncFile(tempFile);
+        syncFile(tempIndexFile);
+        if (std::rename(tempIndexFile.c_str(), indexFile.c_str()) != 0) {
+            throw FileIOException(indexFile);
+        }
+        if (std::rename(tempFile.c_str(), snapshotFile.c_str()) != 0) {
+            throw FileIOException(snapshotFile);
+        }
+        // Blocks left by a crash before this point end at or before the new
+        // base's sequence and are skipped on load
+        deltaLog.reset(deltaFile);
+        syncDirectoryOf(snapshotFile);
+        baseBytes = bytes;
+        std::cout << "\nData saved successfully to " << snapshotFile << std::endl;
+    } else if (lastSequence != savedSequence) {
+        std::string body;
+        writeRecords(body, true, std::function<void()>());
+        deltaLog.append(savedSequence, lastSequence, body);
+        std::cout << "\nSaved " << changes.size() << " changed record(s) to " << deltaFile
+                  << std::endl;
+    }
+
+    changes.clear();
+    ledgerSaved = fineLedger.getEntryCount();
+    savedSequence = lastSequence;
+
+    // Only now is every journaled event on disk in the base or a delta;
+    // any failure above leaves the journal to replay them
+    if (journal.isOpen()) {
+        journal.truncate();
+    }
+}
+
+// ==================== Snapshots ====================
+
+// Records of a base snapshot and its deltas, folded by key before any of
+// them is applied, so a later block simply replaces an earlier record
+struct Library::SnapshotImage {
+    unsigned long long sequence = 0;
+    std::map<std::string, std::shared_ptr<Person>> users;
+    std::map<std::string, std::shared_ptr<LibraryItem>> items;
+    std::map<size_t, Transaction> transactions; // Keyed by log index
+    std::vector<std::vector<std::string>> holds;
+    std::vector<LedgerEntry> ledger;
+    bool lazy = false;       // Base item records go to the store undecoded
+    size_t lazyItemCount = 0;
+    bool inDelta = false;
+    std::vector<std::string> addedItems; // Items first seen in a delta
+    bool legacyTerms = false;            // Some loans predate stored loan terms
+};
+
+void Library::saveToFile(const std::string& filename) const {
+    std::lock_guard<std::mutex> lock(stateMutex);
+    writeSnapshot(filename);
+    std::cout << "\nData saved successfully to " << filename << std::endl;
+}
+
+void Library::loadFromFile(const std::string& filename) {
+    std::lock_guard<std::mutex> lock(stateMutex);
+    readSnapshot(filename);
+}
+
+size_t Library::writeSnapshot(const std::string& filename) const {
+    // The full-text index is saved beside the snapshot, so it must exist
+    buildDeferredIndexes();
+    MemoryScope scope(MemoryTag::Snapshot);
+
+    std::ofstream file(filename, std::ios::binary);
+    if (!file.is_open()) {
+        throw FileIOException(filename);
+    }
+
+    // Records are built in one reused buffer and written in large chunks
+    std::string buffer;
+    buffer.reserve(SNAPSHOT_CHUNK + SNAPSHOT_CHUNK / 8);
+    size_t bytes = 0;
+    auto flush = [&]() {
+        file.write(buffer.data(), buffer.size());
+        bytes += buffer.size();
+        buffer.clear();
+    };
+
+    // Journal position the snapshot covers
+    RecordWriter out(buffer);
+    out.field("SNAPSHOT").field(lastSequence);
+    out.endRecord();
+
+    writeRecords(buffer, false, flush);
+
+    flush();
+    file.close();
+    if (!file) {
+        throw FileIOException(filename);
+    }
+    fullTextIndex.save(filename + FULL_TEXT_SUFFIX, lastSequence);
+    return bytes;
+}
+
+void Library::writeRecords(std::string& buffer, bool changedOnly,
+                           const std::function<void()>& flush) const {
+    RecordWriter out(buffer);
+    auto endRecord = [&]() {
+        out.endRecord();
+        if (flush && buffer.size() >= SNAPSHOT_CHUNK) {
+            flush();
+        }
+    };
+    auto marker = [&](const char* name) {
+        out.field(name);
+        endRecord();
+    };
+
+    // Save users
+    marker("USERS_START");
+    if (changedOnly) {
+        for (const auto& userId : changes.getUsers()) {
+            users.at(userId)->writeTo(out);
+            endRecord();
+        }
+    } else {
+        for (const auto& pair : users) {
+            pair.second->writeTo(out);
+            endRecord();
+        }
+    }
+    marker("USERS_END");
+
+    // Save items
+    marker("ITEMS_START");
+    if (changedOnly) {
+        for (const auto& itemId : changes.getItems()) {
+            items.find(itemId)->writeTo(out);
+            endRecord();
+        }
+    } else {
+        items.scan([&](const std::shared_ptr<LibraryItem>& item) {
+            item->writeTo(out);
+            endRecord();
+        });
+    }
+    marker("ITEMS_END");
+
+    // Save transactions
+    marker("TRANSACTIONS_START");
+    if (changedOnly) {
+        for (size_t index : changes.getTransactions()) {
+            transactions.get(index).writeTo(out);
+            endRecord();
+        }
+    } else {
+        transactions.forEach([&](const Transaction& trans) {
+            trans.writeTo(out);
+            endRecord();
+        });
+    }
+    marker("TRANSACTIONS_END");
+
+    // Save holds: waiting lists in service order, then the pickup shelf.
+    // Queues are small and reorder as a whole, so a delta carries them all.
+    marker("HOLDS_START");
+    for (const auto& entry : holds.getWaitingEntries()) {
+        out.field("WAITING").field(entry.first).field(entry.second);
+        endRecord();
+    }
+    for (const auto& hold : holds.getReadyHolds()) {
+        out.field("READY").field(hold.itemId).field(hold.userId).field(hold.barcode)
+           .field(hold.expiresAt);
+        endRecord();
+    }
+    marker("HOLDS_END");
+
+    // Save the fine ledger; the reference goes last as it is free text.
+    // The ledger is append-only, so a delta carries the entries since the last save.
+    marker("LEDGER_START");
+    // Replay posts from several threads, so order by time rather than by arrival
+    std::vector<LedgerEntry> entries = changedOnly ? fineLedger.getEntriesSince(ledgerSaved)
+                                                   : fineLedger.getEntries();
+    std::stable_sort(entries.begin(), entries.end(),
+                     [](const LedgerEntry& a, const LedgerEntry& b) {
+                         if (a.timestamp != b.timestamp) {
+                             return a.timestamp < b.timestamp;
+                         }
+                         if (a.userId != b.userId) {
+                             return a.userId < b.userId;
+                         }
+                         return a.reference < b.reference;
+                     });
+    for (const auto& entry : entries) {
+        out.field(FineLedger::typeToString(entry.type)).field(entry.amount)
+           .field(entry.timestamp).field(entry.userId).field(entry.reference);
+        endRecord();
+    }
+    marker("LEDGER_END");
+}
+
+void Library::readSnapshot(const std::string& filename) {
+    MemoryScope scope(MemoryTag::Snapshot);
+    std::unique_ptr<MappedFile> base(new MappedFile(filename));
+
+    resetState();
+
+    SnapshotImage image;
+    image.lazy = lazyCatalog;
+    parseRecords(base->getData(), base->getSize(), filename, image);
+    baseBytes = base->getSize();
+    unsigned long long baseSequence = image.sequence;
+    size_t baseItemCount = image.items.size() + image.lazyItemCount;
+
+    // Fold in the delta chain written since this base
+    size_t deltaCount = 0;
+    image.inDelta = true;
+    for (const auto& block : deltaLog.open(filename + DELTA_SUFFIX)) {
+        if (block.toSequence <= image.sequence) {
+            continue; // Left over from before the base was compacted
+        }
+        if (block.fromSequence != image.sequence) {
+            // The journal covers what is missing; start a fresh chain next save
+            baseBytes = 0;
+            break;
+        }
+        parseRecords(block.body.data(), block.body.size(),
+                     filename + DELTA_SUFFIX + " block " + std::to_string(deltaCount + 1), image);
+        image.sequence = block.toSequence;
+        deltaCount++;
+    }
+
+    materialize(image);
+    if (image.legacyTerms) {
+        baseBytes = 0; // Rewrite the old records with their terms on the next save
+    }
+
+    std::string indexFile = filename + FULL_TEXT_SUFFIX;
+    MemoryScope indexScope(MemoryTag::Indexes);
+    if (image.lazy) {
+        // Undecoded records point into the mapping, and the secondary
+        // indexes wait for the first query that needs them
+        items.adoptMapping(std::move(base));
+        deferredFullTextFile = indexFile;
+        deferredSequence = baseSequence;
+        deferredItemCount = baseItemCount;
+        unindexedItems = image.addedItems;
+        indexesDeferred = true;
+    } else if (fullTextIndex.load(indexFile, baseSequence, baseItemCount)) {
+        // Reuse the full-text index saved with the base unless it belongs to
+        // another snapshot, and add the titles the deltas brought in
+        for (const auto& itemId : image.addedItems) {
+            fullTextIndex.add(*items.find(itemId));
+        }
+    } else {
+        items.scan([this](const std::shared_ptr<LibraryItem>& item) {
+            fullTextIndex.add(*item);
+        });
+    }
+    if (!image.lazy) {
+        rebuildPopularity();
+        rebuildCoBorrows();
+    }
+    rebuildStatistics();
+
+    changes.clear();
+    ledgerSaved = fineLedger.getEntryCount();
+    savedSequence = lastSequence;
+
+    std::cout << "\nData loaded successfully from " << filename;
+    if (deltaCount > 0) {
+        std::cout << " and " << deltaCount << " delta snapshot(s)";
+    }
+    std::cout << std::endl;
+}
+
+void Library::parseRecords(const char* data, size_t size, const std::string& source,
+                           SnapshotImage& image) {
+    std::string section;
+    size_t lineNumber = 0;
+    const char* end = data + size;
+    const char* next = data;
+    while (next < end) {
+        const char* line = next;
+        const char* eol = static_cast<const char*>(std::memchr(line, '\n', end - line));
+        size_t length = (eol != nullptr ? eol : end) - line;
+        next = line + length + 1;
+        lineNumber++;
+        if (length == 0) {
+            continue;
+        }
+        if (length > 6 && std::memcmp(line + length - 6, "_START", 6) == 0) {
+            section.assign(line, length - 6);
+            if (section == "HOLDS") {
+                image.holds.clear(); // Every save carries the queues whole
+            }
+            continue;
+        }
+        if (length > 4 && std::memcmp(line + length - 4, "_END", 4) == 0) {
+            section.clear();
+            continue;
+        }
+
+        // A malformed record fails the load, naming where it is
+        try {
+            if (section == "ITEMS" && image.lazy && !image.inDelta) {
+                // Only the ID and hot fields; the record is decoded on first access.
+                // A delta that changes the item later replaces the entry.
+                MemoryScope itemScope(MemoryTag::Items);
+                std::string kind;
+                std::string itemId;
+                int totalCopies;
+                itemHotFields(line, length, kind, itemId, totalCopies);
+                items.addLazy(itemId, line, length, itemTypeOfKind(kind), totalCopies);
+                image.lazyItemCount++;
+                continue;
+            }
+
+            std::vector<std::string> fields = LibraryEvent::splitRecord(std::string(line, length));
+
+            if (section.empty() && fields[0] == "SNAPSHOT" && fields.size() > 1) {
+                image.sequence = std::stoull(fields[1]);
+            } else if (section == "USERS") {
+                MemoryScope userScope(MemoryTag::Users);
+                auto user = createUser(fields);
+                image.users[user->getUserId()] = user;
+            } else if (section == "ITEMS") {
+                MemoryScope itemScope(MemoryTag::Items);
+                auto item = createItem(fields);
+                int totalCopies = std::stoi(fields.at(5));
+                if (totalCopies > 1) {
+                    item->addCopies(totalCopies - 1);
+                }
+                auto& slot = image.items[item->getItemId()];
+                if (!slot && image.inDelta && !items.contains(item->getItemId())) {
+                    image.addedItems.push_back(item->getItemId());
+                }
+                slot = item;
+            } else if (section == "TRANSACTIONS") {
+                MemoryScope transactionScope(MemoryTag::Transactions);
+                Transaction trans = Transaction::deserialize(fields);
+                image.transactions[transactionIndex(trans.getTransactionId())] = trans;
+            } else if (section == "HOLDS") {
+                MemoryScope holdScope(MemoryTag::Holds);
+                image.holds.push_back(std::move(fields));
+            } else if (section == "LEDGER" && fields.size() >= 5) {
+                // Re-join a reference that contained '|' in snapshots written
+                // before fields were escaped
+                MemoryScope fineScope(MemoryTag::Fines);
+                std::string reference = fields[4];
+                for (size_t i = 5; i < fields.size(); i++) {
+                    reference += "|" + fields[i];
+                }
+                image.ledger.push_back(LedgerEntry{fields[3], reference,
+                                                   FineLedger::typeFromString(fields[0]),
+                                                   std::stod(fields[1]),
+                                                   static_cast<time_t>(std::stoll(fields[2]))});
+            }
+        } catch (const std::exception& e) {
+            throw FileIOException(source + " line " + std::to_string(lineNumber) + " (" +
+                                  e.what() + ")");
+        }
+    }
+}
+
+void Library::materialize(SnapshotImage& image) {
+    lastSequence = image.sequence;
+    users.swap(image.users);
+
+    for (const auto& pair : image.items) {
+        const auto& item = pair.second;
+        MemoryScope itemScope(MemoryTag::Items);
+        items.add(item);
+        if (!image.lazy) {
+            MemoryScope indexScope(MemoryTag::Indexes);
+            titleIndex.add(item->getItemId(), item->getTitle());
+            catalogIndex.add(item);
+            addCompletions(*item, 0);
+            yearIndex.insert(item->getPublicationYear(), item->getItemId());
+        }
+    }
+
+    for (auto& pair : image.transactions) {
+        size_t index = pair.first;
+        Transaction& trans = pair.second;
+        MemoryScope transactionScope(MemoryTag::Transactions);
+        if (!trans.hasLoanTerms()) {
+            // Saved before loans kept their terms: lent on today's
+            const LoanRule& terms = loanTerms(*getUser(trans.getUserId()),
+                                              *getItem(trans.getItemId()));
+            trans.setLoanTerms(terms.lateFeePerDay, terms.fineCap);
+            image.legacyTerms = true;
+        }
+        if (!trans.getIsReturned()) {
+            items.restoreCopy(trans.getItemId(), trans.getCopyBarcode(), CopyState::OnLoan,
+                              trans.getUserId());
+            openLoans[trans.getItemId()][trans.getUserId()] = index;
+            dueIndex.insert(trans.getDueDate(), index);
+        }
+        transactions.commit(index, trans);
+        borrowIndex.insert(trans.getBorrowDate(), index);
+        if (!image.lazy) {
+            addCompletions(*items.find(trans.getItemId()), 1);
+        }
+    }
+
+    MemoryScope holdScope(MemoryTag::Holds);
+    for (const auto& fields : image.holds) {
+        if (fields[0] == "WAITING" && fields.size() >= 3) {
+            auto user = getUser(fields[2]);
+            holds.placeHold(fields[1], fields[2], holdPriorityForRole(user->getRole()));
+        } else if (fields[0] == "READY" && fields.size() >= 5) {
+            ReadyHold hold{fields[1], fields[2], fields[3],
+                           static_cast<time_t>(std::stoll(fields[4]))};
+            items.restoreCopy(hold.itemId, hold.barcode, CopyState::OnHoldShelf, hold.userId);
+            holds.restoreReady(hold);
+        }
+    }
+    // A copy on the shelf leaves by expiry or pickup, which only a
+    // resident item can record, so shelved items are decoded now
+    for (const auto& hold : holds.getReadyHolds()) {
+        items.pin(hold.itemId);
+    }
+
+    MemoryScope fineScope(MemoryTag::Fines);
+    for (const auto& entry : image.ledger) {
+        fineLedger.restore(entry);
+    }
+}
+
+std::shared_ptr<LibraryItem> Library::loadItem(const char* record, size_t length) const {
+    MemoryScope scope(MemoryTag::Items);
+    std::vector<std::string> fields = LibraryEvent::splitRecord(std::string(record, length));
+    auto item = createItem(fields);
+    int totalCopies = std::stoi(fields.at(5));
+    if (totalCopies > 1) {
+        item->addCopies(totalCopies - 1);
+    }
+    // The store puts back the copies on loan or on the pickup shelf; this
+    // reads nothing but the record, so it is safe without the state lock
+    return item;
+}
+
+// ==================== Lazy Catalog ====================
+
+void Library::configureLazyCatalog(size_t cacheCapacity) {
+    std::lock_guard<std::mutex> lock(stateMutex);
+    lazyCatalog = cacheCapacity > 0;
+    items.setCapacity(cacheCapacity);
+}
+
+void Library::ensureIndexes() const {
+    // Atomic, so this first look needs no lock; the build checks again under it
+    if (indexesDeferred.load(std::memory_order_acquire)) {
+        std::lock_guard<std::mutex> lock(stateMutex);
+        buildDeferredIndexes();
+    }
+}
+
+void Library::buildDeferredIndexes() const {
+    if (!indexesDeferred) {
+        return;
+    }
+    MemoryScope scope(MemoryTag::Indexes);
+    auto start = std::chrono::steady_clock::now();
+
+    // Completions are weighted by loans, as the eager load counts them
+    std::unordered_map<std::string, unsigned long long> borrows;
+    transactions.forEach([&borrows](const Transaction& trans) {
+        borrows[trans.getItemId()]++;
+    });
+
+    bool savedFullText = fullTextIndex.load(deferredFullTextFile, deferredSequence,
+                                            deferredItemCount);
+    items.scan([&](const std::shared_ptr<LibraryItem>& item) {
+        titleIndex.add(item->getItemId(), item->getTitle());
+        catalogIndex.add(item);
+        if (!savedFullText) {
+            fullTextIndex.add(*item);
+        }
+        auto count = borrows.find(item->getItemId());
+        addCompletions(*item, count != borrows.end() ? count->second : 0);
+        yearIndex.insert(item->getPublicationYear(), item->getItemId());
+    });
+    if (savedFullText) {
+        for (const auto& itemId : unindexedItems) {
+            fullTextIndex.add(*items.find(itemId));
+        }
+    }
+    rebuildPopularity();
+    rebuildCoBorrows();
+    unindexedItems.clear();
+    indexesDeferred = false;
+
+    auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::steady_clock::now() - start);
+    std::cout << "Indexed " << items.size() << " item(s) for search in " << elapsed.count()
+              << " ms." << std::endl;
+}
+
+void Library::resetState() {
+    users.clear();
+    items.clear();
+    titleIndex.clear();
+    catalogIndex.clear();
+    fullTextIndex.clear();
+    titleCompletions.clear();
+    authorCompletions.clear();
+    queryCache.clear();
+    popularity.clear();
+    coBorrows.clear();
+    yearIndex.clear();
+    dueIndex.clear();
+    borrowIndex.clear();
+    transactions.clear();
+    openLoans.clear();
+    holds.clear();
+    fineLedger.clear();
+    stats.clear();
+    changes.clear();
+    indexesDeferred = false;
+    unindexedItems.clear();
+    lastSequence = 0;
+    ledgerSaved = 0;
+}
+
+std::unordered_map<std::string, ItemKind> Library::itemKinds() const {
+    // Read from the summaries, so no lazy item is decoded
+    std::unordered_map<std::string, ItemKind> kinds;
+    kinds.reserve(items.size());
+    items.forEachSummary([&kinds](const std::string& itemId, const std::string& type, int) {
+        kinds[itemId] = type == "Magazine" ? ItemKind::Magazine
+                      : type == "Journal" ? ItemKind::Journal : ItemKind::Book;
+    });
+    return kinds;
+}
+
+void Library::rebuildStatistics() {
+    stats.clear();
+
+    for (const auto& pair : users) {
+        stats.onUserRegistered(pair.first);
+    }
+    // Items start with empty counters, which getItemStats() reports for
+    // items it has no entry for, so only availability is counted here
+    items.forEachSummary([this](const std::string&, const std::string&, int availableCopies) {
+        stats.onAvailabilityChange(0, availableCopies);
+    });
+    std::unordered_map<std::string, ItemKind> kinds = itemKinds();
+    transactions.forEach([this, &kinds](const Transaction& trans) {
+        ItemKind kind = kinds[trans.getItemId()];
+        stats.onBorrow(trans.getUserId(), trans.getItemId(), kind, trans.getBorrowDate());
+        if (trans.getIsReturned()) {
+            stats.onReturn(trans.getUserId(), kind, trans.getFineAmount());
+        }
+    });
+}
+
+// ==================== Record Factories ====================
+
+std::shared_ptr<Person> Library::createUser(const std::vector<std::string>& fields) {
+    MemoryScope scope(MemoryTag::Users);
+    const std::string& kind = fields.at(0);
+
+    try {
+        if (kind == "STUDENT" && fields.size() >= 9) {
+            return std::make_shared<Student>(fields[1], fields[2], fields[3], fields[4],
+                                             std::stoi(fields[5]), fields[6], fields[7],
+                                             std::stoi(fields[8]));
+        }
+        if (kind == "FACULTY" && fields.size() >= 9) {
+            return std::make_shared<Faculty>(fields[1], fields[2], fields[3], fields[4],
+                                             std::stoi(fields[5]), fields[6], fields[7],
+                                             fields[8]);
+        }
+        if (kind == "LIBRARIAN" && fields.size() >= 8) {
+            return std::make_shared<Librarian>(fields[1], fields[2], fields[3], fields[4],
+                                               std::stoi(fields[5]), fields[6], fields[7]);
+        }
+    } catch (const std::logic_error&) {
+        // A number field that does not parse
+        throw InvalidOperationException("Malformed user record: " + kind + " (bad number)");
+    }
+    throw InvalidOperationException("Malformed user record: " + kind);
+}
+
+std::shared_ptr<LibraryItem> Library::createItem(const std::vector<std::string>& fields) {
+    MemoryScope scope(MemoryTag::Items);
+    // Common prefix: TYPE|itemId|title|publisher|year|totalCopies|availableCopies
+    const std::string& kind = fields.at(0);
+
+    try {
+        if (kind == "BOOK" && fields.size() >= 11) {
+            return std::make_shared<Book>(fields[1], fields[2], fields[3], std::stoi(fields[4]),
+                                          fields[7], fields[8], fields[9], std::stoi(fields[10]));
+        }
+        if (kind == "MAGAZINE" && fields.size() >= 10) {
+            return std::make_shared<Magazine>(fields[1], fields[2], fields[3],
+                                              std::stoi(fields[4]), std::stoi(fields[7]),
+                                              fields[8], fields[9]);
+        }
+        if (kind == "JOURNAL" && fields.size() >= 11) {
+            return std::make_shared<Journal>(fields[1], fields[2], fields[3], std::stoi(fields[4]),
+                                             std::stoi(fields[7]), fields[8], fields[9],
+                                             fields[10] == "1");
+        }
+    } catch (const std::logic_error&) {
+        // A number field that does not parse
+        throw InvalidOperationException("Malformed item record: " + kind + " (bad number)");
+    }
+    throw InvalidOperationException("Malformed item record: " + kind);
+}
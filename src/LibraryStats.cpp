@@ -0,0 +1,80 @@
+#include "../include/LibraryStats.h"
+#include <algorithm>
+
+LibraryStats::LibraryStats() : availableItems(0), availableCopies(0), activeLoans(0) {}
+
+void LibraryStats::onUserRegistered(const std::string& userId) {
+    std::lock_guard<std::mutex> lock(mutex);
+    userStats[userId] = UserStats();
+}
+
+void LibraryStats::onItemAdded(const std::string& itemId) {
+    std::lock_guard<std::mutex> lock(mutex);
+    itemStats[itemId] = ItemStats();
+}
+
+void LibraryStats::onBorrow(const std::string& userId, const std::string& itemId, ItemKind kind,
+                            time_t when) {
+    std::lock_guard<std::mutex> lock(mutex);
+
+    UserStats& user = userStats[userId];
+    user.totalBorrowed++;
+    user.currentlyBorrowed++;
+    user.borrowedByKind[static_cast<int>(kind)]++;
+
+    ItemStats& item = itemStats[itemId];
+    item.borrowCount++;
+    item.lastBorrowed = std::max(item.lastBorrowed, when);
+
+    activeLoans.fetch_add(1, std::memory_order_relaxed);
+}
+
+void LibraryStats::onReturn(const std::string& userId, ItemKind kind, double fine) {
+    std::lock_guard<std::mutex> lock(mutex);
+
+    UserStats& user = userStats[userId];
+    user.currentlyBorrowed--;
+    user.borrowedByKind[static_cast<int>(kind)]--;
+    user.totalFines += fine;
+
+    activeLoans.fetch_sub(1, std::memory_order_relaxed);
+}
+
+void LibraryStats::onAvailabilityChange(int copiesBefore, int copiesAfter) {
+    availableCopies.fetch_add(copiesAfter - copiesBefore, std::memory_order_relaxed);
+
+    int titleDelta = (copiesAfter > 0 ? 1 : 0) - (copiesBefore > 0 ? 1 : 0);
+    if (titleDelta != 0) {
+        availableItems.fetch_add(titleDelta, std::memory_order_relaxed);
+    }
+}
+
+UserStats LibraryStats::getUserStats(const std::string& userId) const {
+    std::lock_guard<std::mutex> lock(mutex);
+
+    auto it = userStats.find(userId);
+    if (it == userStats.end()) {
+        return UserStats();
+    }
+    return it->second;
+}
+
+ItemStats LibraryStats::getItemStats(const std::string& itemId) const {
+    std::lock_guard<std::mutex> lock(mutex);
+
+    auto it = itemStats.find(itemId);
+    if (it == itemStats.end()) {
+        return ItemStats();
+    }
+    return it->second;
+}
+
+void LibraryStats::clear() {
+    std::lock_guard<std::mutex> lock(mutex);
+
+    userStats.clear();
+    itemStats.clear();
+    availableItems.store(0);
+    availableCopies.store(0);
+    activeLoans.store(0);
+}
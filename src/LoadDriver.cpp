@@ -0,0 +1,205 @@
+#include "../include/LoadDriver.h"
+#include "../include/BatchSession.h"
+#include <algorithm>
+#include <thread>
+#include <chrono>
+#include <functional>
+#include <iomanip>
+
+typedef std::chrono::steady_clock Clock;
+
+namespace {
+
+const int OP_COUNT = static_cast<int>(TraceOp::SearchType) + 1;
+
+// What one replay thread observed
+struct WorkerResult {
+    std::vector<unsigned long long> latencies[OP_COUNT]; // Nanoseconds
+    unsigned long long failed[OP_COUNT];
+    std::map<std::string, unsigned long long> errors;
+    long long maxLagNanos;
+
+    WorkerResult() : failed(), maxLagNanos(0) {}
+};
+
+// Nearest-rank percentile of sorted nanoseconds, in microseconds
+double percentile(const std::vector<unsigned long long>& sorted, double fraction) {
+    if (sorted.empty()) {
+        return 0;
+    }
+    size_t rank = static_cast<size_t>(fraction * sorted.size() + 0.999999);
+    rank = std::min(std::max<size_t>(rank, 1), sorted.size());
+    return sorted[rank - 1] / 1000.0;
+}
+
+LatencySummary summarize(const std::string& name, std::vector<unsigned long long>& latencies,
+                         unsigned long long failed) {
+    std::sort(latencies.begin(), latencies.end());
+    LatencySummary summary;
+    summary.name = name;
+    summary.count = latencies.size();
+    summary.failed = failed;
+    summary.p50 = percentile(latencies, 0.50);
+    summary.p90 = percentile(latencies, 0.90);
+    summary.p99 = percentile(latencies, 0.99);
+    summary.p999 = percentile(latencies, 0.999);
+    summary.max = latencies.empty() ? 0 : latencies.back() / 1000.0;
+    return summary;
+}
+
+} // namespace
+
+LoadDriver::LoadDriver(Library& lib) : library(lib) {}
+
+void LoadDriver::execute(const TraceEntry& entry) {
+    switch (entry.op) {
+        case TraceOp::Borrow:
+            library.checkoutItem(entry.userId, entry.argument);
+            break;
+        case TraceOp::Return:
+            library.checkinItem(entry.userId, entry.argument);
+            break;
+        case TraceOp::SearchTitle:
+            library.searchByTitle(entry.argument);
+            break;
+        case TraceOp::SearchKeywords:
+            library.searchKeywords(entry.argument, entry.limit);
+            break;
+        case TraceOp::SearchType:
+            library.searchByType(entry.argument);
+            break;
+    }
+}
+
+LoadReport LoadDriver::replay(const std::vector<TraceEntry>& trace, double speedup,
+                              unsigned concurrency) {
+    concurrency = std::max(concurrency, 1u);
+
+    // Deal the trace out: a user's operations stay together and in order
+    std::vector<std::vector<const TraceEntry*>> queues(concurrency);
+    std::hash<std::string> hashUser;
+    size_t nextSearch = 0;
+    for (const TraceEntry& entry : trace) {
+        size_t worker = entry.userId.empty() ? nextSearch++ % concurrency
+                                             : hashUser(entry.userId) % concurrency;
+        queues[worker].push_back(&entry);
+    }
+    unsigned long long firstOffset = trace.empty() ? 0 : trace.front().offsetMicros;
+
+    std::vector<WorkerResult> results(concurrency);
+    std::vector<std::thread> workers;
+    Clock::time_point start = Clock::now();
+    for (unsigned w = 0; w < concurrency; w++) {
+        workers.emplace_back([this, &queues, &results, w, start, speedup, firstOffset]() {
+            WorkerResult& result = results[w];
+            for (const TraceEntry* entry : queues[w]) {
+                Clock::time_point issued = Clock::now();
+                Clock::time_point due = issued;
+                if (speedup > 0) {
+                    double delay = (entry->offsetMicros - firstOffset) / speedup;
+                    due = start + std::chrono::microseconds(static_cast<long long>(delay));
+                    if (due > issued) {
+                        std::this_thread::sleep_until(due);
+                    } else {
+                        long long lag = std::chrono::duration_cast<std::chrono::nanoseconds>(
+                            issued - due).count();
+                        result.maxLagNanos = std::max(result.maxLagNanos, lag);
+                    }
+                }
+
+                int op = static_cast<int>(entry->op);
+                try {
+                    execute(*entry);
+                } catch (const std::exception& e) {
+                    result.failed[op]++;
+                    result.errors[BatchSession::errorCode(e)]++;
+                }
+                result.latencies[op].push_back(static_cast<unsigned long long>(
+                    std::chrono::duration_cast<std::chrono::nanoseconds>(
+                        Clock::now() - due).count()));
+            }
+        });
+    }
+    for (auto& worker : workers) {
+        worker.join();
+    }
+
+    LoadReport report;
+    report.seconds = std::chrono::duration<double>(Clock::now() - start).count();
+    report.operations = trace.size();
+    report.failed = 0;
+    report.threads = concurrency;
+    report.speedup = speedup;
+    long long maxLag = 0;
+
+    std::vector<unsigned long long> all;
+    all.reserve(trace.size());
+    for (int op = 0; op < OP_COUNT; op++) {
+        std::vector<unsigned long long> latencies;
+        unsigned long long failed = 0;
+        for (WorkerResult& result : results) {
+            latencies.insert(latencies.end(), result.latencies[op].begin(),
+                             result.latencies[op].end());
+            failed += result.failed[op];
+        }
+        if (latencies.empty()) {
+            continue;
+        }
+        all.insert(all.end(), latencies.begin(), latencies.end());
+        report.failed += failed;
+        report.latencies.push_back(summarize(TraceRecorder::opName(static_cast<TraceOp>(op)),
+                                             latencies, failed));
+    }
+    report.latencies.push_back(summarize("ALL", all, report.failed));
+
+    for (const WorkerResult& result : results) {
+        maxLag = std::max(maxLag, result.maxLagNanos);
+        for (const auto& error : result.errors) {
+            report.errors[error.first] += error.second;
+        }
+    }
+    report.maxLagMillis = maxLag / 1e6;
+    return report;
+}
+
+void LoadReport::print(std::ostream& out) const {
+    std::ios::fmtflags flags = out.flags();
+    std::streamsize precision = out.precision();
+
+    out << std::fixed << std::setprecision(0);
+    out << "Replayed " << operations << " operation(s) on " << threads << " thread(s) ";
+    if (speedup > 0) {
+        out << "at " << std::setprecision(2) << speedup << "x speed " << std::setprecision(0);
+    } else {
+        out << "unpaced ";
+    }
+    out << "in " << seconds * 1000 << " ms: " << throughput() << " per second." << std::endl;
+
+    out << std::endl << std::left << std::setw(16) << "Operation" << std::right
+        << std::setw(10) << "Count" << std::setw(10) << "Failed"
+        << std::setw(11) << "p50 us" << std::setw(11) << "p90 us" << std::setw(11) << "p99 us"
+        << std::setw(11) << "p99.9 us" << std::setw(11) << "max us" << std::endl;
+    out << std::setprecision(1);
+    for (const LatencySummary& row : latencies) {
+        out << std::left << std::setw(16) << row.name << std::right
+            << std::setw(10) << row.count << std::setw(10) << row.failed
+            << std::setw(11) << row.p50 << std::setw(11) << row.p90 << std::setw(11) << row.p99
+            << std::setw(11) << row.p999 << std::setw(11) << row.max << std::endl;
+    }
+
+    if (!errors.empty()) {
+        out << std::endl << "Errors:" << std::endl;
+        for (const auto& error : errors) {
+            out << "  " << std::left << std::setw(18) << error.first << std::right
+                << std::setw(10) << error.second << "  (" << std::setprecision(1)
+                << 100.0 * error.second / operations << "%)" << std::endl;
+        }
+    }
+    if (speedup > 0) {
+        out << std::endl << "Furthest behind schedule: " << std::setprecision(1)
+            << maxLagMillis << " ms." << std::endl;
+    }
+
+    out.flags(flags);
+    out.precision(precision);
+}
@@ -0,0 +1,204 @@
+#include "../include/LoanPolicy.h"
+#include "../include/LibraryEvent.h"
+#include "../include/Exceptions.h"
+#include <fstream>
+#include <limits>
+#include <cmath>
+
+namespace {
+
+// Limits and durations by role, fees by kind, as the library has always
+// lent: the limit covers every kind together, so no kind has its own
+const int DEFAULT_MAX_LOANS[LoanPolicy::ROLES] = {5, 10, 15};
+const int DEFAULT_LOAN_DAYS[LoanPolicy::ROLES] = {14, 30, 60};
+const double DEFAULT_LATE_FEES[LoanPolicy::KINDS] = {0.50, 0.25, 0.75};
+
+} // namespace
+
+LoanPolicy::LoanPolicy() {
+    for (int role = 0; role < ROLES; role++) {
+        maxTotalLoans[role] = DEFAULT_MAX_LOANS[role];
+        for (int kind = 0; kind < KINDS; kind++) {
+            LoanRule& rule = rules[role * KINDS + kind];
+            rule.maxLoans = DEFAULT_MAX_LOANS[role];
+            rule.loanDays = DEFAULT_LOAN_DAYS[role];
+            rule.lateFeePerDay = DEFAULT_LATE_FEES[kind];
+            rule.fineCap = 0.0;
+        }
+    }
+}
+
+const char* LoanPolicy::roleName(PatronRole role) {
+    static const char* const NAMES[ROLES] = {"Student", "Faculty", "Librarian"};
+    return NAMES[static_cast<int>(role)];
+}
+
+const char* LoanPolicy::kindName(ItemKind kind) {
+    static const char* const NAMES[KINDS] = {"Book", "Magazine", "Journal"};
+    return NAMES[static_cast<int>(kind)];
+}
+
+void LoanPolicy::apply(const std::vector<std::string>& fields, size_t first, int lineNumber) {
+    std::string where = "loan policy line " + std::to_string(lineNumber);
+    if (fields.size() != first + 6) {
+        throw InvalidOperationException("Wrong number of fields on " + where);
+    }
+
+    // Cells the rule covers
+    const std::string& roleField = fields[first];
+    const std::string& kindField = fields[first + 1];
+    bool roles[ROLES];
+    bool kinds[KINDS];
+    bool anyKind = false;
+    for (int kind = 0; kind < KINDS; kind++) {
+        kinds[kind] = kindField == "*" || kindField == kindName(static_cast<ItemKind>(kind));
+        anyKind = anyKind || kinds[kind];
+    }
+    if (!matchRoles(roleField, roles)) {
+        throw InvalidOperationException("Unknown role '" + roleField + "' on " + where);
+    }
+    if (!anyKind) {
+        throw InvalidOperationException("Unknown item kind '" + kindField + "' on " + where);
+    }
+
+    // Parse every value before changing any cell; NaN marks a kept value
+    const double KEEP = std::numeric_limits<double>::quiet_NaN();
+    double values[4];
+    for (int i = 0; i < 4; i++) {
+        const std::string& field = fields[first + 2 + i];
+        values[i] = KEEP;
+        if (field.empty()) {
+            continue;
+        }
+        size_t used = 0;
+        try {
+            values[i] = std::stod(field, &used);
+        } catch (const std::exception&) {
+            used = 0;
+        }
+        bool whole = values[i] == std::floor(values[i]) &&
+                     values[i] <= std::numeric_limits<int>::max();
+        if (used != field.size() || !std::isfinite(values[i]) || values[i] < 0 ||
+            (i < 2 && !whole)) {
+            throw InvalidOperationException("Bad value '" + field + "' on " + where);
+        }
+    }
+    if (values[1] == 0) {
+        throw InvalidOperationException("Loans must last at least a day on " + where);
+    }
+
+    for (int role = 0; role < ROLES; role++) {
+        for (int kind = 0; kind < KINDS; kind++) {
+            if (!roles[role] || !kinds[kind]) {
+                continue;
+            }
+            LoanRule& rule = rules[role * KINDS + kind];
+            if (!std::isnan(values[0])) {
+                rule.maxLoans = static_cast<int>(values[0]);
+            }
+            if (!std::isnan(values[1])) {
+                rule.loanDays = static_cast<int>(values[1]);
+            }
+            if (!std::isnan(values[2])) {
+                rule.lateFeePerDay = values[2];
+            }
+            if (!std::isnan(values[3])) {
+                rule.fineCap = values[3];
+            }
+        }
+    }
+}
+
+void LoanPolicy::applyLimit(const std::vector<std::string>& fields, size_t first,
+                            int lineNumber) {
+    std::string where = "loan policy line " + std::to_string(lineNumber);
+    if (fields.size() != first + 2) {
+        throw InvalidOperationException("Wrong number of fields on " + where);
+    }
+    bool roles[ROLES];
+    if (!matchRoles(fields[first], roles)) {
+        throw InvalidOperationException("Unknown role '" + fields[first] + "' on " + where);
+    }
+
+    const std::string& field = fields[first + 1];
+    if (field.empty()) {
+        return;
+    }
+    size_t used = 0;
+    long limit = -1;
+    try {
+        limit = std::stol(field, &used);
+    } catch (const std::exception&) {
+        used = 0;
+    }
+    if (used != field.size() || limit < 0 || limit > std::numeric_limits<int>::max()) {
+        throw InvalidOperationException("Bad value '" + field + "' on " + where);
+    }
+    for (int role = 0; role < ROLES; role++) {
+        if (roles[role]) {
+            maxTotalLoans[role] = static_cast<int>(limit);
+        }
+    }
+}
+
+bool LoanPolicy::matchRoles(const std::string& roleField, bool roles[ROLES]) const {
+    bool anyRole = false;
+    for (int role = 0; role < ROLES; role++) {
+        roles[role] = roleField == "*" || roleField == roleName(static_cast<PatronRole>(role));
+        anyRole = anyRole || roles[role];
+    }
+    return anyRole;
+}
+
+LoanPolicy LoanPolicy::compile(const std::string& filename, const std::string& branch) {
+    std::ifstream in(filename);
+    if (!in) {
+        throw FileIOException(filename);
+    }
+
+    LoanPolicy policy;
+    policy.source = filename;
+    policy.branch = branch;
+
+    // Overrides for other branches are still checked, against a scratch table
+    LoanPolicy otherBranches;
+    std::vector<std::pair<std::vector<std::string>, int>> overrides;
+    std::string line;
+    int lineNumber = 0;
+    while (std::getline(in, line)) {
+        lineNumber++;
+        if (!line.empty() && line.back() == '\r') {
+            line.pop_back();
+        }
+        if (line.empty() || line[0] == '#') {
+            continue;
+        }
+
+        std::vector<std::string> fields = LibraryEvent::splitRecord(line);
+        if (fields[0] == "RULE") {
+            policy.apply(fields, 1, lineNumber);
+        } else if (fields[0] == "LIMIT") {
+            policy.applyLimit(fields, 1, lineNumber);
+        } else if ((fields[0] == "BRANCH" || fields[0] == "BRANCH_LIMIT") && fields.size() > 1) {
+            if (!branch.empty() && fields[1] == branch) {
+                overrides.emplace_back(std::move(fields), lineNumber);
+            } else if (fields[0] == "BRANCH") {
+                otherBranches.apply(fields, 2, lineNumber);
+            } else {
+                otherBranches.applyLimit(fields, 2, lineNumber);
+            }
+        } else {
+            throw InvalidOperationException("Unknown rule '" + fields[0] + "' on loan policy line " +
+                                            std::to_string(lineNumber));
+        }
+    }
+
+    for (const auto& entry : overrides) {
+        if (entry.first[0] == "BRANCH") {
+            policy.apply(entry.first, 2, entry.second);
+        } else {
+            policy.applyLimit(entry.first, 2, entry.second);
+        }
+    }
+    return policy;
+}
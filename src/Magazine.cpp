@@ -1,10 +1,10 @@
 #include "../include/Magazine.h"
 #include <iostream>
-#include <sstream>
 
 Magazine::Magazine(const std::string& id, const std::string& title, const std::string& publisher,
                    int year, int issue, const std::string& mon, const std::string& cat)
-    : LibraryItem(id, title, publisher, year), issueNumber(issue), month(mon), category(cat) {}
+    : LibraryItem(id, title, publisher, year, ItemKind::Magazine), issueNumber(issue), month(mon),
+      category(cat) {}
 
 void Magazine::displayInfo() const {
     std::cout << "\n=== Magazine Information ===" << std::endl;
@@ -15,27 +15,17 @@ void Magazine::displayInfo() const {
     std::cout << "Issue Number: " << issueNumber << std::endl;
     std::cout << "Month: " << month << std::endl;
     std::cout << "Category: " << category << std::endl;
-    std::cout << "Status: " << (isAvailable ? "Available" : "Borrowed") << std::endl;
-    if (!isAvailable) {
-        std::cout << "Current Borrower: " << currentBorrower << std::endl;
-    }
-    std::cout << "Late Fee: $" << getLateFeePerDay() << " per day" << std::endl;
+    displayAvailability();
 }
 
 std::string Magazine::getItemType() const {
     return "Magazine";
 }
 
-double Magazine::getLateFeePerDay() const {
-    // Magazines have a late fee of $0.25 per day (lower than books)
-    return 0.25;
-}
-
-std::string Magazine::serialize() const {
-    std::ostringstream oss;
-    oss << "MAGAZINE|" << LibraryItem::serialize() << "|"
-        << issueNumber << "|" << month << "|" << category;
-    return oss.str();
+void Magazine::writeTo(RecordWriter& out) const {
+    out.field("MAGAZINE");
+    LibraryItem::writeTo(out);
+    out.field(issueNumber).field(month).field(category);
 }
 
 Magazine::~Magazine() {
@@ -0,0 +1,37 @@
+#include "../include/MappedFile.h"
+#include "../include/Exceptions.h"
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+MappedFile::MappedFile(const std::string& filename) : data(nullptr), size(0) {
+    int fd = ::open(filename.c_str(), O_RDONLY);
+    if (fd < 0) {
+        throw FileIOException(filename);
+    }
+
+    struct stat info;
+    if (fstat(fd, &info) != 0) {
+        ::close(fd);
+        throw FileIOException(filename);
+    }
+    size = static_cast<size_t>(info.st_size);
+
+    // An empty file cannot be mapped and has nothing to read
+    if (size > 0) {
+        void* mapping = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (mapping == MAP_FAILED) {
+            ::close(fd);
+            throw FileIOException(filename);
+        }
+        data = static_cast<const char*>(mapping);
+    }
+    ::close(fd);
+}
+
+MappedFile::~MappedFile() {
+    if (data != nullptr) {
+        munmap(const_cast<char*>(data), size);
+    }
+}
@@ -0,0 +1,170 @@
+#include "../include/MemoryAccounting.h"
+#include <new>
+#include <atomic>
+#include <cstdlib>
+#include <cstddef>
+
+namespace {
+
+// Tag charged by new allocations on this thread
+thread_local MemoryTag currentTag = MemoryTag::Untagged;
+
+} // namespace
+
+MemoryScope::MemoryScope(MemoryTag tag) : previous(currentTag) {
+    currentTag = tag;
+}
+
+MemoryScope::~MemoryScope() {
+    currentTag = previous;
+}
+
+const char* MemoryAccounting::tagName(MemoryTag tag) {
+    static const char* const NAMES[TAG_COUNT] = {
+        "Untagged", "Users", "Items", "Transactions", "Holds", "Fines",
+        "Indexes", "Caches", "Journal", "Snapshot"
+    };
+    return NAMES[static_cast<int>(tag)];
+}
+
+#ifdef LIBRARY_MEMORY_ACCOUNTING
+
+namespace {
+
+// Requested size, then the tag; a multiple of the alignment operator new
+// must provide, so the block after it stays aligned
+struct BlockHeader {
+    size_t size;
+    MemoryTag tag;
+};
+const size_t HEADER_BYTES = 16;
+static_assert(sizeof(BlockHeader) <= HEADER_BYTES, "header does not fit");
+static_assert(HEADER_BYTES % alignof(std::max_align_t) == 0, "header breaks alignment");
+
+// Zero-initialized before any allocation can happen. Each tag has its own
+// cache line, so threads charging different tags do not contend.
+struct alignas(64) TagCounters {
+    std::atomic<long long> bytes;
+    std::atomic<long long> allocations;
+    std::atomic<unsigned long long> total;
+};
+TagCounters counters[MemoryAccounting::TAG_COUNT];
+
+void* allocate(size_t size) {
+    void* block = std::malloc(size + HEADER_BYTES);
+    if (block == nullptr) {
+        return nullptr;
+    }
+    BlockHeader* header = static_cast<BlockHeader*>(block);
+    header->size = size;
+    header->tag = currentTag;
+    TagCounters& tag = counters[static_cast<int>(header->tag)];
+    tag.bytes.fetch_add(static_cast<long long>(size), std::memory_order_relaxed);
+    tag.allocations.fetch_add(1, std::memory_order_relaxed);
+    tag.total.fetch_add(1, std::memory_order_relaxed);
+    return static_cast<char*>(block) + HEADER_BYTES;
+}
+
+void* allocateOrThrow(size_t size) {
+    void* memory = allocate(size);
+    while (memory == nullptr) {
+        std::new_handler handler = std::get_new_handler();
+        if (handler == nullptr) {
+            throw std::bad_alloc();
+        }
+        handler();
+        memory = allocate(size);
+    }
+    return memory;
+}
+
+void release(void* memory) {
+    if (memory == nullptr) {
+        return;
+    }
+    void* block = static_cast<char*>(memory) - HEADER_BYTES;
+    const BlockHeader* header = static_cast<const BlockHeader*>(block);
+    TagCounters& tag = counters[static_cast<int>(header->tag)];
+    tag.bytes.fetch_sub(static_cast<long long>(header->size), std::memory_order_relaxed);
+    tag.allocations.fetch_sub(1, std::memory_order_relaxed);
+    std::free(block);
+}
+
+} // namespace
+
+void* operator new(size_t size) {
+    return allocateOrThrow(size);
+}
+
+void* operator new[](size_t size) {
+    return allocateOrThrow(size);
+}
+
+void* operator new(size_t size, const std::nothrow_t&) noexcept {
+    try {
+        return allocateOrThrow(size);
+    } catch (const std::bad_alloc&) {
+        return nullptr;
+    }
+}
+
+void* operator new[](size_t size, const std::nothrow_t&) noexcept {
+    try {
+        return allocateOrThrow(size);
+    } catch (const std::bad_alloc&) {
+        return nullptr;
+    }
+}
+
+void operator delete(void* memory) noexcept {
+    release(memory);
+}
+
+void operator delete[](void* memory) noexcept {
+    release(memory);
+}
+
+void operator delete(void* memory, size_t) noexcept {
+    release(memory);
+}
+
+void operator delete[](void* memory, size_t) noexcept {
+    release(memory);
+}
+
+void operator delete(void* memory, const std::nothrow_t&) noexcept {
+    release(memory);
+}
+
+void operator delete[](void* memory, const std::nothrow_t&) noexcept {
+    release(memory);
+}
+
+bool MemoryAccounting::isEnabled() {
+    return true;
+}
+
+std::vector<MemoryUsage> MemoryAccounting::usage() {
+    std::vector<MemoryUsage> result;
+    for (int tag = 0; tag < TAG_COUNT; tag++) {
+        MemoryUsage entry;
+        entry.tag = static_cast<MemoryTag>(tag);
+        entry.liveBytes = counters[tag].bytes.load(std::memory_order_relaxed);
+        entry.liveAllocations = counters[tag].allocations.load(std::memory_order_relaxed);
+        entry.totalAllocations = counters[tag].total.load(std::memory_order_relaxed);
+        result.push_back(entry);
+    }
+    return result;
+}
+
+#else
+
+bool MemoryAccounting::isEnabled() {
+    return false;
+}
+
+std::vector<MemoryUsage> MemoryAccounting::usage() {
+    return std::vector<MemoryUsage>();
+}
+
+#endif // LIBRARY_MEMORY_ACCOUNTING
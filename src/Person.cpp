@@ -1,9 +1,8 @@
 #include "../include/Person.h"
-#include <sstream>
 
 Person::Person(const std::string& id, const std::string& n, const std::string& e, 
-               const std::string& pwd, int a)
-    : userId(id), name(n), email(e), password(pwd), age(a) {}
+               const std::string& pwd, int a, PatronRole role)
+    : userId(id), name(n), email(e), password(pwd), age(a), patronRole(role) {}
 
 Person::~Person() {
     // Base class destructor
@@ -13,8 +12,13 @@ bool Person::authenticate(const std::string& pwd) const {
     return password == pwd;
 }
 
+void Person::writeTo(RecordWriter& out) const {
+    out.field(userId).field(name).field(email).field(password).field(age);
+}
+
 std::string Person::serialize() const {
-    std::ostringstream oss;
-    oss << userId << "|" << name << "|" << email << "|" << password << "|" << age;
-    return oss.str();
+    std::string record;
+    RecordWriter out(record);
+    writeTo(out);
+    return record;
 }
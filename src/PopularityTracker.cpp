@@ -0,0 +1,199 @@
+#include "../include/PopularityTracker.h"
+#include "../include/CatalogIndex.h"
+#include "../include/MemoryAccounting.h"
+#include <algorithm>
+
+static const long long SECONDS_PER_DAY = 24 * 60 * 60;
+
+// Day number of a time, rounding down for times before the epoch
+static long long dayOf(time_t when) {
+    long long seconds = static_cast<long long>(when);
+    return seconds >= 0 ? seconds / SECONDS_PER_DAY : (seconds + 1) / SECONDS_PER_DAY - 1;
+}
+
+const int PopularityTracker::MONTH_DAYS;
+
+// ==================== Space-Saving Summary ====================
+
+void PopularityTracker::Summary::siftDown(size_t index) {
+    while (true) {
+        size_t smallest = index;
+        size_t left = 2 * index + 1;
+        size_t right = left + 1;
+        if (left < heap.size() && heap[left].count < heap[smallest].count) {
+            smallest = left;
+        }
+        if (right < heap.size() && heap[right].count < heap[smallest].count) {
+            smallest = right;
+        }
+        if (smallest == index) {
+            return;
+        }
+        std::swap(heap[index], heap[smallest]);
+        positions[heap[index].itemId] = index;
+        positions[heap[smallest].itemId] = smallest;
+        index = smallest;
+    }
+}
+
+void PopularityTracker::Summary::offer(const std::string& itemId, size_t capacity) {
+    auto it = positions.find(itemId);
+    if (it != positions.end()) {
+        heap[it->second].count++;
+        siftDown(it->second);
+        return;
+    }
+
+    if (heap.size() < capacity) {
+        // A count of 1 is the smallest there is, so the heap order holds
+        positions[itemId] = heap.size();
+        heap.push_back(Counter{itemId, 1, 0});
+        size_t index = heap.size() - 1;
+        while (index > 0 && heap[(index - 1) / 2].count > heap[index].count) {
+            size_t parent = (index - 1) / 2;
+            std::swap(heap[index], heap[parent]);
+            positions[heap[index].itemId] = index;
+            positions[heap[parent].itemId] = parent;
+            index = parent;
+        }
+        return;
+    }
+
+    // Take over the smallest counter; its count bounds what this item missed
+    Counter& root = heap[0];
+    positions.erase(root.itemId);
+    root.itemId = itemId;
+    root.error = root.count;
+    root.count++;
+    positions[itemId] = 0;
+    siftDown(0);
+}
+
+// ==================== Tracker ====================
+
+PopularityTracker::PopularityTracker(size_t countersPerSummary)
+    : capacity(std::max<size_t>(countersPerSummary, 1)) {}
+
+std::string PopularityTracker::typeSegment(const std::string& type) {
+    return "type|" + CatalogIndex::normalizeText(type);
+}
+
+std::string PopularityTracker::genreSegment(const std::string& genre) {
+    return "genre|" + CatalogIndex::normalizeText(genre);
+}
+
+int PopularityTracker::windowDays(PopularityWindow window) {
+    switch (window) {
+        case PopularityWindow::Day:
+            return 1;
+        case PopularityWindow::Week:
+            return 7;
+        case PopularityWindow::Month:
+            break;
+    }
+    return MONTH_DAYS;
+}
+
+const char* PopularityTracker::windowName(PopularityWindow window) {
+    static const char* const NAMES[] = {"Day", "Week", "Month"};
+    return NAMES[static_cast<int>(window)];
+}
+
+void PopularityTracker::record(const std::string& itemId, const std::string& type,
+                               const std::string& genre, time_t when) {
+    MemoryScope scope(MemoryTag::Indexes);
+    long long day = dayOf(when);
+    std::lock_guard<std::mutex> lock(mutex);
+
+    DayBucket& bucket = buckets[((day % MONTH_DAYS) + MONTH_DAYS) % MONTH_DAYS];
+    if (day < bucket.day) {
+        return; // Older than every day kept
+    }
+    if (day > bucket.day) {
+        bucket.segments.clear(); // Reuse the slot of a day that has left the window
+        bucket.day = day;
+    }
+    bucket.segments[""].offer(itemId, capacity);
+    bucket.segments[typeSegment(type)].offer(itemId, capacity);
+    if (!genre.empty()) {
+        bucket.segments[genreSegment(genre)].offer(itemId, capacity);
+    }
+}
+
+std::vector<PopularItem> PopularityTracker::top(PopularityWindow window, const std::string& type,
+                                                const std::string& genre, size_t k,
+                                                time_t now) const {
+    // A genre belongs to books only, so it narrows any type filter
+    std::string segment;
+    if (!genre.empty()) {
+        if (!type.empty() && CatalogIndex::normalizeText(type) != "book") {
+            return std::vector<PopularItem>();
+        }
+        segment = genreSegment(genre);
+    } else if (!type.empty()) {
+        segment = typeSegment(type);
+    }
+
+    long long today = dayOf(now);
+    long long firstDay = today - windowDays(window) + 1;
+    std::unordered_map<std::string, PopularItem> merged;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        for (const DayBucket& bucket : buckets) {
+            if (bucket.day < firstDay || bucket.day > today) {
+                continue;
+            }
+            auto summary = bucket.segments.find(segment);
+            if (summary == bucket.segments.end()) {
+                continue;
+            }
+            summary->second.forEach([&merged](const std::string& itemId,
+                                              unsigned long long count,
+                                              unsigned long long error) {
+                PopularItem& item = merged[itemId];
+                item.itemId = itemId;
+                item.borrows += count;
+                item.error += error;
+            });
+        }
+    }
+
+    std::vector<PopularItem> ranked;
+    ranked.reserve(merged.size());
+    for (auto& pair : merged) {
+        ranked.push_back(std::move(pair.second));
+    }
+    // Most borrowed first; ties by the smaller error, then item ID
+    auto better = [](const PopularItem& a, const PopularItem& b) {
+        if (a.borrows != b.borrows) {
+            return a.borrows > b.borrows;
+        }
+        if (a.error != b.error) {
+            return a.error < b.error;
+        }
+        return a.itemId < b.itemId;
+    };
+    k = std::min(k, ranked.size());
+    std::partial_sort(ranked.begin(), ranked.begin() + k, ranked.end(), better);
+    ranked.resize(k);
+    return ranked;
+}
+
+size_t PopularityTracker::getCounterCount() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    size_t count = 0;
+    for (const DayBucket& bucket : buckets) {
+        for (const auto& pair : bucket.segments) {
+            count += pair.second.size();
+        }
+    }
+    return count;
+}
+
+void PopularityTracker::clear() {
+    std::lock_guard<std::mutex> lock(mutex);
+    for (DayBucket& bucket : buckets) {
+        bucket.segments.clear();
+        bucket.day = -1;
+    }
+}
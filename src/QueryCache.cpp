@@ -0,0 +1,119 @@
+#include "../include/QueryCache.h"
+#include "../include/MemoryAccounting.h"
+#include <algorithm>
+#include <cctype>
+
+const size_t QueryCache::KINDS;
+const size_t QueryCache::CAPACITY;
+const QueryCache::Partitions QueryCache::ALL_CATALOG;
+const QueryCache::Partitions QueryCache::ALL_AVAILABILITY;
+
+namespace {
+
+// Bit of an item kind within a group of QueryCache::KINDS partitions
+QueryCache::Partitions kindBits(const std::string& itemType) {
+    std::string kind = itemType;
+    std::transform(kind.begin(), kind.end(), kind.begin(), ::tolower);
+    if (kind == "book") {
+        return 1u << 0;
+    }
+    if (kind == "magazine") {
+        return 1u << 1;
+    }
+    if (kind == "journal") {
+        return 1u << 2;
+    }
+    return QueryCache::ALL_CATALOG;
+}
+
+} // namespace
+
+QueryCache::QueryCache() : hits(0), lookups(0) {
+    for (auto& generation : generations) {
+        generation.store(0, std::memory_order_relaxed);
+    }
+}
+
+QueryCache::Partitions QueryCache::catalogOf(const std::string& itemType) {
+    return kindBits(itemType);
+}
+
+QueryCache::Partitions QueryCache::availabilityOf(const std::string& itemType) {
+    return kindBits(itemType) << KINDS;
+}
+
+bool QueryCache::isCurrent(const Stamp& stamp) const {
+    for (size_t i = 0; i < 2 * KINDS; i++) {
+        if ((stamp.partitions & (1u << i)) &&
+            generations[i].load(std::memory_order_acquire) != stamp.generations[i]) {
+            return false;
+        }
+    }
+    return true;
+}
+
+void QueryCache::invalidate(Partitions partitions) {
+    for (size_t i = 0; i < 2 * KINDS; i++) {
+        if (partitions & (1u << i)) {
+            generations[i].fetch_add(1, std::memory_order_acq_rel);
+        }
+    }
+}
+
+void QueryCache::clear() {
+    // Generations keep counting, so a result computed before the clear
+    // can never be stored as current
+    invalidate(ALL_CATALOG | ALL_AVAILABILITY);
+    std::lock_guard<std::mutex> lock(mutex);
+    entries.clear();
+    recency.clear();
+}
+
+bool QueryCache::lookup(const std::string& key, Result& result) {
+    lookups.fetch_add(1, std::memory_order_relaxed);
+    std::lock_guard<std::mutex> lock(mutex);
+    auto it = entries.find(key);
+    if (it == entries.end()) {
+        return false;
+    }
+    if (!isCurrent(it->second.stamp)) {
+        recency.erase(it->second.recency);
+        entries.erase(it);
+        return false;
+    }
+
+    recency.splice(recency.begin(), recency, it->second.recency);
+    result = it->second.result;
+    hits.fetch_add(1, std::memory_order_relaxed);
+    return true;
+}
+
+QueryCache::Stamp QueryCache::stamp(Partitions partitions) const {
+    Stamp stamp;
+    stamp.partitions = partitions;
+    for (size_t i = 0; i < 2 * KINDS; i++) {
+        stamp.generations[i] = generations[i].load(std::memory_order_acquire);
+    }
+    return stamp;
+}
+
+void QueryCache::store(const std::string& key, const Stamp& stamp, const Result& result) {
+    if (!isCurrent(stamp)) {
+        return; // Already outdated by a mutation during the computation
+    }
+    MemoryScope scope(MemoryTag::Caches);
+
+    std::lock_guard<std::mutex> lock(mutex);
+    auto it = entries.find(key);
+    if (it != entries.end()) {
+        recency.erase(it->second.recency);
+        entries.erase(it);
+    }
+    while (entries.size() >= CAPACITY) {
+        entries.erase(recency.back());
+        recency.pop_back();
+    }
+
+    recency.push_front(key);
+    entries[key] = Entry{stamp, result, recency.begin()};
+}
@@ -0,0 +1,139 @@
+#include "../include/RecordWriter.h"
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+
+RecordWriter::RecordWriter(std::string& buffer) : buffer(buffer), atRecordStart(true) {}
+
+void RecordWriter::separate() {
+    if (atRecordStart) {
+        atRecordStart = false;
+    } else {
+        buffer += '|';
+    }
+}
+
+void RecordWriter::appendUnsigned(unsigned long long value) {
+    char digits[20];
+    char* end = digits + sizeof(digits);
+    char* begin = end;
+    do {
+        *--begin = static_cast<char>('0' + value % 10);
+        value /= 10;
+    } while (value != 0);
+    buffer.append(begin, end);
+}
+
+void RecordWriter::appendSigned(long long value) {
+    if (value < 0) {
+        buffer += '-';
+        // Negate in unsigned arithmetic so the minimum value is safe
+        appendUnsigned(0ULL - static_cast<unsigned long long>(value));
+    } else {
+        appendUnsigned(static_cast<unsigned long long>(value));
+    }
+}
+
+// ==================== Fields ====================
+
+RecordWriter& RecordWriter::field(const std::string& text) {
+    separate();
+    size_t start = 0;
+    for (size_t i = 0; i < text.size(); i++) {
+        char c = text[i];
+        if (c != '|' && c != '\\' && c != '\n' && c != '\r') {
+            continue;
+        }
+        buffer.append(text, start, i - start);
+        buffer += '\\';
+        buffer += c == '\n' ? 'n' : c == '\r' ? 'r' : c;
+        start = i + 1;
+    }
+    buffer.append(text, start, std::string::npos);
+    return *this;
+}
+
+RecordWriter& RecordWriter::field(const char* text) {
+    // Literals are record tags; route anything else through the escaper
+    if (std::strpbrk(text, "|\\\n\r") != nullptr) {
+        return field(std::string(text));
+    }
+    separate();
+    buffer.append(text);
+    return *this;
+}
+
+RecordWriter& RecordWriter::field(bool value) {
+    separate();
+    buffer += value ? '1' : '0';
+    return *this;
+}
+
+RecordWriter& RecordWriter::field(int value) {
+    separate();
+    appendSigned(value);
+    return *this;
+}
+
+RecordWriter& RecordWriter::field(long value) {
+    separate();
+    appendSigned(value);
+    return *this;
+}
+
+RecordWriter& RecordWriter::field(long long value) {
+    separate();
+    appendSigned(value);
+    return *this;
+}
+
+RecordWriter& RecordWriter::field(unsigned value) {
+    separate();
+    appendUnsigned(value);
+    return *this;
+}
+
+RecordWriter& RecordWriter::field(unsigned long value) {
+    separate();
+    appendUnsigned(value);
+    return *this;
+}
+
+RecordWriter& RecordWriter::field(unsigned long long value) {
+    separate();
+    appendUnsigned(value);
+    return *this;
+}
+
+RecordWriter& RecordWriter::field(double value) {
+    separate();
+
+    // Whole cents: "c / 100" is the correctly rounded value of the decimal
+    // written below, exactly as std::stod will round it when reading back
+    double cents = std::round(value * 100.0);
+    if (std::fabs(cents) < 9007199254740992.0 && cents / 100.0 == value) {
+        long long whole = static_cast<long long>(cents);
+        if (whole < 0) {
+            buffer += '-';
+            whole = -whole;
+        }
+        appendUnsigned(static_cast<unsigned long long>(whole / 100));
+        long long fraction = whole % 100;
+        if (fraction != 0) {
+            buffer += '.';
+            buffer += static_cast<char>('0' + fraction / 10);
+            buffer += static_cast<char>('0' + fraction % 10);
+        }
+        return *this;
+    }
+
+    char digits[32];
+    int length = std::snprintf(digits, sizeof(digits), "%.17g", value);
+    buffer.append(digits, static_cast<size_t>(length));
+    return *this;
+}
+
+void RecordWriter::endRecord() {
+    buffer += '\n';
+    atRecordStart = true;
+}
@@ -0,0 +1,470 @@
+#include "../include/SharedCatalog.h"
+#include "../include/Exceptions.h"
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <cstring>
+#include <new>
+#include <thread>
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace {
+
+const uint32_t CATALOG_MAGIC = 0x4C494243; // "LIBC"
+const uint32_t CATALOG_VERSION = 3;
+
+// How long attach() waits for a region being filled, and for a name
+// being replaced (between the unlink and the new shm_open)
+const auto READY_TIMEOUT = std::chrono::seconds(2);
+const auto NAME_TIMEOUT = std::chrono::milliseconds(50);
+const auto ATTACH_POLL = std::chrono::milliseconds(5);
+
+// Average string bytes reserved per record in the pool
+const uint64_t POOL_BYTES_PER_ITEM = 256;
+const uint64_t POOL_BYTES_PER_USER = 192;
+
+// Every process must hash identically, so avoid std::hash
+uint64_t fnv1a(const std::string& key) {
+    uint64_t hash = 14695981039346656037ULL;
+    for (unsigned char c : key) {
+        hash ^= c;
+        hash *= 1099511628211ULL;
+    }
+    return hash;
+}
+
+uint32_t slotCountFor(int capacity) {
+    uint32_t slots = 16;
+    while (slots < static_cast<uint32_t>(capacity) * 2) {
+        slots <<= 1;
+    }
+    return slots;
+}
+
+uint64_t alignUp(uint64_t value) {
+    return (value + 63) & ~static_cast<uint64_t>(63);
+}
+
+std::string lowerCase(std::string text) {
+    std::transform(text.begin(), text.end(), text.begin(), ::tolower);
+    return text;
+}
+
+} // namespace
+
+SharedCatalog::SharedCatalog(const std::string& regionName, bool isOwner, void* mapping,
+                             size_t size)
+    : name(regionName), owner(isOwner), base(mapping), mappedSize(size) {}
+
+// ==================== Region Setup ====================
+
+#ifdef _WIN32
+
+std::unique_ptr<SharedCatalog> SharedCatalog::create(const std::string& regionName, int, int) {
+    throw InvalidOperationException("Shared catalog requires POSIX shared memory: " + regionName);
+}
+
+std::unique_ptr<SharedCatalog> SharedCatalog::attach(const std::string& regionName) {
+    throw InvalidOperationException("Shared catalog requires POSIX shared memory: " + regionName);
+}
+
+SharedCatalog::~SharedCatalog() {}
+
+#else
+
+std::unique_ptr<SharedCatalog> SharedCatalog::create(const std::string& regionName,
+                                                     int itemCapacity, int userCapacity) {
+    if (itemCapacity <= 0 || userCapacity <= 0) {
+        throw InvalidOperationException("Shared catalog capacities must be positive");
+    }
+
+    // Offsets of each section within the region
+    uint32_t itemSlots = slotCountFor(itemCapacity);
+    uint32_t userSlots = slotCountFor(userCapacity);
+    uint64_t itemsOffset = alignUp(sizeof(Header));
+    uint64_t usersOffset = alignUp(itemsOffset + sizeof(ItemRecord) * itemCapacity);
+    uint64_t itemIndexOffset = alignUp(usersOffset + sizeof(UserRecord) * userCapacity);
+    uint64_t userIndexOffset = alignUp(itemIndexOffset + sizeof(std::atomic<uint32_t>) * itemSlots);
+    uint64_t poolOffset = alignUp(userIndexOffset + sizeof(std::atomic<uint32_t>) * userSlots);
+    uint64_t poolCapacity = POOL_BYTES_PER_ITEM * itemCapacity + POOL_BYTES_PER_USER * userCapacity;
+    size_t size = poolOffset + poolCapacity;
+
+    // A region left behind by a crashed owner is replaced, not reused
+    shm_unlink(regionName.c_str());
+    int fd = shm_open(regionName.c_str(), O_CREAT | O_EXCL | O_RDWR, 0644);
+    if (fd < 0) {
+        throw FileIOException("shared memory " + regionName);
+    }
+    if (ftruncate(fd, size) != 0) {
+        ::close(fd);
+        shm_unlink(regionName.c_str());
+        throw FileIOException("shared memory " + regionName);
+    }
+    void* mapping = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    ::close(fd);
+    if (mapping == MAP_FAILED) {
+        shm_unlink(regionName.c_str());
+        throw FileIOException("shared memory " + regionName);
+    }
+
+    // ftruncate zero-fills, which is a valid empty state for every atomic
+    Header* header = new (mapping) Header();
+    header->magic = CATALOG_MAGIC;
+    header->version = CATALOG_VERSION;
+    header->itemCapacity = itemCapacity;
+    header->userCapacity = userCapacity;
+    header->itemSlots = itemSlots;
+    header->userSlots = userSlots;
+    header->itemsOffset = itemsOffset;
+    header->usersOffset = usersOffset;
+    header->itemIndexOffset = itemIndexOffset;
+    header->userIndexOffset = userIndexOffset;
+    header->poolOffset = poolOffset;
+    header->poolCapacity = poolCapacity;
+    header->itemCount.store(0);
+    header->userCount.store(0);
+    header->poolUsed.store(0);
+    header->retired.store(0);
+    header->ready.store(0);
+
+    if (!header->itemCount.is_lock_free() || !header->poolUsed.is_lock_free()) {
+        munmap(mapping, size);
+        shm_unlink(regionName.c_str());
+        throw InvalidOperationException("Shared catalog needs lock-free atomics");
+    }
+
+    return std::unique_ptr<SharedCatalog>(new SharedCatalog(regionName, true, mapping, size));
+}
+
+std::unique_ptr<SharedCatalog> SharedCatalog::attach(const std::string& regionName) {
+    auto start = std::chrono::steady_clock::now();
+    while (true) {
+        auto waited = std::chrono::steady_clock::now() - start;
+        int fd = shm_open(regionName.c_str(), O_RDONLY, 0);
+        if (fd < 0) {
+            // The owner may be between unlinking the name and creating it again
+            if (errno == ENOENT && waited < NAME_TIMEOUT) {
+                std::this_thread::sleep_for(ATTACH_POLL);
+                continue;
+            }
+            throw FileIOException("shared memory " + regionName);
+        }
+
+        // A region not yet sized is still being created
+        struct stat info;
+        if (fstat(fd, &info) != 0) {
+            ::close(fd);
+            throw FileIOException("shared memory " + regionName);
+        }
+        size_t size = info.st_size;
+        void* mapping = MAP_FAILED;
+        if (size >= sizeof(Header)) {
+            // Readers can never write: the pages are mapped read-only
+            mapping = mmap(nullptr, size, PROT_READ, MAP_SHARED, fd, 0);
+            if (mapping == MAP_FAILED) {
+                ::close(fd);
+                throw FileIOException("shared memory " + regionName);
+            }
+        }
+        ::close(fd);
+
+        const Header* header = static_cast<const Header*>(mapping);
+        if (mapping != MAP_FAILED && header->ready.load(std::memory_order_acquire) != 0) {
+            if (header->magic != CATALOG_MAGIC || header->version != CATALOG_VERSION ||
+                header->poolOffset + header->poolCapacity > size) {
+                munmap(mapping, size);
+                throw InvalidOperationException("Not a library catalog region: " + regionName);
+            }
+            return std::unique_ptr<SharedCatalog>(
+                new SharedCatalog(regionName, false, mapping, size));
+        }
+
+        // Not filled yet: a region of another layout, or one abandoned mid-fill,
+        // will never become ready
+        bool foreign = mapping != MAP_FAILED && header->magic != 0 &&
+                       (header->magic != CATALOG_MAGIC || header->version != CATALOG_VERSION);
+        bool abandoned = mapping != MAP_FAILED && !foreign &&
+                         header->retired.load(std::memory_order_acquire) != 0;
+        if (mapping != MAP_FAILED) {
+            munmap(mapping, size);
+        }
+        if (foreign) {
+            throw InvalidOperationException("Not a library catalog region: " + regionName);
+        }
+        if (abandoned || waited >= READY_TIMEOUT) {
+            throw FileIOException("shared memory " + regionName + " (never filled)");
+        }
+        std::this_thread::sleep_for(ATTACH_POLL);
+    }
+}
+
+SharedCatalog::~SharedCatalog() {
+    if (owner) {
+        // Readers keep their mapping, but it will not change again
+        header()->retired.store(1, std::memory_order_release);
+        shm_unlink(name.c_str());
+    }
+    munmap(base, mappedSize);
+}
+
+#endif
+
+// ==================== Layout Helpers ====================
+
+SharedCatalog::ItemRecord* SharedCatalog::itemAt(uint32_t index) const {
+    char* start = static_cast<char*>(base) + header()->itemsOffset;
+    return reinterpret_cast<ItemRecord*>(start) + index;
+}
+
+SharedCatalog::UserRecord* SharedCatalog::userAt(uint32_t index) const {
+    char* start = static_cast<char*>(base) + header()->usersOffset;
+    return reinterpret_cast<UserRecord*>(start) + index;
+}
+
+std::atomic<uint32_t>* SharedCatalog::itemIndex() const {
+    char* start = static_cast<char*>(base) + header()->itemIndexOffset;
+    return reinterpret_cast<std::atomic<uint32_t>*>(start);
+}
+
+std::atomic<uint32_t>* SharedCatalog::userIndex() const {
+    char* start = static_cast<char*>(base) + header()->userIndexOffset;
+    return reinterpret_cast<std::atomic<uint32_t>*>(start);
+}
+
+SharedCatalog::StringRef SharedCatalog::storeString(const std::string& value) {
+    Header* h = header();
+    uint64_t used = h->poolUsed.load(std::memory_order_relaxed);
+    if (used + value.size() > h->poolCapacity) {
+        throw InvalidOperationException("Shared catalog string pool is full");
+    }
+
+    StringRef ref;
+    ref.offset = h->poolOffset + used;
+    ref.length = static_cast<uint32_t>(value.size());
+    std::memcpy(static_cast<char*>(base) + ref.offset, value.data(), value.size());
+    h->poolUsed.store(used + value.size(), std::memory_order_relaxed);
+    return ref;
+}
+
+std::string SharedCatalog::loadString(const StringRef& ref) const {
+    return std::string(static_cast<const char*>(base) + ref.offset, ref.length);
+}
+
+void SharedCatalog::requireOwner() const {
+    if (!owner) {
+        throw InvalidOperationException("Shared catalog is read-only in this process");
+    }
+}
+
+int SharedCatalog::findItemIndex(const std::string& itemId) const {
+    uint32_t mask = header()->itemSlots - 1;
+    std::atomic<uint32_t>* slots = itemIndex();
+
+    for (uint32_t slot = fnv1a(itemId) & mask;; slot = (slot + 1) & mask) {
+        uint32_t entry = slots[slot].load(std::memory_order_acquire);
+        if (entry == 0) {
+            return -1;
+        }
+        if (loadString(itemAt(entry - 1)->itemId) == itemId) {
+            return entry - 1;
+        }
+    }
+}
+
+int SharedCatalog::findUserIndex(const std::string& userId) const {
+    uint32_t mask = header()->userSlots - 1;
+    std::atomic<uint32_t>* slots = userIndex();
+
+    for (uint32_t slot = fnv1a(userId) & mask;; slot = (slot + 1) & mask) {
+        uint32_t entry = slots[slot].load(std::memory_order_acquire);
+        if (entry == 0) {
+            return -1;
+        }
+        if (loadString(userAt(entry - 1)->userId) == userId) {
+            return entry - 1;
+        }
+    }
+}
+
+// ==================== Writer Operations ====================
+
+void SharedCatalog::addItem(const std::string& itemId, const std::string& title,
+                            const std::string& publisher, const std::string& itemType, int year,
+                            int totalCopies, int availableCopies, double lateFeePerDay) {
+    requireOwner();
+    Header* h = header();
+
+    uint32_t index = h->itemCount.load(std::memory_order_relaxed);
+    if (index >= h->itemCapacity) {
+        throw InvalidOperationException("Shared catalog item capacity reached");
+    }
+    if (findItemIndex(itemId) >= 0) {
+        throw InvalidOperationException("Item already in shared catalog: " + itemId);
+    }
+
+    ItemRecord* record = new (itemAt(index)) ItemRecord();
+    record->itemId = storeString(itemId);
+    record->title = storeString(title);
+    record->publisher = storeString(publisher);
+    record->itemType = storeString(itemType);
+    record->publicationYear = year;
+    record->totalCopies.store(totalCopies, std::memory_order_relaxed);
+    record->availableCopies.store(availableCopies, std::memory_order_relaxed);
+    record->lateFeePerDay = lateFeePerDay;
+
+    // Publish only once the record is complete
+    uint32_t mask = h->itemSlots - 1;
+    uint32_t slot = fnv1a(itemId) & mask;
+    while (itemIndex()[slot].load(std::memory_order_relaxed) != 0) {
+        slot = (slot + 1) & mask;
+    }
+    itemIndex()[slot].store(index + 1, std::memory_order_release);
+    h->itemCount.store(index + 1, std::memory_order_release);
+}
+
+void SharedCatalog::addUser(const std::string& userId, const std::string& userName,
+                            const std::string& email, const std::string& role,
+                            int maxBorrowLimit, int borrowDuration, int currentlyBorrowed) {
+    requireOwner();
+    Header* h = header();
+
+    uint32_t index = h->userCount.load(std::memory_order_relaxed);
+    if (index >= h->userCapacity) {
+        throw InvalidOperationException("Shared catalog user capacity reached");
+    }
+    if (findUserIndex(userId) >= 0) {
+        throw InvalidOperationException("User already in shared catalog: " + userId);
+    }
+
+    UserRecord* record = new (userAt(index)) UserRecord();
+    record->userId = storeString(userId);
+    record->name = storeString(userName);
+    record->email = storeString(email);
+    record->role = storeString(role);
+    record->maxBorrowLimit = maxBorrowLimit;
+    record->borrowDuration = borrowDuration;
+    record->currentlyBorrowed.store(currentlyBorrowed, std::memory_order_relaxed);
+
+    uint32_t mask = h->userSlots - 1;
+    uint32_t slot = fnv1a(userId) & mask;
+    while (userIndex()[slot].load(std::memory_order_relaxed) != 0) {
+        slot = (slot + 1) & mask;
+    }
+    userIndex()[slot].store(index + 1, std::memory_order_release);
+    h->userCount.store(index + 1, std::memory_order_release);
+}
+
+void SharedCatalog::updateItemCopies(const std::string& itemId, int totalCopies,
+                                     int availableCopies) {
+    requireOwner();
+    int index = findItemIndex(itemId);
+    if (index < 0) {
+        throw ItemNotFoundException(itemId);
+    }
+    ItemRecord* record = itemAt(index);
+    record->totalCopies.store(totalCopies, std::memory_order_relaxed);
+    record->availableCopies.store(availableCopies, std::memory_order_relaxed);
+}
+
+void SharedCatalog::updateUserLoans(const std::string& userId, int currentlyBorrowed) {
+    requireOwner();
+    int index = findUserIndex(userId);
+    if (index < 0) {
+        throw UserNotFoundException(userId);
+    }
+    userAt(index)->currentlyBorrowed.store(currentlyBorrowed, std::memory_order_relaxed);
+}
+
+void SharedCatalog::markReady() {
+    requireOwner();
+    header()->ready.store(1, std::memory_order_release);
+}
+
+void SharedCatalog::retire() {
+    requireOwner();
+    header()->retired.store(1, std::memory_order_release);
+    owner = false;
+}
+
+// ==================== Reader Operations ====================
+
+CatalogItem SharedCatalog::copyItem(const ItemRecord& record) const {
+    CatalogItem item;
+    item.itemId = loadString(record.itemId);
+    item.title = loadString(record.title);
+    item.publisher = loadString(record.publisher);
+    item.itemType = loadString(record.itemType);
+    item.publicationYear = record.publicationYear;
+    item.totalCopies = record.totalCopies.load(std::memory_order_relaxed);
+    item.availableCopies = record.availableCopies.load(std::memory_order_relaxed);
+    item.lateFeePerDay = record.lateFeePerDay;
+    return item;
+}
+
+CatalogUser SharedCatalog::copyUser(const UserRecord& record) const {
+    CatalogUser user;
+    user.userId = loadString(record.userId);
+    user.name = loadString(record.name);
+    user.email = loadString(record.email);
+    user.role = loadString(record.role);
+    user.maxBorrowLimit = record.maxBorrowLimit;
+    user.borrowDuration = record.borrowDuration;
+    user.currentlyBorrowed = record.currentlyBorrowed.load(std::memory_order_relaxed);
+    return user;
+}
+
+int SharedCatalog::getItemCount() const {
+    return header()->itemCount.load(std::memory_order_acquire);
+}
+
+int SharedCatalog::getUserCount() const {
+    return header()->userCount.load(std::memory_order_acquire);
+}
+
+std::vector<CatalogItem> SharedCatalog::getItems() const {
+    std::vector<CatalogItem> result;
+    uint32_t count = header()->itemCount.load(std::memory_order_acquire);
+    result.reserve(count);
+    for (uint32_t i = 0; i < count; i++) {
+        result.push_back(copyItem(*itemAt(i)));
+    }
+    return result;
+}
+
+bool SharedCatalog::findItem(const std::string& itemId, CatalogItem& item) const {
+    int index = findItemIndex(itemId);
+    if (index < 0) {
+        return false;
+    }
+    item = copyItem(*itemAt(index));
+    return true;
+}
+
+bool SharedCatalog::findUser(const std::string& userId, CatalogUser& user) const {
+    int index = findUserIndex(userId);
+    if (index < 0) {
+        return false;
+    }
+    user = copyUser(*userAt(index));
+    return true;
+}
+
+std::vector<CatalogItem> SharedCatalog::searchByTitle(const std::string& title) const {
+    std::vector<CatalogItem> results;
+    std::string lowerTitle = lowerCase(title);
+
+    uint32_t count = header()->itemCount.load(std::memory_order_acquire);
+    for (uint32_t i = 0; i < count; i++) {
+        const ItemRecord* record = itemAt(i);
+        if (lowerCase(loadString(record->title)).find(lowerTitle) != std::string::npos) {
+            results.push_back(copyItem(*record));
+        }
+    }
+    return results;
+}
@@ -1,11 +1,11 @@
 #include "../include/Student.h"
 #include <iostream>
-#include <sstream>
 
 Student::Student(const std::string& id, const std::string& name, const std::string& email,
                  const std::string& password, int age, const std::string& sid,
                  const std::string& maj, int yr)
-    : Person(id, name, email, password, age), studentId(sid), major(maj), year(yr) {}
+    : Person(id, name, email, password, age, PatronRole::Student), studentId(sid), major(maj),
+      year(yr) {}
 
 void Student::displayInfo() const {
     std::cout << "\n=== Student Information ===" << std::endl;
@@ -16,29 +16,16 @@ void Student::displayInfo() const {
     std::cout << "Student ID: " << studentId << std::endl;
     std::cout << "Major: " << major << std::endl;
     std::cout << "Year: " << year << std::endl;
-    std::cout << "Max Borrow Limit: " << getMaxBorrowLimit() << " items" << std::endl;
-    std::cout << "Borrow Duration: " << getBorrowDuration() << " days" << std::endl;
 }
 
 std::string Student::getRole() const {
     return "Student";
 }
 
-int Student::getMaxBorrowLimit() const {
-    // Students can borrow up to 5 items
-    return 5;
-}
-
-int Student::getBorrowDuration() const {
-    // Students can borrow for 14 days
-    return 14;
-}
-
-std::string Student::serialize() const {
-    std::ostringstream oss;
-    oss << "STUDENT|" << Person::serialize() << "|" 
-        << studentId << "|" << major << "|" << year;
-    return oss.str();
+void Student::writeTo(RecordWriter& out) const {
+    out.field("STUDENT");
+    Person::writeTo(out);
+    out.field(studentId).field(major).field(year);
 }
 
 Student::~Student() {
@@ -0,0 +1,187 @@
+#include "../include/TaskPool.h"
+#include <exception>
+
+thread_local int TaskPool::currentWorker = -1;
+
+// Chunks per thread in a parallel loop; more chunks than threads leaves
+// work to steal when some chunks run slower than others
+static const size_t CHUNKS_PER_THREAD = 4;
+
+TaskPool::TaskPool(unsigned workerCount)
+    : activeWorkers(workerCount), pending(0), stopping(false), nextQueue(0) {
+    for (unsigned i = 0; i < workerCount; i++) {
+        workers.push_back(std::unique_ptr<Worker>(new Worker()));
+    }
+    for (unsigned i = 0; i < workerCount; i++) {
+        threads.push_back(std::thread(&TaskPool::workerLoop, this, static_cast<int>(i)));
+    }
+}
+
+TaskPool::~TaskPool() {
+    shutdown();
+}
+
+// ==================== Scheduling ====================
+
+void TaskPool::submit(std::function<void()> task) {
+    // Workers push onto their own deque; other threads spread tasks around
+    unsigned queue = currentWorker >= 0
+        ? static_cast<unsigned>(currentWorker)
+        : nextQueue.fetch_add(1, std::memory_order_relaxed) % workers.size();
+    {
+        std::lock_guard<std::mutex> guard(workers[queue]->lock);
+        workers[queue]->tasks.push_back(std::move(task));
+    }
+    {
+        std::lock_guard<std::mutex> guard(sleepMutex);
+        pending.fetch_add(1, std::memory_order_release);
+    }
+    wake.notify_one();
+}
+
+bool TaskPool::runOne(int self) {
+    std::function<void()> task;
+    size_t count = workers.size();
+
+    // Own deque first, newest task (still warm in cache)
+    if (self >= 0) {
+        Worker& own = *workers[self];
+        std::lock_guard<std::mutex> guard(own.lock);
+        if (!own.tasks.empty()) {
+            task = std::move(own.tasks.back());
+            own.tasks.pop_back();
+        }
+    }
+
+    // Otherwise steal the oldest task from someone else
+    size_t start = self >= 0 ? static_cast<size_t>(self) + 1 : 0;
+    for (size_t k = 0; !task && k < count; k++) {
+        Worker& victim = *workers[(start + k) % count];
+        std::lock_guard<std::mutex> guard(victim.lock);
+        if (!victim.tasks.empty()) {
+            task = std::move(victim.tasks.front());
+            victim.tasks.pop_front();
+        }
+    }
+
+    if (!task) {
+        return false;
+    }
+    pending.fetch_sub(1, std::memory_order_acq_rel);
+    task();
+    return true;
+}
+
+void TaskPool::workerLoop(int index) {
+    currentWorker = index;
+    while (true) {
+        if (runOne(index)) {
+            continue;
+        }
+        std::unique_lock<std::mutex> guard(sleepMutex);
+        wake.wait(guard, [this] {
+            return pending.load(std::memory_order_acquire) > 0 ||
+                   stopping.load(std::memory_order_acquire);
+        });
+        if (stopping.load(std::memory_order_acquire) &&
+            pending.load(std::memory_order_acquire) == 0) {
+            return;
+        }
+    }
+}
+
+// ==================== Parallel Loops ====================
+
+size_t TaskPool::chunkCountFor(size_t length, size_t grain) const {
+    if (grain == 0) {
+        grain = 1;
+    }
+    size_t byGrain = (length + grain - 1) / grain;
+    unsigned parallelism = getParallelism();
+    size_t byThreads = parallelism == 1 ? 1 : parallelism * CHUNKS_PER_THREAD;
+    return std::max<size_t>(1, std::min(byGrain, byThreads));
+}
+
+void TaskPool::runChunks(size_t chunkCount, const std::function<void(size_t)>& chunkBody) {
+    if (chunkCount == 0) {
+        return;
+    }
+    if (chunkCount == 1 || stopping.load(std::memory_order_acquire) ||
+        activeWorkers.load(std::memory_order_acquire) == 0) {
+        for (size_t chunk = 0; chunk < chunkCount; chunk++) {
+            chunkBody(chunk);
+        }
+        return;
+    }
+
+    std::atomic<size_t> remaining(chunkCount);
+    std::exception_ptr failure;
+    std::mutex failureLock;
+
+    auto runChunk = [&](size_t chunk) {
+        try {
+            chunkBody(chunk);
+        } catch (...) {
+            std::lock_guard<std::mutex> guard(failureLock);
+            if (!failure) {
+                failure = std::current_exception();
+            }
+        }
+        remaining.fetch_sub(1, std::memory_order_acq_rel);
+    };
+
+    // The caller keeps chunk 0 and helps with the rest while it waits
+    for (size_t chunk = 1; chunk < chunkCount; chunk++) {
+        submit([&runChunk, chunk] { runChunk(chunk); });
+    }
+    runChunk(0);
+    while (remaining.load(std::memory_order_acquire) > 0) {
+        if (!runOne(currentWorker)) {
+            std::this_thread::yield();
+        }
+    }
+
+    if (failure) {
+        std::rethrow_exception(failure);
+    }
+}
+
+void TaskPool::parallelFor(size_t begin, size_t end, size_t grain,
+                           const std::function<void(size_t, size_t)>& body) {
+    if (end <= begin) {
+        return;
+    }
+    size_t chunkCount = chunkCountFor(end - begin, grain);
+    size_t chunkSize = (end - begin + chunkCount - 1) / chunkCount;
+
+    runChunks(chunkCount, [&](size_t chunk) {
+        size_t lo = begin + chunk * chunkSize;
+        size_t hi = std::min(end, lo + chunkSize);
+        if (lo < hi) {
+            body(lo, hi);
+        }
+    });
+}
+
+// ==================== Shutdown ====================
+
+void TaskPool::shutdown() {
+    {
+        std::lock_guard<std::mutex> guard(sleepMutex);
+        if (stopping.load()) {
+            return;
+        }
+        stopping.store(true, std::memory_order_release);
+    }
+    wake.notify_all();
+
+    // Workers drain whatever is still queued before they exit. Loops
+    // started from now on run inline; 'threads' keeps its size, since
+    // other threads may be reading the pool while this one waits.
+    activeWorkers.store(0, std::memory_order_release);
+    for (auto& thread : threads) {
+        if (thread.joinable()) {
+            thread.join();
+        }
+    }
+}
@@ -0,0 +1,235 @@
+#include "../include/TitleIndex.h"
+#include <algorithm>
+#include <mutex>
+#include <cctype>
+
+namespace {
+
+// Myers' bit-parallel approximate matcher for one query. Each 64-bit block
+// holds the vertical deltas of 64 rows of the edit-distance column; the
+// first row is all zeros so a match may start anywhere in the text.
+class BitParallelMatcher {
+private:
+    size_t length;
+    size_t blocks;
+    uint64_t lastBit;          // Row m within the last block
+    std::vector<uint64_t> peq; // peq[c * blocks + b]: rows of block b equal to c
+
+    // Advance block b by one text character; hin/hout are the horizontal
+    // deltas entering the block's top row and leaving its bottom row
+    int advance(uint64_t& pv, uint64_t& mv, uint64_t eq, int hin, uint64_t highBit) const {
+        uint64_t xv = eq | mv;
+        if (hin < 0) {
+            eq |= 1;
+        }
+        uint64_t xh = (((eq & pv) + pv) ^ pv) | eq;
+        uint64_t ph = mv | ~(xh | pv);
+        uint64_t mh = pv & xh;
+
+        int hout = 0;
+        if (ph & highBit) {
+            hout = 1;
+        } else if (mh & highBit) {
+            hout = -1;
+        }
+
+        ph <<= 1;
+        mh <<= 1;
+        if (hin < 0) {
+            mh |= 1;
+        } else if (hin > 0) {
+            ph |= 1;
+        }
+        pv = mh | ~(xv | ph);
+        mv = ph & xv;
+        return hout;
+    }
+
+public:
+    explicit BitParallelMatcher(const std::string& pattern)
+        : length(pattern.size()), blocks((pattern.size() + 63) / 64),
+          lastBit(1ULL << ((pattern.size() - 1) % 64)), peq(256 * ((pattern.size() + 63) / 64), 0) {
+        for (size_t i = 0; i < length; i++) {
+            unsigned char c = static_cast<unsigned char>(pattern[i]);
+            peq[c * blocks + i / 64] |= 1ULL << (i % 64);
+        }
+    }
+
+    // Smallest edit distance between the pattern and any substring of
+    // 'text'; stops early once it reaches zero
+    int bestDistance(const std::string& text) const {
+        int score = static_cast<int>(length);
+        int best = score;
+
+        if (blocks == 1) {
+            uint64_t pv = ~0ULL;
+            uint64_t mv = 0;
+            for (unsigned char c : text) {
+                score += advance(pv, mv, peq[c], 0, lastBit);
+                best = std::min(best, score);
+                if (best == 0) {
+                    break;
+                }
+            }
+            return best;
+        }
+
+        std::vector<uint64_t> pv(blocks, ~0ULL);
+        std::vector<uint64_t> mv(blocks, 0);
+        for (unsigned char c : text) {
+            int carry = 0;
+            for (size_t b = 0; b < blocks; b++) {
+                uint64_t highBit = b + 1 == blocks ? lastBit : 1ULL << 63;
+                carry = advance(pv[b], mv[b], peq[c * blocks + b], carry, highBit);
+            }
+            score += carry;
+            best = std::min(best, score);
+            if (best == 0) {
+                break;
+            }
+        }
+        return best;
+    }
+};
+
+// Smallest range of titles worth filtering on another thread
+const size_t VERIFY_GRAIN = 16384;
+
+} // namespace
+
+const size_t TitleIndex::GRAM;
+
+std::string TitleIndex::normalize(const std::string& text) {
+    std::string lower = text;
+    std::transform(lower.begin(), lower.end(), lower.begin(), ::tolower);
+    return lower;
+}
+
+uint32_t TitleIndex::gramKey(const std::string& text, size_t pos) {
+    return (static_cast<uint32_t>(static_cast<unsigned char>(text[pos])) << 16) |
+           (static_cast<uint32_t>(static_cast<unsigned char>(text[pos + 1])) << 8) |
+           static_cast<uint32_t>(static_cast<unsigned char>(text[pos + 2]));
+}
+
+void TitleIndex::add(const std::string& itemId, const std::string& title) {
+    std::unique_lock<std::shared_timed_mutex> lock(indexMutex);
+    uint32_t number = static_cast<uint32_t>(titles.size());
+    itemIds.push_back(itemId);
+    titles.push_back(normalize(title));
+
+    const std::string& text = titles.back();
+    for (size_t pos = 0; pos + GRAM <= text.size(); pos++) {
+        std::vector<uint32_t>& list = postings[gramKey(text, pos)];
+        if (list.empty() || list.back() != number) {
+            list.push_back(number);
+        }
+    }
+}
+
+void TitleIndex::clear() {
+    std::unique_lock<std::shared_timed_mutex> lock(indexMutex);
+    itemIds.clear();
+    titles.clear();
+    postings.clear();
+}
+
+size_t TitleIndex::size() const {
+    std::shared_lock<std::shared_timed_mutex> lock(indexMutex);
+    return titles.size();
+}
+
+std::vector<TitleMatch> TitleIndex::search(const std::string& query, int maxDistance,
+                                           size_t limit, TaskPool& pool) const {
+    std::string pattern = normalize(query);
+    if (pattern.empty()) {
+        return std::vector<TitleMatch>();
+    }
+    maxDistance = std::max(0, maxDistance);
+
+    std::shared_lock<std::shared_timed_mutex> lock(indexMutex);
+
+    // Posting lists of the query's distinct trigrams, and how many of them
+    // a title must appear in to possibly match
+    std::vector<const std::vector<uint32_t>*> lists;
+    size_t threshold = 0;
+    if (pattern.size() >= GRAM) {
+        std::vector<uint32_t> grams;
+        for (size_t pos = 0; pos + GRAM <= pattern.size(); pos++) {
+            grams.push_back(gramKey(pattern, pos));
+        }
+        std::sort(grams.begin(), grams.end());
+        grams.erase(std::unique(grams.begin(), grams.end()), grams.end());
+
+        size_t destroyed = static_cast<size_t>(maxDistance) * GRAM;
+        if (grams.size() > destroyed) {
+            threshold = grams.size() - destroyed;
+            for (uint32_t gram : grams) {
+                auto it = postings.find(gram);
+                if (it != postings.end()) {
+                    lists.push_back(&it->second);
+                }
+            }
+        }
+    }
+    if (threshold > lists.size()) {
+        return std::vector<TitleMatch>(); // Too few trigrams occur anywhere
+    }
+
+    // Each task counts trigram hits for its own range of titles, then
+    // verifies the titles that reach the threshold
+    BitParallelMatcher matcher(pattern);
+    typedef std::vector<std::pair<uint32_t, int>> Hits;
+    Hits hits = pool.parallelReduce(
+        0, titles.size(), VERIFY_GRAIN, Hits(),
+        [&](size_t begin, size_t end) {
+            std::vector<uint16_t> counts;
+            if (threshold > 0) {
+                counts.assign(end - begin, 0);
+                for (const std::vector<uint32_t>* list : lists) {
+                    auto it = std::lower_bound(list->begin(), list->end(), static_cast<uint32_t>(begin));
+                    for (; it != list->end() && *it < end; ++it) {
+                        counts[*it - begin]++;
+                    }
+                }
+            }
+
+            Hits found;
+            for (size_t i = begin; i < end; i++) {
+                if (threshold > 0 && counts[i - begin] < threshold) {
+                    continue;
+                }
+                int distance = matcher.bestDistance(titles[i]);
+                if (distance <= maxDistance) {
+                    found.push_back(std::make_pair(static_cast<uint32_t>(i), distance));
+                }
+            }
+            return found;
+        },
+        [](Hits all, Hits found) {
+            all.insert(all.end(), found.begin(), found.end());
+            return all;
+        });
+
+    auto closer = [this](const std::pair<uint32_t, int>& a, const std::pair<uint32_t, int>& b) {
+        if (a.second != b.second) {
+            return a.second < b.second;
+        }
+        if (titles[a.first] != titles[b.first]) {
+            return titles[a.first] < titles[b.first];
+        }
+        return itemIds[a.first] < itemIds[b.first];
+    };
+    if (limit > 0 && hits.size() > limit) {
+        std::partial_sort(hits.begin(), hits.begin() + limit, hits.end(), closer);
+        hits.resize(limit);
+    } else {
+        std::sort(hits.begin(), hits.end(), closer);
+    }
+
+    std::vector<TitleMatch> matches;
+    matches.reserve(hits.size());
+    for (const auto& hit : hits) {
+        matches.push_back(TitleMatch{itemIds[hit.first], hit.second});
+    }
+    return matches;
+}
@@ -1,14 +1,35 @@
 #include "../include/Transaction.h"
+#include "../include/Exceptions.h"
 #include <iostream>
-#include <sstream>
 #include <iomanip>
 
-Transaction::Transaction(const std::string& tid, const std::string& uid, 
-                         const std::string& iid, int borrowDurationDays)
-    : transactionId(tid), userId(uid), itemId(iid), isReturned(false), 
-      fineAmount(0.0), returnDate(0) {
-    borrowDate = time(nullptr);
-    dueDate = borrowDate + (borrowDurationDays * 24 * 60 * 60); // Convert days to seconds
+Transaction::Transaction()
+    : borrowDate(0), dueDate(0), returnDate(0), isReturned(false),
+      fineAmount(0.0), accruedFine(0.0), lateFeePerDay(-1.0), fineCap(0.0) {}
+
+Transaction::Transaction(const std::string& tid, const std::string& uid,
+                         const std::string& iid, const std::string& barcode,
+                         time_t borrowed, time_t due, double feePerDay, double cap)
+    : transactionId(tid), userId(uid), itemId(iid), copyBarcode(barcode),
+      borrowDate(borrowed), dueDate(due), returnDate(0), isReturned(false),
+      fineAmount(0.0), accruedFine(0.0), lateFeePerDay(feePerDay), fineCap(cap) {}
+
+Transaction Transaction::deserialize(const std::vector<std::string>& fields) {
+    if (fields.size() < 10) {
+        throw InvalidOperationException("Malformed transaction record");
+    }
+    
+    // Loan terms were added as fields 10 and 11
+    Transaction trans(fields[0], fields[1], fields[2], fields[8],
+                      static_cast<time_t>(std::stoll(fields[3])),
+                      static_cast<time_t>(std::stoll(fields[4])),
+                      fields.size() >= 12 ? std::stod(fields[10]) : -1.0,
+                      fields.size() >= 12 ? std::stod(fields[11]) : 0.0);
+    trans.returnDate = static_cast<time_t>(std::stoll(fields[5]));
+    trans.isReturned = fields[6] == "1";
+    trans.fineAmount = std::stod(fields[7]);
+    trans.accruedFine = std::stod(fields[9]);
+    return trans;
 }
 
 int Transaction::daysBetween(time_t start, time_t end) const {
@@ -16,22 +37,49 @@ int Transaction::daysBetween(time_t start, time_t end) const {
     return static_cast<int>(seconds / (24 * 60 * 60));
 }
 
-double Transaction::processReturn(double lateFeePerDay) {
+void Transaction::setLoanTerms(double feePerDay, double cap) {
+    lateFeePerDay = feePerDay;
+    fineCap = cap;
+}
+
+double Transaction::fineUntil(time_t until) const {
+    double fine = daysBetween(dueDate, until) * lateFeePerDay;
+    if (fineCap > 0 && fine > fineCap) {
+        fine = fineCap;
+    }
+    return fine;
+}
+
+double Transaction::processReturn(time_t when) {
     if (isReturned) {
         return fineAmount;
     }
     
-    returnDate = time(nullptr);
+    returnDate = when;
     isReturned = true;
     
     if (returnDate > dueDate) {
-        int overdueDays = daysBetween(dueDate, returnDate);
-        fineAmount = overdueDays * lateFeePerDay;
+        fineAmount = fineUntil(returnDate);
     }
     
     return fineAmount;
 }
 
+double Transaction::accrueFine(time_t now) {
+    if (isReturned || now <= dueDate) {
+        return 0.0;
+    }
+    
+    double owed = fineUntil(now);
+    if (owed <= accruedFine) {
+        return 0.0;
+    }
+    
+    double delta = owed - accruedFine;
+    accruedFine = owed;
+    return delta;
+}
+
 bool Transaction::isOverdue() const {
     if (isReturned) {
         return returnDate > dueDate;
@@ -54,37 +102,58 @@ int Transaction::daysOverdue() const {
 }
 
 void Transaction::displayInfo() const {
-    std::cout << "\n=== Transaction Information ===" << std::endl;
-    std::cout << "Transaction ID: " << transactionId << std::endl;
-    std::cout << "User ID: " << userId << std::endl;
-    std::cout << "Item ID: " << itemId << std::endl;
-    std::cout << "Borrow Date: " << timeToString(borrowDate) << std::endl;
-    std::cout << "Due Date: " << timeToString(dueDate) << std::endl;
+    displayInfo(std::cout);
+}
+
+void Transaction::displayInfo(std::ostream& out) const {
+    out << "\n=== Transaction Information ===" << std::endl;
+    out << "Transaction ID: " << transactionId << std::endl;
+    out << "User ID: " << userId << std::endl;
+    out << "Item ID: " << itemId << std::endl;
+    if (!copyBarcode.empty()) {
+        out << "Copy Barcode: " << copyBarcode << std::endl;
+    }
+    out << "Borrow Date: " << timeToString(borrowDate) << std::endl;
+    out << "Due Date: " << timeToString(dueDate) << std::endl;
     
     if (isReturned) {
-        std::cout << "Return Date: " << timeToString(returnDate) << std::endl;
-        std::cout << "Fine Amount: $" << std::fixed << std::setprecision(2) << fineAmount << std::endl;
+        out << "Return Date: " << timeToString(returnDate) << std::endl;
+        out << "Fine Amount: $" << std::fixed << std::setprecision(2) << fineAmount << std::endl;
     } else {
-        std::cout << "Status: Not yet returned" << std::endl;
+        out << "Status: Not yet returned" << std::endl;
         if (isOverdue()) {
-            std::cout << "Days Overdue: " << daysOverdue() << std::endl;
+            out << "Days Overdue: " << daysOverdue() << std::endl;
+            out << "Accrued Fine: $" << std::fixed << std::setprecision(2) << accruedFine << std::endl;
         }
     }
 }
 
+void Transaction::writeTo(RecordWriter& out) const {
+    // Fines must round-trip exactly through snapshots, which field(double) guarantees
+    out.field(transactionId).field(userId).field(itemId)
+       .field(borrowDate).field(dueDate).field(returnDate)
+       .field(isReturned).field(fineAmount).field(copyBarcode).field(accruedFine)
+       .field(lateFeePerDay).field(fineCap);
+}
+
 std::string Transaction::serialize() const {
-    std::ostringstream oss;
-    oss << transactionId << "|" << userId << "|" << itemId << "|"
-        << borrowDate << "|" << dueDate << "|" << returnDate << "|"
-        << isReturned << "|" << fineAmount;
-    return oss.str();
+    std::string record;
+    RecordWriter out(record);
+    writeTo(out);
+    return record;
 }
 
 std::string Transaction::timeToString(time_t t) {
     if (t == 0) return "N/A";
     
+    // Reports format rows on several threads, so no shared static buffer
     char buffer[80];
-    struct tm* timeinfo = localtime(&t);
-    strftime(buffer, sizeof(buffer), "%Y-%m-%d %H:%M:%S", timeinfo);
+    struct tm timeinfo;
+#ifdef _WIN32
+    localtime_s(&timeinfo, &t);
+#else
+    localtime_r(&t, &timeinfo);
+#endif
+    strftime(buffer, sizeof(buffer), "%Y-%m-%d %H:%M:%S", &timeinfo);
     return std::string(buffer);
 }
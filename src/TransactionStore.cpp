@@ -0,0 +1,202 @@
+#include "../include/TransactionStore.h"
+#include "../include/Exceptions.h"
+
+const size_t TransactionStore::CHUNK_SIZE;
+const size_t TransactionStore::BLOCK_CHUNKS;
+const size_t TransactionStore::MAX_BLOCKS;
+
+TransactionStore::Block::Block() {
+    for (size_t i = 0; i < BLOCK_CHUNKS; i++) {
+        chunks[i].store(nullptr, std::memory_order_relaxed);
+    }
+}
+
+TransactionStore::Chunk::Chunk()
+    : rows(std::make_shared<Rows>(CHUNK_SIZE)), live(rows.get()), shared(false) {
+    for (size_t i = 0; i < CHUNK_SIZE; i++) {
+        committed[i].store(false, std::memory_order_relaxed);
+    }
+}
+
+TransactionStore::TransactionStore()
+    : directory(new std::atomic<Block*>[MAX_BLOCKS]),
+      nextIndex(0), committedCount(0), version(0),
+      current(std::make_shared<TransactionSnapshot>()) {
+    for (size_t i = 0; i < MAX_BLOCKS; i++) {
+        directory[i].store(nullptr, std::memory_order_relaxed);
+    }
+}
+
+TransactionStore::~TransactionStore() {
+    clear();
+}
+
+// ==================== Appends ====================
+
+TransactionStore::Chunk* TransactionStore::chunkFor(size_t index) {
+    size_t chunkIndex = index / CHUNK_SIZE;
+    size_t blockIndex = chunkIndex / BLOCK_CHUNKS;
+    if (blockIndex >= MAX_BLOCKS) {
+        throw InvalidOperationException("Transaction log is full");
+    }
+
+    // Several threads may race to install the same block or chunk; one wins
+    Block* block = directory[blockIndex].load(std::memory_order_acquire);
+    if (block == nullptr) {
+        Block* freshBlock = new Block();
+        if (directory[blockIndex].compare_exchange_strong(block, freshBlock,
+                                                          std::memory_order_acq_rel,
+                                                          std::memory_order_acquire)) {
+            block = freshBlock;
+        } else {
+            delete freshBlock;
+        }
+    }
+
+    std::atomic<Chunk*>& entry = block->chunks[chunkIndex % BLOCK_CHUNKS];
+    Chunk* chunk = entry.load(std::memory_order_acquire);
+    if (chunk != nullptr) {
+        return chunk;
+    }
+    Chunk* fresh = new Chunk();
+    if (entry.compare_exchange_strong(chunk, fresh, std::memory_order_acq_rel,
+                                      std::memory_order_acquire)) {
+        return fresh;
+    }
+    delete fresh;
+    return chunk;
+}
+
+TransactionStore::Chunk* TransactionStore::chunkAt(size_t chunkIndex) const {
+    size_t blockIndex = chunkIndex / BLOCK_CHUNKS;
+    if (blockIndex >= MAX_BLOCKS) {
+        return nullptr;
+    }
+    const Block* block = directory[blockIndex].load(std::memory_order_acquire);
+    if (block == nullptr) {
+        return nullptr;
+    }
+    return block->chunks[chunkIndex % BLOCK_CHUNKS].load(std::memory_order_acquire);
+}
+
+TransactionStore::Chunk* TransactionStore::findChunk(size_t index) const {
+    return chunkAt(index / CHUNK_SIZE);
+}
+
+size_t TransactionStore::allocate() {
+    return nextIndex.fetch_add(1, std::memory_order_relaxed);
+}
+
+TransactionStore::Rows& TransactionStore::writableRows(Chunk& chunk) {
+    if (chunk.shared) {
+        // A snapshot still reads these rows; write to a private copy. The
+        // old rows stay alive until the next publish(), so references
+        // taken by the writer before the copy remain valid.
+        chunk.replaced = chunk.rows;
+        chunk.rows = std::make_shared<Rows>(*chunk.replaced);
+        chunk.live.store(chunk.rows.get(), std::memory_order_release);
+        chunk.shared = false;
+    }
+    return *chunk.rows;
+}
+
+void TransactionStore::commit(size_t index, const Transaction& trans) {
+    Chunk* chunk = chunkFor(index);
+    size_t offset = index % CHUNK_SIZE;
+    {
+        std::lock_guard<std::mutex> guard(chunk->rowsMutex);
+        if (chunk->committed[offset].load(std::memory_order_relaxed)) {
+            throw InvalidOperationException("Transaction slot already used: " +
+                                            trans.getTransactionId());
+        }
+        writableRows(*chunk)[offset] = trans;
+        chunk->committed[offset].store(true, std::memory_order_release);
+    }
+    committedCount.fetch_add(1, std::memory_order_relaxed);
+    version.fetch_add(1, std::memory_order_relaxed);
+
+    // Slots placed by index must never be handed out again
+    size_t seen = nextIndex.load(std::memory_order_relaxed);
+    while (seen <= index &&
+           !nextIndex.compare_exchange_weak(seen, index + 1, std::memory_order_relaxed)) {
+    }
+}
+
+// ==================== Row Access ====================
+
+bool TransactionStore::isCommitted(size_t index) const {
+    const Chunk* chunk = findChunk(index);
+    return chunk != nullptr && chunk->committed[index % CHUNK_SIZE].load(std::memory_order_acquire);
+}
+
+Transaction& TransactionStore::at(size_t index) {
+    Chunk* chunk = findChunk(index);
+    version.fetch_add(1, std::memory_order_relaxed);
+    std::lock_guard<std::mutex> guard(chunk->rowsMutex);
+    return writableRows(*chunk)[index % CHUNK_SIZE];
+}
+
+const Transaction& TransactionStore::get(size_t index) const {
+    return (*findChunk(index)->live.load(std::memory_order_acquire))[index % CHUNK_SIZE];
+}
+
+void TransactionStore::clear() {
+    for (size_t i = 0; i < MAX_BLOCKS; i++) {
+        Block* block = directory[i].exchange(nullptr, std::memory_order_relaxed);
+        if (block == nullptr) {
+            continue;
+        }
+        for (size_t c = 0; c < BLOCK_CHUNKS; c++) {
+            delete block->chunks[c].load(std::memory_order_relaxed);
+        }
+        delete block;
+    }
+    nextIndex.store(0);
+    committedCount.store(0);
+    version.fetch_add(1, std::memory_order_relaxed);
+}
+
+// ==================== Snapshots ====================
+
+std::shared_ptr<const TransactionSnapshot> TransactionStore::publish() const {
+    std::shared_ptr<const TransactionSnapshot> previous = std::atomic_load(&current);
+    unsigned long long now = version.load(std::memory_order_relaxed);
+    size_t total = size();
+    if (previous->version == now && previous->count == total) {
+        return previous; // Nothing written since the last snapshot
+    }
+
+    auto snapshot = std::make_shared<TransactionSnapshot>();
+    snapshot->version = now;
+    snapshot->count = total;
+    snapshot->chunkSize = CHUNK_SIZE;
+
+    // Share every chunk's live rows; the next write to one copies it
+    size_t chunkCount = (total + CHUNK_SIZE - 1) / CHUNK_SIZE;
+    std::shared_ptr<const Rows> abandoned;
+    snapshot->chunks.reserve(chunkCount);
+    for (size_t c = 0; c < chunkCount; c++) {
+        Chunk* chunk = chunkAt(c);
+        if (chunk == nullptr) {
+            // Every slot in it was allocated and abandoned
+            if (!abandoned) {
+                abandoned = std::make_shared<const Rows>(CHUNK_SIZE);
+            }
+            snapshot->chunks.push_back(abandoned);
+            continue;
+        }
+
+        std::lock_guard<std::mutex> guard(chunk->rowsMutex);
+        chunk->shared = true;
+        chunk->replaced.reset();
+        snapshot->chunks.push_back(chunk->rows);
+    }
+
+    std::shared_ptr<const TransactionSnapshot> result = snapshot;
+    std::atomic_store(&current, result);
+    return result;
+}
+
+std::shared_ptr<const TransactionSnapshot> TransactionStore::latest() const {
+    return std::atomic_load(&current);
+}
@@ -0,0 +1,122 @@
+#include "../include/WorkloadTrace.h"
+#include "../include/RecordWriter.h"
+#include "../include/LibraryEvent.h"
+#include "../include/Exceptions.h"
+#include <iostream>
+#include <fstream>
+
+// Buffered records are written once this much has built up
+static const size_t WRITE_BYTES = 64 * 1024;
+
+static const char* const OP_NAMES[] = {
+    "BORROW", "RETURN", "SEARCH_TITLE", "SEARCH_KEYWORDS", "SEARCH_TYPE"
+};
+static const int OP_COUNT = sizeof(OP_NAMES) / sizeof(OP_NAMES[0]);
+
+TraceRecorder::TraceRecorder(const std::string& traceFile)
+    : filename(traceFile), file(std::fopen(traceFile.c_str(), "wb")),
+      start(std::chrono::steady_clock::now()), recorded(0) {
+    if (file == nullptr) {
+        throw FileIOException(traceFile);
+    }
+}
+
+TraceRecorder::~TraceRecorder() {
+    flush();
+    if (file != nullptr) {
+        std::fclose(file);
+    }
+}
+
+const char* TraceRecorder::opName(TraceOp op) {
+    return OP_NAMES[static_cast<int>(op)];
+}
+
+std::string TraceRecorder::snapshotFileFor(const std::string& traceFile) {
+    return traceFile + ".snapshot";
+}
+
+void TraceRecorder::writeBuffer() {
+    // A trace that cannot be written must not fail the call being traced
+    if (file != nullptr && !buffer.empty()) {
+        if (std::fwrite(buffer.data(), 1, buffer.size(), file) != buffer.size() ||
+            std::fflush(file) != 0) {
+            std::cerr << "Cannot write workload trace " << filename
+                      << "; recording stopped." << std::endl;
+            std::fclose(file);
+            file = nullptr;
+        }
+    }
+    buffer.clear();
+}
+
+void TraceRecorder::record(TraceOp op, const std::string& userId, const std::string& argument,
+                           unsigned long long limit) {
+    std::lock_guard<std::mutex> lock(mutex);
+    if (file == nullptr) {
+        return;
+    }
+    // Taken under the lock so offsets never decrease down the file
+    auto offset = std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::steady_clock::now() - start).count();
+    RecordWriter out(buffer);
+    out.field(static_cast<long long>(offset)).field(opName(op)).field(userId).field(argument)
+       .field(limit);
+    out.endRecord();
+    recorded++;
+    if (buffer.size() >= WRITE_BYTES) {
+        writeBuffer();
+    }
+}
+
+void TraceRecorder::flush() {
+    std::lock_guard<std::mutex> lock(mutex);
+    writeBuffer();
+}
+
+unsigned long long TraceRecorder::getRecordedCount() {
+    std::lock_guard<std::mutex> lock(mutex);
+    return recorded;
+}
+
+std::vector<TraceEntry> TraceRecorder::readTrace(const std::string& traceFile) {
+    std::ifstream in(traceFile);
+    if (!in) {
+        throw FileIOException(traceFile);
+    }
+
+    std::vector<TraceEntry> entries;
+    std::string line;
+    int lineNumber = 0;
+    while (std::getline(in, line)) {
+        lineNumber++;
+        if (line.empty()) {
+            continue;
+        }
+        std::vector<std::string> fields = LibraryEvent::splitRecord(line);
+        std::string where = " on trace line " + std::to_string(lineNumber);
+        if (fields.size() != 5) {
+            throw InvalidOperationException("Wrong number of fields" + where);
+        }
+
+        TraceEntry entry;
+        int op = 0;
+        while (op < OP_COUNT && fields[1] != OP_NAMES[op]) {
+            op++;
+        }
+        if (op == OP_COUNT) {
+            throw InvalidOperationException("Unknown operation '" + fields[1] + "'" + where);
+        }
+        try {
+            entry.offsetMicros = std::stoull(fields[0]);
+            entry.limit = std::stoull(fields[4]);
+        } catch (const std::exception&) {
+            throw InvalidOperationException("Bad number" + where);
+        }
+        entry.op = static_cast<TraceOp>(op);
+        entry.userId = fields[2];
+        entry.argument = fields[3];
+        entries.push_back(std::move(entry));
+    }
+    return entries;
+}
@@ -1,6 +1,13 @@
 #include <iostream>
 #include <limits>
+#include <iomanip>
+#include <cstdlib>
+#include <algorithm>
+#include <fstream>
+#include <chrono>
 #include "../include/Library.h"
+#include "../include/BatchSession.h"
+#include "../include/LoadDriver.h"
 #include "../include/Exceptions.h"
 
 using namespace std;
@@ -16,44 +23,225 @@ void registerNewUser(Library* lib);
 void loginUser(Library* lib);
 void addNewItem(Library* lib);
 void searchItems(Library* lib);
+void manageHolds(Library* lib, shared_ptr<Person> user);
+void runCatalogReader(const string& regionName);
+void displayCatalogItem(const CatalogItem& item);
+int runBatch(Library* lib, const string& source, streambuf* results);
+int runReplay(Library* lib, const string& traceFile, double speedup, unsigned concurrency,
+              streambuf* results);
 
-int main() {
+// Latest snapshot, plus the journal of every change made since
+const string SNAPSHOT_FILE = "library_data.snapshot";
+const string JOURNAL_FILE = "library_data.journal";
+
+// Loan limits, durations and fees; built-in defaults apply while it is missing
+const string POLICY_FILE = "loan_policy.cfg";
+
+// Closest matches listed by a typo-tolerant search
+const size_t FUZZY_RESULTS_SHOWN = 20;
+
+// Best matches listed by a keyword search
+const size_t RANKED_RESULTS_SHOWN = 10;
+
+// Items listed by the most-borrowed report
+const size_t POPULAR_RESULTS_SHOWN = 10;
+
+// Items listed as borrowed by the same patrons
+const size_t RELATED_RESULTS_SHOWN = 10;
+
+// Room left in a published shared catalog for titles and users added
+// later; once it is used up the catalog moves to a region twice the size
+const int SHARED_CATALOG_HEADROOM = 1024;
+
+int main(int argc, char* argv[]) {
+    // --catalog-reader NAME: browse a catalog another process publishes
+    // --publish-catalog NAME: run normally and publish the catalog as NAME
+    // --threads N: threads used by reports and batch jobs (default: all cores)
+    // --lazy-catalog N: decode items on first use, keeping up to N unchanged ones
+    // --branch NAME: lend on the loan policy overrides for branch NAME
+    // --batch FILE: run the commands in FILE ('-' for stdin) and exit; results
+    //               go to stdout as records, everything else to stderr
+    // --record-trace FILE: capture borrows, returns and searches into FILE
+    // --replay-trace FILE: replay a captured workload and report on it, with
+    //               --speedup X (default 1, 0 = unpaced) on --concurrency N threads
+    string publishName;
+    string branchName;
+    string batchSource;
+    string recordTrace;
+    string replayTrace;
+    int threadCount = 0;
+    int lazyCacheSize = 0;
+    double speedup = 1;
+    int concurrency = 4;
+    for (int i = 1; i + 1 < argc; i++) {
+        string option = argv[i];
+        if (option == "--catalog-reader") {
+            try {
+                runCatalogReader(argv[i + 1]);
+            } catch (const LibraryException& e) {
+                cerr << "Error: " << e.what() << endl;
+                return 1;
+            }
+            return 0;
+        }
+        if (option == "--publish-catalog") {
+            publishName = argv[++i];
+        }
+        if (option == "--threads") {
+            threadCount = atoi(argv[++i]);
+            if (threadCount < 1) {
+                cerr << "Error: --threads needs a positive count" << endl;
+                return 1;
+            }
+        }
+        if (option == "--branch") {
+            branchName = argv[++i];
+        }
+        if (option == "--batch") {
+            batchSource = argv[++i];
+        }
+        if (option == "--record-trace") {
+            recordTrace = argv[++i];
+        }
+        if (option == "--replay-trace") {
+            replayTrace = argv[++i];
+        }
+        if (option == "--speedup") {
+            speedup = atof(argv[++i]);
+            if (speedup < 0) {
+                cerr << "Error: --speedup cannot be negative" << endl;
+                return 1;
+            }
+        }
+        if (option == "--concurrency") {
+            concurrency = atoi(argv[++i]);
+            if (concurrency < 1) {
+                cerr << "Error: --concurrency needs a positive count" << endl;
+                return 1;
+            }
+        }
+        if (option == "--lazy-catalog") {
+            lazyCacheSize = atoi(argv[++i]);
+            if (lazyCacheSize < 1) {
+                cerr << "Error: --lazy-catalog needs a positive cache size" << endl;
+                return 1;
+            }
+        }
+    }
+    
+    // In batch and replay mode stdout carries only results; the library's
+    // messages are sent to stderr instead
+    bool unattended = !batchSource.empty() || !replayTrace.empty();
+    streambuf* results = nullptr;
+    if (unattended) {
+        ios::sync_with_stdio(false);
+        cin.tie(nullptr);
+        results = cout.rdbuf(cerr.rdbuf());
+    }
+    
     Library* library = Library::getInstance();
+    if (threadCount > 0) {
+        library->configureTaskPool(threadCount);
+    }
+    if (lazyCacheSize > 0) {
+        library->configureLazyCatalog(lazyCacheSize);
+    }
+    try {
+        library->configureLoanPolicy(POLICY_FILE, branchName);
+    } catch (const LibraryException& e) {
+        cerr << "Error in " << POLICY_FILE << ": " << e.what() << endl;
+        return 1;
+    }
+    
+    // A replay runs in memory on the state saved with the trace; the
+    // library's own snapshot and journal are never opened
+    if (!replayTrace.empty()) {
+        int status = runReplay(library, replayTrace, speedup, concurrency, results);
+        cout.rdbuf(results);
+        library->shutdownTaskPool();
+        return status;
+    }
     
-    // Add sample data for demonstration
+    // Restore the previous session, or start fresh with sample data
+    bool recovered = false;
     try {
-        // Sample users
-        library->registerStudent("S001", "Alice Johnson", "alice@email.com", "pass123", 20,
-                                "STU2024001", "Computer Science", 3);
-        library->registerFaculty("F001", "Dr. Bob Smith", "bob@email.com", "pass456", 45,
-                                "EMP001", "Computer Science", "Professor");
-        library->registerLibrarian("L001", "Charlie Brown", "charlie@email.com", "pass789", 35,
-                                  "LIB001", "Morning");
-        
-        // Sample items
-        library->addBook("B001", "Introduction to Algorithms", "MIT Press", 2009,
-                        "978-0262033848", "Thomas H. Cormen", "Computer Science", 1312);
-        library->addBook("B002", "Clean Code", "Prentice Hall", 2008,
-                        "978-0132350884", "Robert C. Martin", "Software Engineering", 464);
-        library->addMagazine("M001", "National Geographic", "National Geographic Society",
-                           2024, 156, "January", "Science");
-        library->addJournal("J001", "Nature", "Springer Nature", 2024, 625,
-                          "Multidisciplinary", "Dr. Magdalena Skipper", true);
+        recovered = library->recover(SNAPSHOT_FILE, JOURNAL_FILE);
+    } catch (const exception& e) {
+        // Starting anyway would save the partial state over the real data
+        cerr << "Error recovering library data: " << e.what() << endl;
+        cerr << "Nothing was changed. Repair or move " << SNAPSHOT_FILE << " and "
+             << JOURNAL_FILE << " before starting again." << endl;
+        return 1;
+    }
+    
+    try {
+        if (!recovered) {
+            // Sample users
+            library->registerStudent("S001", "Alice Johnson", "alice@email.com", "pass123", 20,
+                                    "STU2024001", "Computer Science", 3);
+            library->registerFaculty("F001", "Dr. Bob Smith", "bob@email.com", "pass456", 45,
+                                    "EMP001", "Computer Science", "Professor");
+            library->registerLibrarian("L001", "Charlie Brown", "charlie@email.com", "pass789", 35,
+                                      "LIB001", "Morning");
+            
+            // Sample items
+            library->addBook("B001", "Introduction to Algorithms", "MIT Press", 2009,
+                            "978-0262033848", "Thomas H. Cormen", "Computer Science", 1312);
+            library->addBook("B002", "Clean Code", "Prentice Hall", 2008,
+                            "978-0132350884", "Robert C. Martin", "Software Engineering", 464);
+            library->addCopies("B001", 2);
+            library->addMagazine("M001", "National Geographic", "National Geographic Society",
+                               2024, 156, "January", "Science");
+            library->addJournal("J001", "Nature", "Springer Nature", 2024, 625,
+                              "Multidisciplinary", "Dr. Magdalena Skipper", true);
+        }
         
-        cout << "\n========================================" << endl;
-        cout << "   LIBRARY MANAGEMENT SYSTEM" << endl;
-        cout << "   Demonstrating OOP Concepts in C++" << endl;
-        cout << "========================================" << endl;
-        cout << "\nSample data loaded successfully!" << endl;
-        cout << "\nSample Login Credentials:" << endl;
-        cout << "Student: S001 / pass123" << endl;
-        cout << "Faculty: F001 / pass456" << endl;
-        cout << "Librarian: L001 / pass789" << endl;
+        if (!unattended) {
+            cout << "\n========================================" << endl;
+            cout << "   LIBRARY MANAGEMENT SYSTEM" << endl;
+            cout << "   Demonstrating OOP Concepts in C++" << endl;
+            cout << "========================================" << endl;
+            if (!recovered) {
+                cout << "\nSample data loaded successfully!" << endl;
+                cout << "\nSample Login Credentials:" << endl;
+                cout << "Student: S001 / pass123" << endl;
+                cout << "Faculty: F001 / pass456" << endl;
+                cout << "Librarian: L001 / pass789" << endl;
+            }
+        }
         
     } catch (const LibraryException& e) {
         cerr << "Error loading sample data: " << e.what() << endl;
     }
     
+    if (!publishName.empty()) {
+        try {
+            library->publishSharedCatalog(publishName,
+                                          library->getTotalItems() + SHARED_CATALOG_HEADROOM,
+                                          library->getTotalUsers() + SHARED_CATALOG_HEADROOM);
+        } catch (const LibraryException& e) {
+            cerr << "Error publishing shared catalog: " << e.what() << endl;
+        }
+    }
+    
+    if (!recordTrace.empty()) {
+        try {
+            library->startTraceRecording(recordTrace);
+        } catch (const LibraryException& e) {
+            cerr << "Error starting workload trace: " << e.what() << endl;
+            return 1;
+        }
+    }
+    
+    if (!batchSource.empty()) {
+        int status = runBatch(library, batchSource, results);
+        library->stopTraceRecording();
+        cout.rdbuf(results);
+        library->unpublishSharedCatalog();
+        library->shutdownTaskPool();
+        return status;
+    }
+    
     pauseScreen();
     
     int choice = 0;
@@ -86,6 +274,7 @@ int main() {
                     searchItems(library);
                     break;
                 case 5:
+                    library->checkpoint(SNAPSHOT_FILE);
                     cout << "\nThank you for using the Library Management System!" << endl;
                     break;
                 default:
@@ -99,6 +288,9 @@ int main() {
         
     } while (choice != 5);
     
+    library->stopTraceRecording();
+    library->unpublishSharedCatalog();
+    library->shutdownTaskPool();
     return 0;
 }
 
@@ -168,6 +360,7 @@ void loginUser(Library* lib) {
             switch (menuChoice) {
                 case 1: // View Profile
                     user->displayInfo();
+                    lib->displayLoanTerms(user->getUserId());
                     pauseScreen();
                     break;
                     
@@ -180,7 +373,18 @@ void loginUser(Library* lib) {
                     string itemId;
                     cout << "\nEnter Item ID to borrow: ";
                     getline(cin, itemId);
-                    lib->borrowItem(user->getUserId(), itemId);
+                    try {
+                        lib->borrowItem(user->getUserId(), itemId);
+                    } catch (const ItemAlreadyBorrowedException& e) {
+                        cerr << "\nError: " << e.what() << endl;
+                        char answer;
+                        cout << "Place a hold on this item? (y/n): ";
+                        cin >> answer;
+                        cin.ignore(numeric_limits<streamsize>::max(), '\n');
+                        if (answer == 'y' || answer == 'Y') {
+                            lib->placeHold(user->getUserId(), itemId);
+                        }
+                    }
                     pauseScreen();
                     break;
                 }
@@ -212,7 +416,16 @@ void loginUser(Library* lib) {
                         cout << "3. View All Items" << endl;
                         cout << "4. View All Transactions" << endl;
                         cout << "5. Overdue Report" << endl;
-                        cout << "6. Back" << endl;
+                        cout << "6. Add Copies to Item" << endl;
+                        cout << "7. Run Daily Fine Accrual" << endl;
+                        cout << "8. Record Fine Payment" << endl;
+                        cout << "9. Waive Fine" << endl;
+                        cout << "10. View User Fine Ledger" << endl;
+                        cout << "11. Library Statistics" << endl;
+                        cout << "12. Loans Due in Next 48 Hours" << endl;
+                        cout << "13. Memory Footprint" << endl;
+                        cout << "14. Most Borrowed Items" << endl;
+                        cout << "15. Back" << endl;
                         cout << "Choice: ";
                         
                         if (!(cin >> adminChoice)) {
@@ -243,11 +456,103 @@ void loginUser(Library* lib) {
                                 lib->generateOverdueReport();
                                 pauseScreen();
                                 break;
+                            case 6: {
+                                string itemId;
+                                int count;
+                                cout << "\nEnter Item ID: ";
+                                getline(cin, itemId);
+                                cout << "Number of copies to add: ";
+                                cin >> count;
+                                cin.ignore(numeric_limits<streamsize>::max(), '\n');
+                                lib->addCopies(itemId, count);
+                                pauseScreen();
+                                break;
+                            }
+                            case 7:
+                                lib->runFineAccrual();
+                                pauseScreen();
+                                break;
+                            case 8:
+                            case 9: {
+                                string userId, reason;
+                                double amount;
+                                cout << "\nEnter User ID: ";
+                                getline(cin, userId);
+                                cout << "Outstanding balance: $" << lib->getOutstandingBalance(userId) << endl;
+                                cout << "Amount: ";
+                                cin >> amount;
+                                cin.ignore(numeric_limits<streamsize>::max(), '\n');
+                                if (adminChoice == 8) {
+                                    lib->payFine(userId, amount);
+                                } else {
+                                    cout << "Reason: ";
+                                    getline(cin, reason);
+                                    lib->waiveFine(userId, amount, reason);
+                                }
+                                pauseScreen();
+                                break;
+                            }
+                            case 10: {
+                                string userId;
+                                cout << "\nEnter User ID: ";
+                                getline(cin, userId);
+                                lib->displayUserLedger(userId);
+                                pauseScreen();
+                                break;
+                            }
+                            case 11: {
+                                lib->displayStatistics();
+                                auto mismatches = lib->verifyStatistics();
+                                if (mismatches.empty()) {
+                                    cout << "Consistency check: OK" << endl;
+                                } else {
+                                    cout << "Consistency check: " << mismatches.size() << " mismatch(es)" << endl;
+                                    for (const auto& mismatch : mismatches) {
+                                        cout << "  " << mismatch << endl;
+                                    }
+                                }
+                                pauseScreen();
+                                break;
+                            }
+                            case 12:
+                                lib->generateDueSoonReport(48);
+                                pauseScreen();
+                                break;
+                            case 13:
+                                lib->displayMemoryFootprint();
+                                pauseScreen();
+                                break;
+                            case 14: {
+                                string period, type, genre;
+                                cout << "\nPeriod (day/week/month): ";
+                                getline(cin, period);
+                                cout << "Type (Book/Magazine/Journal, blank for all): ";
+                                getline(cin, type);
+                                cout << "Book genre (blank for all): ";
+                                getline(cin, genre);
+                                
+                                PopularityWindow window = PopularityWindow::Month;
+                                if (period == "day") {
+                                    window = PopularityWindow::Day;
+                                } else if (period == "week") {
+                                    window = PopularityWindow::Week;
+                                } else if (!period.empty() && period != "month") {
+                                    cout << "Unknown period, showing the month." << endl;
+                                }
+                                lib->displayPopularItems(window, type, genre,
+                                                         POPULAR_RESULTS_SHOWN);
+                                pauseScreen();
+                                break;
+                            }
                         }
                     }
                     break;
                     
-                case 8: // Logout
+                case 8: // My Holds
+                    manageHolds(lib, user);
+                    break;
+                    
+                case 9: // Logout
                     cout << "\nLogging out..." << endl;
                     break;
                     
@@ -260,7 +565,7 @@ void loginUser(Library* lib) {
             pauseScreen();
         }
         
-    } while (menuChoice != 8);
+    } while (menuChoice != 9);
 }
 
 void displayStudentMenu(shared_ptr<Person> user) {
@@ -275,7 +580,8 @@ void displayStudentMenu(shared_ptr<Person> user) {
     cout << "5. My Transactions" << endl;
     cout << "6. Search Items" << endl;
     cout << "7. [Not Available]" << endl;
-    cout << "8. Logout" << endl;
+    cout << "8. My Holds" << endl;
+    cout << "9. Logout" << endl;
     cout << "========================================" << endl;
 }
 
@@ -291,7 +597,8 @@ void displayFacultyMenu(shared_ptr<Person> user) {
     cout << "5. My Transactions" << endl;
     cout << "6. Search Items" << endl;
     cout << "7. [Not Available]" << endl;
-    cout << "8. Logout" << endl;
+    cout << "8. My Holds" << endl;
+    cout << "9. Logout" << endl;
     cout << "========================================" << endl;
 }
 
@@ -307,7 +614,8 @@ void displayLibrarianMenu(shared_ptr<Person> user) {
     cout << "5. My Transactions" << endl;
     cout << "6. Search Items" << endl;
     cout << "7. Admin Functions" << endl;
-    cout << "8. Logout" << endl;
+    cout << "8. My Holds" << endl;
+    cout << "9. Logout" << endl;
     cout << "========================================" << endl;
 }
 
@@ -447,6 +755,12 @@ void searchItems(Library* lib) {
     cout << "\n=== Search Items ===" << endl;
     cout << "1. Search by Title" << endl;
     cout << "2. Search by Type" << endl;
+    cout << "3. Search by Title (allow typos)" << endl;
+    cout << "4. Search by ISBN, Author, Genre, Field or Category" << endl;
+    cout << "5. Search by Publication Year Range" << endl;
+    cout << "6. Search by Keywords (ranked)" << endl;
+    cout << "7. Complete a Title or Author" << endl;
+    cout << "8. Patrons Who Borrowed This Also Borrowed" << endl;
     cout << "Select search type: ";
     cin >> searchType;
     cin.ignore(numeric_limits<streamsize>::max(), '\n');
@@ -481,7 +795,301 @@ void searchItems(Library* lib) {
                 cout << "-------------------------------------------" << endl;
             }
         }
+    } else if (searchType == 3) {
+        string title;
+        cout << "Enter title (or part of title): ";
+        getline(cin, title);
+        
+        // Roughly one typo per five characters, at most three
+        int maxDistance = min(3, max(1, static_cast<int>(title.size()) / 5));
+        auto results = lib->searchByTitleFuzzy(title, maxDistance, FUZZY_RESULTS_SHOWN);
+        if (results.empty()) {
+            cout << "\nNo items found." << endl;
+        } else {
+            cout << "\n=== Search Results ===" << endl;
+            for (const auto& result : results) {
+                cout << "Edit distance: " << result.second << endl;
+                result.first->displayInfo();
+                cout << "-------------------------------------------" << endl;
+            }
+        }
+    } else if (searchType == 4) {
+        ItemQuery query;
+        cout << "Leave a field blank to ignore it." << endl;
+        cout << "ISBN: ";
+        getline(cin, query.isbn);
+        cout << "Author: ";
+        getline(cin, query.author);
+        cout << "Genre: ";
+        getline(cin, query.genre);
+        cout << "Journal Field: ";
+        getline(cin, query.field);
+        cout << "Magazine Category: ";
+        getline(cin, query.category);
+        
+        auto results = lib->findItems(query);
+        if (results.empty()) {
+            cout << "\nNo items found." << endl;
+        } else {
+            cout << "\n=== Search Results ===" << endl;
+            for (const auto& item : results) {
+                item->displayInfo();
+                cout << "-------------------------------------------" << endl;
+            }
+        }
+    } else if (searchType == 5) {
+        int fromYear, toYear;
+        cout << "From year: ";
+        cin >> fromYear;
+        cout << "To year: ";
+        cin >> toYear;
+        cin.ignore(numeric_limits<streamsize>::max(), '\n');
+        
+        auto results = lib->getItemsPublishedBetween(fromYear, toYear);
+        if (results.empty()) {
+            cout << "\nNo items found." << endl;
+        } else {
+            cout << "\n=== Search Results (oldest first) ===" << endl;
+            for (const auto& item : results) {
+                item->displayInfo();
+                cout << "-------------------------------------------" << endl;
+            }
+        }
+    } else if (searchType == 6) {
+        string keywords;
+        cout << "Enter keywords (title, author, publisher, subject): ";
+        getline(cin, keywords);
+        
+        auto results = lib->searchKeywords(keywords, RANKED_RESULTS_SHOWN);
+        if (results.empty()) {
+            cout << "\nNo items found." << endl;
+        } else {
+            cout << "\n=== Search Results (best match first) ===" << endl;
+            for (const auto& result : results) {
+                cout << "Relevance: " << fixed << setprecision(2) << result.second << endl;
+                result.first->displayInfo();
+                cout << "-------------------------------------------" << endl;
+            }
+        }
+    } else if (searchType == 7) {
+        string prefix;
+        cout << "Start typing a title or author: ";
+        getline(cin, prefix);
+        
+        auto titles = lib->suggestTitles(prefix, AutocompleteIndex::TOP_K);
+        auto authors = lib->suggestAuthors(prefix, AutocompleteIndex::TOP_K);
+        if (titles.empty() && authors.empty()) {
+            cout << "\nNo suggestions." << endl;
+        }
+        if (!titles.empty()) {
+            cout << "\nTitles:" << endl;
+            for (const auto& completion : titles) {
+                cout << "  " << completion.text << " (" << completion.weight << " borrows)" << endl;
+            }
+        }
+        if (!authors.empty()) {
+            cout << "\nAuthors:" << endl;
+            for (const auto& completion : authors) {
+                cout << "  " << completion.text << " (" << completion.weight << " borrows)" << endl;
+            }
+        }
+    } else if (searchType == 8) {
+        string itemId;
+        cout << "Enter Item ID: ";
+        getline(cin, itemId);
+        
+        lib->displayRelatedItems(itemId, RELATED_RESULTS_SHOWN);
     }
     
     pauseScreen();
 }
+
+void manageHolds(Library* lib, shared_ptr<Person> user) {
+    lib->displayUserHolds(user->getUserId());
+    
+    int holdChoice;
+    cout << "\n1. Place Hold" << endl;
+    cout << "2. Cancel Hold" << endl;
+    cout << "3. Back" << endl;
+    cout << "Choice: ";
+    cin >> holdChoice;
+    cin.ignore(numeric_limits<streamsize>::max(), '\n');
+    
+    if (holdChoice == 1 || holdChoice == 2) {
+        string itemId;
+        cout << "Enter Item ID: ";
+        getline(cin, itemId);
+        
+        if (holdChoice == 1) {
+            lib->placeHold(user->getUserId(), itemId);
+        } else {
+            lib->cancelHold(user->getUserId(), itemId);
+        }
+        pauseScreen();
+    }
+}
+
+void displayCatalogItem(const CatalogItem& item) {
+    cout << "Item ID: " << item.itemId << endl;
+    cout << "Type: " << item.itemType << endl;
+    cout << "Title: " << item.title << endl;
+    cout << "Publisher: " << item.publisher << endl;
+    cout << "Year: " << item.publicationYear << endl;
+    cout << "Status: " << (item.availableCopies > 0 ? "Available" : "Borrowed") << endl;
+    if (item.totalCopies > 1) {
+        cout << "Copies: " << item.availableCopies << " of " << item.totalCopies
+             << " available" << endl;
+    }
+    cout << "-------------------------------------------" << endl;
+}
+
+void runCatalogReader(const string& regionName) {
+    // Maps the owner's region read-only; nothing here can change library state
+    unique_ptr<SharedCatalog> catalog = SharedCatalog::attach(regionName);
+    
+    int choice = 0;
+    do {
+        if (catalog->isRetired()) {
+            // The owner outgrew the region and published a larger one, or
+            // withdrew it; keep the old view if nothing new can be mapped
+            try {
+                catalog = SharedCatalog::attach(regionName);
+            } catch (const LibraryException& e) {
+                cerr << "Catalog not refreshed: " << e.what() << endl;
+            }
+        }
+        
+        clearScreen();
+        cout << "\n========================================" << endl;
+        cout << "   SHARED CATALOG (READ-ONLY)" << endl;
+        cout << "   " << catalog->getItemCount() << " items, "
+             << catalog->getUserCount() << " users" << endl;
+        cout << "========================================" << endl;
+        cout << "1. View Available Items" << endl;
+        cout << "2. Search by Title" << endl;
+        cout << "3. Look Up Item" << endl;
+        cout << "4. Look Up User" << endl;
+        cout << "5. Exit" << endl;
+        cout << "========================================" << endl;
+        cout << "\nEnter your choice: ";
+        
+        if (!(cin >> choice)) {
+            if (cin.eof()) {
+                break;
+            }
+            cin.clear();
+            choice = -1;
+        }
+        cin.ignore(numeric_limits<streamsize>::max(), '\n');
+        
+        if (choice == 1) {
+            bool found = false;
+            cout << "\n========== Available Items ==========" << endl;
+            for (const auto& item : catalog->getItems()) {
+                if (item.availableCopies > 0) {
+                    displayCatalogItem(item);
+                    found = true;
+                }
+            }
+            if (!found) {
+                cout << "No items currently available." << endl;
+            }
+        } else if (choice == 2) {
+            string title;
+            cout << "Enter title (or part of title): ";
+            getline(cin, title);
+            auto results = catalog->searchByTitle(title);
+            cout << "\nFound " << results.size() << " item(s):" << endl;
+            for (const auto& item : results) {
+                displayCatalogItem(item);
+            }
+        } else if (choice == 3) {
+            string itemId;
+            cout << "Enter Item ID: ";
+            getline(cin, itemId);
+            CatalogItem item;
+            if (catalog->findItem(itemId, item)) {
+                displayCatalogItem(item);
+            } else {
+                cout << "Item not found: " << itemId << endl;
+            }
+        } else if (choice == 4) {
+            string userId;
+            cout << "Enter User ID: ";
+            getline(cin, userId);
+            CatalogUser user;
+            if (catalog->findUser(userId, user)) {
+                cout << "User ID: " << user.userId << endl;
+                cout << "Name: " << user.name << endl;
+                cout << "Email: " << user.email << endl;
+                cout << "Role: " << user.role << endl;
+                cout << "Borrowed: " << user.currentlyBorrowed << " of "
+                     << user.maxBorrowLimit << " allowed" << endl;
+            } else {
+                cout << "User not found: " << userId << endl;
+            }
+        } else if (choice != 5) {
+            cout << "\nInvalid choice. Please try again." << endl;
+        }
+        
+        if (choice != 5) {
+            pauseScreen();
+        }
+    } while (choice != 5);
+}
+
+int runBatch(Library* lib, const string& source, streambuf* results) {
+    ifstream file;
+    if (source != "-") {
+        file.open(source);
+        if (!file) {
+            cerr << "Error: cannot read batch file " << source << endl;
+            return 1;
+        }
+    }
+    istream& in = source == "-" ? cin : file;
+    ostream out(results);
+    
+    BatchSession session(*lib, out);
+    auto start = chrono::steady_clock::now();
+    session.run(in);
+    double seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+    
+    // Failed commands are reported in the results; the run itself succeeded
+    try {
+        lib->checkpoint(SNAPSHOT_FILE);
+    } catch (const LibraryException& e) {
+        cerr << "Error saving library data: " << e.what() << endl;
+        return 1;
+    }
+    cerr << "Batch: " << session.getCommandCount() << " command(s), " << session.getErrorCount()
+         << " failed, in " << fixed << setprecision(0) << seconds * 1000 << " ms ("
+         << (seconds > 0 ? session.getCommandCount() / seconds : 0) << " per second)." << endl;
+    return 0;
+}
+
+int runReplay(Library* lib, const string& traceFile, double speedup, unsigned concurrency,
+              streambuf* results) {
+    vector<TraceEntry> trace;
+    try {
+        trace = TraceRecorder::readTrace(traceFile);
+    } catch (const LibraryException& e) {
+        cerr << "Error reading workload trace: " << e.what() << endl;
+        return 1;
+    }
+    string snapshotFile = TraceRecorder::snapshotFileFor(traceFile);
+    try {
+        lib->loadFromFile(snapshotFile);
+    } catch (const LibraryException& e) {
+        cerr << "Error loading the state the trace starts from (" << snapshotFile
+             << "): " << e.what() << endl;
+        return 1;
+    }
+    
+    // No journal is open, so the replayed changes live only in memory
+    LoadDriver driver(*lib);
+    LoadReport report = driver.replay(trace, speedup, concurrency);
+    ostream out(results);
+    report.print(out);
+    return 0;
+}
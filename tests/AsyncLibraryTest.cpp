@@ -0,0 +1,173 @@
+// Borrows and returns through the coroutine facade: every call must
+// complete, failures must reach the awaiting coroutine, and a completed
+// call's event must already be in the journal file. A journal that cannot
+// be written must fail its caller as not durable and refuse what follows.
+
+#include <csignal>
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <atomic>
+#include <mutex>
+#include "../include/AsyncLibrary.h"
+#include "../include/Exceptions.h"
+#include <sys/resource.h>
+
+static const char* const SNAPSHOT_FILE = "async_test.snapshot";
+static const char* const JOURNAL_FILE = "async_test.journal";
+static const int PATRONS = 64;
+
+static std::atomic<int> failures(0);
+static std::mutex reportMutex;
+
+static void check(bool condition, const std::string& what) {
+    if (!condition) {
+        std::lock_guard<std::mutex> lock(reportMutex);
+        std::cerr << "FAILED: " << what << std::endl;
+        failures++;
+    }
+}
+
+static std::string readJournal() {
+    std::ifstream in(JOURNAL_FILE, std::ios::binary);
+    std::ostringstream contents;
+    contents << in.rdbuf();
+    return contents.str();
+}
+
+static void removeFiles() {
+    const std::string snapshot = SNAPSHOT_FILE;
+    for (const std::string& name : {snapshot, snapshot + ".delta", snapshot + ".fts",
+                                    std::string(JOURNAL_FILE)}) {
+        std::remove(name.c_str());
+    }
+}
+
+static Task<void> borrowAndReturn(AsyncLibrary& async, std::string userId, std::string itemId) {
+    Transaction loan = co_await async.borrow(userId, itemId);
+    check(readJournal().find("|" + loan.getTransactionId() + "|") != std::string::npos,
+          "borrow of " + itemId + " completed before it was journaled");
+
+    Library::ReturnSummary summary = co_await async.giveBack(userId, itemId);
+    check(summary.fine == 0, "return of " + itemId + " charged a fine");
+    check(readJournal().find("ITEM_RETURNED|" + userId + "|" + itemId) != std::string::npos,
+          "return of " + itemId + " completed before it was journaled");
+}
+
+static Task<void> borrowTwice(AsyncLibrary& async) {
+    co_await async.borrow("P0", "SOLO");
+    bool refused = false;
+    try {
+        co_await async.borrow("P1", "SOLO");
+    } catch (const ItemAlreadyBorrowedException&) {
+        refused = true;
+    }
+    check(refused, "second borrow of a single copy did not throw to its awaiter");
+    co_await async.giveBack("P0", "SOLO");
+}
+
+static Task<void> borrowUnjournaled(AsyncLibrary& async) {
+    bool notDurable = false;
+    try {
+        co_await async.borrow("P0", "B0");
+    } catch (const NotDurableException&) {
+        notDurable = true;
+    }
+    check(notDurable, "a borrow whose journal write failed did not throw NotDurableException");
+
+    bool refused = false;
+    try {
+        co_await async.borrow("P1", "B1");
+    } catch (const InvalidOperationException&) {
+        refused = true;
+    }
+    check(refused, "a borrow after a failed journal write was accepted");
+}
+
+// Cap the file size at the journal's current length so its next write fails
+static void failJournalWrites(Library* library) {
+    library->checkpoint(SNAPSHOT_FILE); // Recovery starts over from here
+    std::signal(SIGXFSZ, SIG_IGN);
+    rlimit limit;
+    getrlimit(RLIMIT_FSIZE, &limit);
+    rlimit capped = limit;
+    capped.rlim_cur = static_cast<rlim_t>(readJournal().size());
+    setrlimit(RLIMIT_FSIZE, &capped);
+
+    {
+        EventLoop loop(1);
+        AsyncLibrary async(*library, loop);
+        loop.spawn(borrowUnjournaled(async), [](std::exception_ptr) {
+            check(false, "journal failure test threw");
+        });
+        loop.waitIdle();
+        loop.shutdown();
+    }
+    check(library->getItem("B0")->getAvailableCopies() == 0,
+          "the not-durable borrow was rolled back");
+    check(library->getItem("B1")->getAvailableCopies() == 1, "the refused borrow was applied");
+
+    setrlimit(RLIMIT_FSIZE, &limit);
+    library->recover(SNAPSHOT_FILE, JOURNAL_FILE);
+    check(library->getItem("B0")->getAvailableCopies() == 1,
+          "recovery kept a borrow that never reached the journal");
+    library->checkoutItem("P1", "B1");
+    check(library->getItem("B1")->getAvailableCopies() == 0,
+          "recovery did not accept changes again");
+}
+
+int main() {
+    removeFiles();
+
+    Library* library = Library::getInstance();
+    library->recover(SNAPSHOT_FILE, JOURNAL_FILE);
+    for (int i = 0; i < PATRONS; i++) {
+        std::string n = std::to_string(i);
+        library->registerStudent("P" + n, "Patron " + n, "p" + n + "@example.com", "pw", 20,
+                                 "STU" + n, "Testing", 1);
+        library->addBook("B" + n, "Book " + n, "Press", 2020, "isbn-" + n, "Author", "Fiction",
+                         100);
+    }
+    library->addBook("SOLO", "Only Copy", "Press", 2020, "isbn-solo", "Author", "Fiction", 100);
+
+    {
+        EventLoop loop(2);
+        AsyncLibrary async(*library, loop);
+        for (int i = 0; i < PATRONS; i++) {
+            std::string n = std::to_string(i);
+            loop.spawn(borrowAndReturn(async, "P" + n, "B" + n), [](std::exception_ptr error) {
+                try {
+                    std::rethrow_exception(error);
+                } catch (const std::exception& e) {
+                    check(false, std::string("call failed: ") + e.what());
+                }
+            });
+        }
+        loop.waitIdle();
+
+        loop.spawn(borrowTwice(async), [](std::exception_ptr) {
+            check(false, "single-copy test threw");
+        });
+        loop.waitIdle();
+        loop.shutdown();
+    }
+
+    for (int i = 0; i < PATRONS; i++) {
+        std::string itemId = "B" + std::to_string(i);
+        check(library->getItem(itemId)->getAvailableCopies() == 1,
+              itemId + " is not back on the shelf");
+    }
+    failJournalWrites(library);
+    library->shutdownTaskPool();
+    removeFiles();
+
+    if (failures > 0) {
+        std::cerr << failures << " check(s) failed" << std::endl;
+        return 1;
+    }
+    std::cout << "AsyncLibrary: " << PATRONS << " concurrent borrow/return pairs durable"
+              << std::endl;
+    return 0;
+}
@@ -0,0 +1,69 @@
+// Top-k search prunes with MaxScore bounds, but must still return exactly
+// the first k entries of the exhaustive ranking, scores and ID ties
+// included. A small vocabulary gives many documents equal scores.
+
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+#include "../include/FullTextIndex.h"
+#include "../include/Book.h"
+
+static const int DOCUMENTS = 3000;
+static const int QUERIES = 400;
+static const char* const WORDS[] = {"river", "stone", "garden", "night", "atlas", "winter",
+                                    "glass", "harbor", "signal", "orchard", "copper", "lantern"};
+static const int WORD_COUNT = sizeof(WORDS) / sizeof(WORDS[0]);
+
+static int failures = 0;
+
+static void check(bool condition, const std::string& what) {
+    if (!condition) {
+        std::cerr << "FAILED: " << what << std::endl;
+        failures++;
+    }
+}
+
+static std::string randomText(std::mt19937& rng, int minWords, int maxWords) {
+    std::uniform_int_distribution<int> count(minWords, maxWords);
+    std::uniform_int_distribution<int> word(0, WORD_COUNT - 1);
+    std::string text;
+    for (int n = count(rng); n > 0; n--) {
+        text += std::string(text.empty() ? "" : " ") + WORDS[word(rng)];
+    }
+    return text;
+}
+
+int main() {
+    std::mt19937 rng(11);
+    FullTextIndex index;
+    for (int i = 0; i < DOCUMENTS; i++) {
+        std::string n = std::to_string(i);
+        Book book("B" + n, randomText(rng, 1, 3), "Press", 2020, "isbn-" + n,
+                  randomText(rng, 1, 2), "Fiction", 100);
+        index.add(book);
+    }
+
+    std::uniform_int_distribution<int> limit(1, 60);
+    for (int q = 0; q < QUERIES; q++) {
+        std::string query = randomText(rng, 1, 4);
+        std::vector<TextMatch> all = index.search(query, 0);
+        size_t k = static_cast<size_t>(limit(rng));
+        std::vector<TextMatch> top = index.search(query, k);
+
+        bool same = top.size() == std::min(k, all.size());
+        for (size_t i = 0; same && i < top.size(); i++) {
+            same = top[i].itemId == all[i].itemId && top[i].score == all[i].score;
+        }
+        check(same, "top " + std::to_string(k) + " for \"" + query +
+                        "\" differs from the exhaustive ranking");
+    }
+
+    if (failures > 0) {
+        std::cerr << failures << " check(s) failed" << std::endl;
+        return 1;
+    }
+    std::cout << "FullTextIndex: top-k matches the exhaustive ranking for " << QUERIES
+              << " queries" << std::endl;
+    return 0;
+}
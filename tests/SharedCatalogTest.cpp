@@ -0,0 +1,75 @@
+// A reader attaching while the owner is still filling a region must wait
+// for the whole catalog, and a region whose owner goes away must read as
+// retired rather than as a live catalog that never changes.
+
+#include <chrono>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <thread>
+#include <unistd.h>
+#include "../include/SharedCatalog.h"
+#include "../include/Exceptions.h"
+
+static const int ITEMS = 500;
+
+static int failures = 0;
+
+static void check(bool condition, const std::string& what) {
+    if (!condition) {
+        std::cerr << "FAILED: " << what << std::endl;
+        failures++;
+    }
+}
+
+int main() {
+    const std::string name = "/library_catalog_test_" + std::to_string(getpid());
+    std::unique_ptr<SharedCatalog> owner = SharedCatalog::create(name, ITEMS, 1);
+
+    // The reader starts before any record is written
+    int seen = -1;
+    std::string error;
+    std::thread reader([&] {
+        try {
+            std::unique_ptr<SharedCatalog> view = SharedCatalog::attach(name);
+            seen = view->getItemCount();
+        } catch (const LibraryException& e) {
+            error = e.what();
+        }
+    });
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    for (int i = 0; i < ITEMS; i++) {
+        std::string n = std::to_string(i);
+        owner->addItem("B" + n, "Book " + n, "Press", "Book", 2020, 1, 1, 0.5);
+    }
+    owner->markReady();
+    reader.join();
+    check(error.empty(), "attach during the fill failed: " + error);
+    check(seen == ITEMS, "attach during the fill saw " + std::to_string(seen) + " items");
+
+    // Dropping the owner retires the region under readers that have it mapped
+    std::unique_ptr<SharedCatalog> view = SharedCatalog::attach(name);
+    check(!view->isRetired(), "a live region reads as retired");
+    owner.reset();
+    check(view->isRetired(), "a withdrawn region still reads as live");
+    check(view->getItemCount() == ITEMS, "a retired region lost its records");
+
+    // A region abandoned before it was filled is never attached to
+    std::unique_ptr<SharedCatalog> abandoned = SharedCatalog::create(name, ITEMS, 1);
+    abandoned.reset();
+    bool refused = false;
+    try {
+        SharedCatalog::attach(name);
+    } catch (const LibraryException&) {
+        refused = true;
+    }
+    check(refused, "attached to a region that was never filled");
+
+    if (failures > 0) {
+        std::cerr << failures << " check(s) failed" << std::endl;
+        return 1;
+    }
+    std::cout << "SharedCatalog: readers wait for a filled region and see withdrawal"
+              << std::endl;
+    return 0;
+}
@@ -0,0 +1,86 @@
+// Threads append to the log at once, without a lock, while snapshots are
+// published: every slot must be handed out exactly once, every commit must
+// land, and a snapshot must not change when rows are updated after it.
+
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+#include "../include/TransactionStore.h"
+
+static const int THREADS = 4;
+static const int APPENDS = 50000; // Per thread; spans many chunks
+
+static int failures = 0;
+
+static void check(bool condition, const std::string& what) {
+    if (!condition) {
+        std::cerr << "FAILED: " << what << std::endl;
+        failures++;
+    }
+}
+
+static Transaction row(size_t index, const std::string& userId) {
+    return Transaction("T" + std::to_string(index + 1), userId, "B1", "B1-C1", 1000, 2000,
+                       0.5, 10.0);
+}
+
+int main() {
+    TransactionStore store;
+    std::vector<std::thread> writers;
+    for (int t = 0; t < THREADS; t++) {
+        std::string userId = "U" + std::to_string(t);
+        writers.push_back(std::thread([&store, userId] {
+            for (int i = 0; i < APPENDS; i++) {
+                size_t index = store.allocate();
+                store.commit(index, row(index, userId));
+            }
+        }));
+    }
+
+    // Snapshots taken mid-append show a consistent prefix of whole rows
+    size_t published = 0;
+    while (store.getCommittedCount() < static_cast<size_t>(THREADS * APPENDS)) {
+        auto snapshot = store.publish();
+        snapshot->forEach([&](const Transaction& trans) {
+            size_t index = std::stoul(trans.getTransactionId().substr(1)) - 1;
+            check(&snapshot->at(index) == &trans, "a row sits in the wrong slot");
+        });
+        published++;
+    }
+    for (auto& writer : writers) {
+        writer.join();
+    }
+
+    size_t total = static_cast<size_t>(THREADS * APPENDS);
+    check(store.size() == total, "the allocator handed out a slot twice or skipped one");
+    check(store.getCommittedCount() == total, "a commit was lost");
+    std::vector<int> perUser(THREADS, 0);
+    for (size_t i = 0; i < total; i++) {
+        check(store.isCommitted(i), "slot " + std::to_string(i) + " is not committed");
+        const Transaction& trans = store.get(i);
+        check(trans.getTransactionId() == "T" + std::to_string(i + 1),
+              "slot " + std::to_string(i) + " holds another row");
+        perUser[std::stoi(trans.getUserId().substr(1))]++;
+    }
+    for (int t = 0; t < THREADS; t++) {
+        check(perUser[t] == APPENDS, "thread " + std::to_string(t) + " lost rows");
+    }
+
+    // Copy-on-write: an update after a publish leaves that snapshot alone
+    auto before = store.publish();
+    store.at(7).processReturn(1500);
+    auto after = store.publish();
+    check(!before->at(7).getIsReturned(), "an update changed an earlier snapshot");
+    check(after->at(7).getIsReturned(), "an update is missing from the next snapshot");
+    check(&before->at(8) != &after->at(8), "the updated chunk was not copied");
+    check(&before->at(total - 1) == &after->at(total - 1), "an unchanged chunk was copied");
+
+    if (failures > 0) {
+        std::cerr << failures << " check(s) failed" << std::endl;
+        return 1;
+    }
+    std::cout << "TransactionStore: " << THREADS << " threads appended " << total
+              << " rows across " << published << " snapshot(s)" << std::endl;
+    return 0;
+}